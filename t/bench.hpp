@@ -0,0 +1,67 @@
+//////////////////////////////////////////////////////////// vim: sw=3 ts=8 et
+//
+// Trivial Template Library Benchmarks
+//
+// Include in the benchmark source only: it replaces the global operator
+// new and delete, to count the allocations.
+//
+// This work is PUBLIC DOMAIN
+//
+#include <time.h>
+#include <new>
+#include "t.hpp"
+
+namespace t
+{
+   extern unsigned long allocations, allocated_bytes;
+
+   // monotonic time in nanoseconds
+   inline uint64_t now_ns()
+   {
+      struct timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+   }
+
+   struct bench
+   {
+      const char *name;
+      uint64_t start;
+      unsigned long allocs, bytes;
+      bench(const char *n): name(n), start(now_ns()), allocs(allocations), bytes(allocated_bytes) {}
+      // prints the time per iteration and the allocations since the start
+      void report(unsigned long iterations)
+      {
+         uint64_t ns = now_ns() - start;
+         printf("%-40s %10.2f ns/op %10lu allocs %12lu bytes\n", name,
+                iterations ? (double)ns / iterations: (double)ns,
+                allocations - allocs, allocated_bytes - bytes);
+      }
+   };
+
+   // keeps the compiler from optimizing away the value
+   template<class T> inline void use(const T &v) { __asm__ __volatile__("" :: "g"(&v) : "memory"); }
+
+   unsigned long allocations, allocated_bytes;
+}
+
+void *operator new(size_t n)
+{
+   ++t::allocations;
+   t::allocated_bytes += n;
+   void *p = malloc(n ? n: 1);
+   if (!p)
+      abort();
+   return p;
+}
+// for the allocations which can fail, as the buffer of stable_sort
+void *operator new(size_t n, const std::nothrow_t &) throw()
+{
+   ++t::allocations;
+   t::allocated_bytes += n;
+   return malloc(n ? n: 1);
+}
+void operator delete(void *p) throw() { free(p); }
+#if __cplusplus >= 201402L
+void operator delete(void *p, size_t) throw() { free(p); }
+#endif
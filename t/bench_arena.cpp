@@ -0,0 +1,92 @@
+// vim: sw=3 ts=8 et
+#include "bench.hpp"
+#include "ttl/utility.hpp"
+#include "ttl/map.hpp"
+#include "ttl/arena.hpp"
+
+// the keys of the per-request maps
+static unsigned keys[200];
+static const unsigned rounds = 20000;
+
+typedef ttl::allocator_ref<ttl::arena> arena_ref;
+typedef ttl::allocator_ref<ttl::pool> pool_ref;
+
+template<class Map>
+static unsigned long build(Map &m)
+{
+   for (unsigned k = 0; k < countof(keys); ++k)
+      m[keys[k]] = k;
+   return m.count(keys[0]);
+}
+
+static void heap()
+{
+   t::bench b("map build and discard, heap");
+   unsigned long found = 0;
+   for (unsigned r = 0; r < rounds; ++r)
+   {
+      ttl::map<unsigned, unsigned> m;
+      found += build(m);
+   }
+   b.report(rounds);
+   t::use(found);
+}
+
+static void pool()
+{
+   t::bench b("map build and discard, pool");
+   unsigned long found = 0;
+   ttl::pool p;
+   for (unsigned r = 0; r < rounds; ++r)
+   {
+      ttl::map<unsigned, unsigned, ttl::less<unsigned>, pool_ref> m((pool_ref(p)));
+      found += build(m);
+   }
+   b.report(rounds);
+   t::use(found);
+}
+
+static void arena()
+{
+   t::bench b("map build and discard, arena");
+   unsigned long found = 0;
+   ttl::arena a;
+   for (unsigned r = 0; r < rounds; ++r)
+   {
+      {
+         ttl::map<unsigned, unsigned, ttl::less<unsigned>, arena_ref> m((arena_ref(a)));
+         found += build(m);
+      }
+      a.reset();
+   }
+   b.report(rounds);
+   t::use(found);
+}
+
+static void stack_arena()
+{
+   t::bench b("map build and discard, stack arena");
+   unsigned long found = 0;
+   char buffer[16384];
+   ttl::arena a(buffer, sizeof(buffer));
+   for (unsigned r = 0; r < rounds; ++r)
+   {
+      {
+         ttl::map<unsigned, unsigned, ttl::less<unsigned>, arena_ref> m((arena_ref(a)));
+         found += build(m);
+      }
+      a.reset();
+   }
+   b.report(rounds);
+   t::use(found);
+}
+
+void test()
+{
+   for (unsigned k = 0; k < countof(keys); ++k)
+      keys[k] = rnd(1000000);
+   heap();
+   pool();
+   arena();
+   stack_arena();
+}
@@ -0,0 +1,78 @@
+// vim: sw=3 ts=8 et
+#include <pthread.h>
+#include <unistd.h>
+#include "bench.hpp"
+#include "ttl/bitset.hpp"
+#include "ttl/atomic_bitset.hpp"
+
+// threads taking and releasing IDs out of 64K
+enum { ids = 65536, rounds = 1000000, held = 64 };
+
+static ttl::atomic_bitset<ids> atomic_ids;
+static ttl::bitset<ids> locked_ids;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned threads;
+
+// the first clear bit from the word of hint on, as acquire_first_clear
+static ttl::size_t locked_acquire(ttl::size_t hint)
+{
+   pthread_mutex_lock(&lock);
+   ttl::size_t id = ids;
+   for (ttl::size_t i = 0, s = hint / 64; i <= locked_ids.last_slot_index(); ++i, s = (s + 1) % (ids / 64))
+      if (~locked_ids.slot(s))
+      {
+         id = s * 64 + __builtin_ctzl(~locked_ids.slot(s));
+         locked_ids.set(id);
+         break;
+      }
+   pthread_mutex_unlock(&lock);
+   return id;
+}
+static void locked_release(ttl::size_t id)
+{
+   pthread_mutex_lock(&lock);
+   locked_ids.reset(id);
+   pthread_mutex_unlock(&lock);
+}
+
+template<bool Atomic>
+static void *worker(void *arg)
+{
+   const ttl::size_t self = (ttl::size_t)arg;
+   ttl::size_t mine[held], hint = self * ids / threads;
+   for (unsigned r = 0; r < rounds / threads; ++r)
+   {
+      ttl::size_t &slot = mine[r % held];
+      if (r >= held)
+         Atomic ? (void)atomic_ids.test_and_reset(slot): locked_release(slot);
+      slot = hint = Atomic ? atomic_ids.acquire_first_clear(hint): locked_acquire(hint);
+   }
+   return 0;
+}
+
+template<bool Atomic>
+static void run(const char *name)
+{
+   pthread_t t[16];
+   char title[64];
+   snprintf(title, sizeof(title), "%s, %u threads", name, threads);
+   t::bench b(title);
+   for (ttl::size_t i = 0; i < threads; ++i)
+      pthread_create(&t[i], 0, worker<Atomic>, (void *)i);
+   for (ttl::size_t i = 0; i < threads; ++i)
+      pthread_join(t[i], 0);
+   b.report(rounds);
+   atomic_ids.reset();
+   locked_ids.reset();
+}
+
+void test()
+{
+   const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+   printf("%ld cores\n", cores);
+   for (threads = 1; threads <= 16 && threads <= (unsigned)cores * 2; threads *= 2)
+   {
+      run<false>("mutex and bitset");
+      run<true>("atomic_bitset");
+   }
+}
@@ -0,0 +1,58 @@
+// vim: sw=3 ts=8 et
+#include "bench.hpp"
+#include "ttl/bitset.hpp"
+
+// a 64K slot mask, with one set bit in 61
+typedef ttl::bitset<65536> mask;
+static const unsigned scans = 2000;
+
+struct sum
+{
+   ttl::size_t s;
+   void operator()(ttl::size_t i) { s += i; }
+};
+
+void test()
+{
+   static mask m;
+   for (ttl::size_t i = 0; i < m.size(); i += 61)
+      m.set(i);
+   {
+      t::bench b("bitset<65536> test() each bit");
+      ttl::size_t s = 0;
+      for (unsigned r = 0; r < scans; ++r)
+         for (ttl::size_t i = 0; i < m.size(); ++i)
+            if (m.test(i))
+               s += i;
+      b.report(scans);
+      t::use(s);
+   }
+   {
+      t::bench b("bitset<65536> find_first, find_next");
+      ttl::size_t s = 0;
+      for (unsigned r = 0; r < scans; ++r)
+         for (ttl::size_t i = m.find_first(); i < m.size(); i = m.find_next(i))
+            s += i;
+      b.report(scans);
+      t::use(s);
+   }
+   {
+      t::bench b("bitset<65536> for_each_set");
+      sum s = { 0 };
+      for (unsigned r = 0; r < scans; ++r)
+         s = m.for_each_set(s);
+      b.report(scans);
+      t::use(s);
+   }
+   {
+      t::bench b("bitset<65536> find_last");
+      ttl::size_t s = 0;
+      for (unsigned r = 0; r < scans * 100; ++r)
+      {
+         m.flip(65535 - r % 64);
+         s += m.find_last();
+      }
+      b.report(scans * 100);
+      t::use(s);
+   }
+}
@@ -0,0 +1,54 @@
+// vim: sw=3 ts=8 et
+#include "bench.hpp"
+#include "ttl/bitset.hpp"
+
+// the shift as it was done before, one bit at a time
+template<ttl::size_t N>
+static ttl::bitset<N> shift_bits(const ttl::bitset<N> &b, ttl::size_t pos)
+{
+   ttl::bitset<N> other;
+   for (ttl::size_t i = 0; pos < N; ++i, ++pos)
+      if (b.test(i))
+         other.set(pos);
+   return other;
+}
+
+template<ttl::size_t N>
+static void shifts(const char *words, const char *bits, unsigned long iterations)
+{
+   ttl::bitset<N> b;
+   for (ttl::size_t i = 0; i < N; i += 3)
+      b.set(i);
+   {
+      t::bench t(words);
+      ttl::size_t c = 0;
+      for (unsigned long i = 0; i < iterations; ++i)
+      {
+         b <<= 1 + i % 7;
+         b >>= i % 5;
+         b.set(0);
+         c += b.slot(0);
+      }
+      t.report(iterations);
+      t::use(c);
+   }
+   {
+      t::bench t(bits);
+      ttl::size_t c = 0;
+      for (unsigned long i = 0; i < iterations / 16; ++i)
+      {
+         b = shift_bits(b, 1 + i % 7);
+         b.set(0);
+         c += b.slot(0);
+      }
+      t.report(iterations / 16);
+      t::use(c);
+   }
+}
+
+void test()
+{
+   shifts<64>("bitset<64> <<=, >>=", "bitset<64> bit by bit <<", 10000000);
+   shifts<1024>("bitset<1024> <<=, >>=", "bitset<1024> bit by bit <<", 1000000);
+   shifts<65536>("bitset<65536> <<=, >>=", "bitset<65536> bit by bit <<", 20000);
+}
@@ -0,0 +1,128 @@
+// vim: sw=3 ts=8 et
+#include "bench.hpp"
+#include "ttl/bitset.hpp"
+
+// a filter intersection: two 64K bit sets
+typedef ttl::bitset<65536> mask;
+static const unsigned rounds = 20000;
+
+// the word loops, as the operations were before the SIMD kernels
+static ttl::size_t words_count_and(const mask &a, const mask &b)
+{
+   ttl::size_t c = 0;
+   for (ttl::size_t i = 0; i <= a.last_slot_index(); ++i)
+      c += __builtin_popcountl(a.slot(i) & b.slot(i));
+   return c;
+}
+static void words_and(mask &a, const mask &b)
+{
+   unsigned long *w = const_cast<unsigned long *>(a.data());
+   for (ttl::size_t i = 0; i <= a.last_slot_index(); ++i)
+      w[i] &= b.slot(i);
+}
+
+void test()
+{
+   static mask a, b, c;
+   for (ttl::size_t i = 0; i < a.size(); i += 3)
+      a.set(i);
+   for (ttl::size_t i = 0; i < b.size(); i += 7)
+      b.set(i);
+   // only the last bit can be in both a and c
+   c = ~a;
+   c.set(65535);
+#ifdef TTL_BITS_SIMD
+   printf("SIMD kernels: %s\n", ttl::bits_have_avx2() ? "AVX2": "SSE2");
+#else
+   printf("SIMD kernels: none\n");
+#endif
+   {
+      t::bench t("count()");
+      ttl::size_t s = 0;
+      for (unsigned r = 0; r < rounds; ++r)
+      {
+         a.flip(r % 64);
+         s += a.count();
+      }
+      t.report(rounds);
+      t::use(s);
+   }
+   {
+      t::bench t("count_and(a, b)");
+      ttl::size_t s = 0;
+      for (unsigned r = 0; r < rounds; ++r)
+      {
+         a.flip(r % 64);
+         s += ttl::count_and(a, b);
+      }
+      t.report(rounds);
+      t::use(s);
+   }
+   {
+      t::bench t("(a & b).count()");
+      ttl::size_t s = 0;
+      for (unsigned r = 0; r < rounds; ++r)
+      {
+         a.flip(r % 64);
+         s += (a & b).count();
+      }
+      t.report(rounds);
+      t::use(s);
+   }
+   {
+      t::bench t("count_and word loop");
+      ttl::size_t s = 0;
+      for (unsigned r = 0; r < rounds; ++r)
+      {
+         a.flip(r % 64);
+         s += words_count_and(a, b);
+      }
+      t.report(rounds);
+      t::use(s);
+   }
+   {
+      t::bench t("intersects(a, c)");
+      ttl::size_t s = 0;
+      for (unsigned r = 0; r < rounds; ++r)
+      {
+         c.flip(65535);
+         s += ttl::intersects(a, c);
+      }
+      t.report(rounds);
+      t::use(s);
+   }
+   {
+      t::bench t("a == b");
+      ttl::size_t s = 0;
+      mask d(a);
+      for (unsigned r = 0; r < rounds; ++r)
+      {
+         d.flip(65535);
+         s += d == a;
+      }
+      t.report(rounds);
+      t::use(s);
+   }
+   {
+      t::bench t("d &= b");
+      mask d;
+      for (unsigned r = 0; r < rounds; ++r)
+      {
+         d.set(r % 65536);
+         d &= b;
+      }
+      t.report(rounds);
+      t::use(d);
+   }
+   {
+      t::bench t("&= word loop");
+      mask d;
+      for (unsigned r = 0; r < rounds; ++r)
+      {
+         d.set(r % 65536);
+         words_and(d, b);
+      }
+      t.report(rounds);
+      t::use(d);
+   }
+}
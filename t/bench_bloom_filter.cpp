@@ -0,0 +1,78 @@
+// vim: sw=3 ts=8 et
+#include "bench.hpp"
+#include "ttl/bloom_filter.hpp"
+
+// 4M keys in 64M bits, 8 MiB: out of the caches
+enum { keys = 1 << 22, bits = keys * 16, queries = 1 << 22 };
+
+template<class Filter>
+static void rate(const char *name, Filter &f, unsigned n)
+{
+   f.clear();
+   for (unsigned i = 0; i < n; ++i)
+      f.insert(i * 2);
+   unsigned fp = 0;
+   for (unsigned i = 0; i < 1000000; ++i)
+      fp += f.might_contain(i * 2 + 1);
+   printf("%-40s %5.1f bits a key: %.4f%% false positives\n", name, (double)f.size() / n, fp / 10000.0);
+}
+
+template<class Filter>
+static void speed(const char *name, Filter &f, const unsigned *k, const unsigned *q, bool *out)
+{
+   char title[64];
+   f.clear();
+   snprintf(title, sizeof(title), "%s insert", name);
+   {
+      t::bench t(title);
+      f.insert(k, k + keys);
+      t.report(keys);
+   }
+   snprintf(title, sizeof(title), "%s might_contain", name);
+   {
+      t::bench t(title);
+      unsigned n = 0;
+      for (unsigned i = 0; i < queries; ++i)
+         n += f.might_contain(q[i]);
+      t.report(queries);
+      t::use(n);
+   }
+   snprintf(title, sizeof(title), "%s batched might_contain", name);
+   {
+      t::bench t(title);
+      unsigned n = f.might_contain(q, q + queries, out);
+      t.report(queries);
+      t::use(n);
+   }
+}
+
+void test()
+{
+   {
+      static ttl::bloom_filter<1 << 20, 7, unsigned> f;
+      static ttl::blocked_bloom_filter<1 << 20, 7, unsigned> b;
+      static ttl::bloom_filter<1 << 20, 4, unsigned> f4;
+      static ttl::blocked_bloom_filter<1 << 20, 4, unsigned> b4;
+      const unsigned per_key[] = { 8, 10, 16, 20 };
+      for (unsigned i = 0; i < sizeof(per_key) / sizeof(*per_key); ++i)
+      {
+         rate("bloom_filter, K = 7", f, (1 << 20) / per_key[i]);
+         rate("blocked_bloom_filter, K = 7", b, (1 << 20) / per_key[i]);
+         rate("bloom_filter, K = 4", f4, (1 << 20) / per_key[i]);
+         rate("blocked_bloom_filter, K = 4", b4, (1 << 20) / per_key[i]);
+      }
+   }
+   {
+      // half of the queries are of keys in the filter
+      static unsigned k[keys], q[queries];
+      static bool out[queries];
+      for (unsigned i = 0; i < keys; ++i)
+         k[i] = rnd();
+      for (unsigned i = 0; i < queries; ++i)
+         q[i] = i % 2 ? k[rnd() % keys]: rnd();
+      static ttl::bloom_filter<bits, 7, unsigned> f;
+      speed("bloom_filter", f, k, q, out);
+      static ttl::blocked_bloom_filter<bits, 7, unsigned> b;
+      speed("blocked_bloom_filter", b, k, q, out);
+   }
+}
@@ -0,0 +1,81 @@
+// vim: sw=3 ts=8 et
+#include "bench.hpp"
+#include "ttl/bitset.hpp"
+#include "ttl/hierarchical_bitset.hpp"
+
+// an ID allocator over 1M slots, nearly full
+static const ttl::size_t slots = 1 << 20;
+static const unsigned rounds = 100000;
+
+// the first clear bit of a bitset, a word at a time
+static ttl::size_t scan_first_clear(const ttl::bitset<slots> &b)
+{
+   for (ttl::size_t i = 0; i <= b.last_slot_index(); ++i)
+      if (~b.slot(i))
+         return i * 64 + __builtin_ctzl(~b.slot(i));
+   return slots;
+}
+
+void test()
+{
+   static ttl::bitset<slots> b;
+   static ttl::hierarchical_bitset<slots> h;
+   // all taken but for 1000 random ones, and the released ones are taken
+   // again at once
+   b.set();
+   h.set();
+   for (unsigned i = 0; i < 1000; ++i)
+   {
+      const ttl::size_t x = rnd() % slots;
+      b.reset(x);
+      h.reset(x);
+   }
+   const unsigned saved = rnd_seed;
+   {
+      t::bench t("bitset: release, acquire first clear");
+      ttl::size_t s = 0;
+      for (unsigned r = 0; r < rounds; ++r)
+      {
+         b.reset(rnd() % slots);
+         const ttl::size_t id = scan_first_clear(b);
+         b.set(id);
+         s += id;
+      }
+      t.report(rounds);
+      t::use(s);
+   }
+   rnd_seed = saved;
+   {
+      t::bench t("hierarchical_bitset: the same");
+      ttl::size_t s = 0;
+      for (unsigned r = 0; r < rounds; ++r)
+      {
+         h.reset(rnd() % slots);
+         const ttl::size_t id = h.find_first_clear();
+         h.set(id);
+         s += id;
+      }
+      t.report(rounds);
+      t::use(s);
+   }
+   {
+      t::bench t("bitset: find_first");
+      ttl::bitset<slots> e;
+      e.set(slots - 1);
+      ttl::size_t s = 0;
+      for (unsigned r = 0; r < rounds / 100; ++r)
+         s += e.find_first();
+      t.report(rounds / 100);
+      t::use(s);
+   }
+   {
+      t::bench t("hierarchical_bitset: find_first_set");
+      static ttl::hierarchical_bitset<slots> e;
+      e.set(slots - 1);
+      ttl::size_t s = 0;
+      for (unsigned r = 0; r < rounds; ++r)
+         s += e.find_first_set();
+      t.report(rounds);
+      t::use(s);
+   }
+}
@@ -0,0 +1,55 @@
+// vim: sw=3 ts=8 et
+#include "bench.hpp"
+#include "ttl/dynamic_bitset.hpp"
+#include "ttl/rank_select.hpp"
+
+static const unsigned bits = 1 << 22;
+static const unsigned queries = 1000000;
+
+void test()
+{
+   ttl::dynamic_bitset<> b(bits);
+   for (unsigned i = 0; i < bits; ++i)
+      if (rnd(4) == 0)
+         b.set(i);
+   ttl::rank_select<> rs;
+   {
+      t::bench t("build, 4M bits");
+      rs.build(b);
+      t.report(1);
+   }
+   printf("%lu set bits, %lu bytes of index for %lu bytes of bits\n", (unsigned long)rs.count(),
+          (unsigned long)rs.index_bytes(), (unsigned long)bits / 8);
+   unsigned *pos = new unsigned[queries];
+   for (unsigned i = 0; i < queries; ++i)
+      pos[i] = (rnd(1 << 15) << 15 | rnd(1 << 15)) % bits;
+   {
+      t::bench t("rank");
+      ttl::size_t s = 0;
+      for (unsigned i = 0; i < queries; ++i)
+         s += rs.rank(pos[i]);
+      t.report(queries);
+      t::use(s);
+   }
+   {
+      t::bench t("select");
+      ttl::size_t s = 0;
+      for (unsigned i = 0; i < queries; ++i)
+         s += rs.select(pos[i] % rs.count());
+      t.report(queries);
+      t::use(s);
+   }
+   {
+      t::bench t("rank by a count of the words");
+      ttl::size_t s = 0;
+      for (unsigned i = 0; i < queries / 1000; ++i)
+      {
+         const ttl::size_t w = pos[i] / (sizeof(long) * 8);
+         s += ttl::bits_count(b.data(), w) +
+            ttl::bits_popcount(b.slot(w) & ((1lu << pos[i] % (sizeof(long) * 8)) - 1));
+      }
+      t.report(queries / 1000);
+      t::use(s);
+   }
+   delete[] pos;
+}
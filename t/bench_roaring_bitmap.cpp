@@ -0,0 +1,98 @@
+// vim: sw=3 ts=8 et
+#include "bench.hpp"
+#include "ttl/dynamic_bitset.hpp"
+#include "ttl/roaring_bitmap.hpp"
+
+typedef ttl::roaring_bitmap<> bitmap;
+// the values are spread over 64M, 1024 chunks
+static const unsigned range = 1u << 26;
+
+static void report(const char *name, const bitmap &b)
+{
+   printf("%-40s %10lu values %10lu bytes serialized, %lu as a bitset\n", name,
+          (unsigned long)b.cardinality(), (unsigned long)b.serialized_bytes(), (unsigned long)range / 8);
+}
+
+// sparse, dense and run contents
+static void fill(bitmap &b, unsigned kind)
+{
+   if (kind == 0)
+      for (unsigned i = 0; i < 100000; ++i)
+         b.insert(rnd() % range);
+   else if (kind == 1)
+      for (unsigned i = 0; i < 20000000; ++i)
+         b.insert(rnd() % range);
+   else
+      for (unsigned r = 0; r < 1000; ++r)
+         for (unsigned i = rnd() % (range - 5000), n = i + rnd() % 5000; i < n; ++i)
+            b.insert(i);
+}
+
+void test()
+{
+   static const char *names[] = { "sparse", "dense", "runs" };
+   bitmap s[3];
+   for (unsigned k = 0; k < 3; ++k)
+   {
+      fill(s[k], k);
+      s[k].optimize();
+      report(names[k], s[k]);
+   }
+   {
+      t::bench t("insert, 1M sparse values");
+      bitmap b;
+      for (unsigned i = 0; i < 1000000; ++i)
+         b.insert(rnd() % range);
+      t.report(1000000);
+   }
+   {
+      t::bench t("contains, sparse");
+      unsigned long n = 0;
+      for (unsigned i = 0; i < 1000000; ++i)
+         n += s[0].contains(rnd() % range);
+      t.report(1000000);
+      t::use(n);
+   }
+   {
+      t::bench t("contains, dense");
+      unsigned long n = 0;
+      for (unsigned i = 0; i < 1000000; ++i)
+         n += s[1].contains(rnd() % range);
+      t.report(1000000);
+      t::use(n);
+   }
+   {
+      t::bench t("contains, dynamic_bitset");
+      ttl::dynamic_bitset<> p(range);
+      for (bitmap::const_iterator i = s[1].begin(); i != s[1].end(); ++i)
+         p.set(*i);
+      unsigned long n = 0;
+      for (unsigned i = 0; i < 1000000; ++i)
+         n += p[rnd() % range];
+      t.report(1000000);
+      t::use(n);
+   }
+   for (unsigned a = 0; a < 3; ++a)
+      for (unsigned b = a; b < 3; ++b)
+      {
+         char name[64];
+         snprintf(name, sizeof(name), "%s & %s", names[a], names[b]);
+         t::bench t(name);
+         bitmap r = s[a] & s[b];
+         t.report(1);
+         t::use(r);
+         snprintf(name, sizeof(name), "%s | %s", names[a], names[b]);
+         t::bench u(name);
+         r = s[a] | s[b];
+         u.report(1);
+         t::use(r);
+      }
+   {
+      t::bench t("iterate, dense");
+      unsigned long n = 0;
+      for (bitmap::const_iterator i = s[1].begin(); i != s[1].end(); ++i)
+         n += *i;
+      t.report(s[1].cardinality());
+      t::use(n);
+   }
+}
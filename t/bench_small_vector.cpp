@@ -0,0 +1,42 @@
+// vim: sw=3 ts=8 et
+#include "bench.hpp"
+#include "ttl/utility.hpp"
+#include "ttl/vector.hpp"
+#include "ttl/small_vector.hpp"
+
+// per-request list sizes: mostly under 8, a few much larger
+static unsigned sizes[100000];
+
+static void make_sizes()
+{
+   for (unsigned i = 0; i < countof(sizes); ++i)
+   {
+      unsigned r = rnd(100);
+      sizes[i] = r < 80 ? rnd(8): r < 95 ? 8 + rnd(56): 64 + rnd(960);
+   }
+}
+
+template<class Vector>
+static void fill(const char *name)
+{
+   t::bench b(name);
+   unsigned long elements = 0;
+   for (unsigned i = 0; i < countof(sizes); ++i)
+   {
+      Vector v;
+      for (unsigned k = 0; k < sizes[i]; ++k)
+         v.push_back(k);
+      elements += v.size();
+      t::use(v);
+   }
+   b.report(countof(sizes));
+   t::use(elements);
+}
+
+void test()
+{
+   make_sizes();
+   fill<ttl::vector<unsigned> >("vector<unsigned>");
+   fill<ttl::small_vector<unsigned, 8> >("small_vector<unsigned, 8>");
+   fill<ttl::small_vector<unsigned, 16> >("small_vector<unsigned, 16>");
+}
@@ -0,0 +1,86 @@
+// vim: sw=3 ts=8 et
+#include "bench.hpp"
+#include "ttl/vector.hpp"
+#include "ttl/soa_vector.hpp"
+
+#if __cplusplus >= 201103L // C++11
+// a 64 byte record, of which the scan reads 12
+struct record
+{
+   double price;
+   int qty;
+   int id;
+   char name[48];
+};
+struct name_type { char c[48]; };
+
+static const unsigned count = 1 << 20;
+static const unsigned passes = 20;
+
+static void aos(const ttl::vector<record> &v)
+{
+   t::bench b("scan price, qty: vector<record>");
+   double sum = 0;
+   for (unsigned p = 0; p < passes; ++p)
+      for (const record *r = v.begin(); r != v.end(); ++r)
+         if (r->qty > 5)
+            sum += r->price;
+   b.report((unsigned long)passes * count);
+   t::use(sum);
+}
+
+typedef ttl::soa_vector<double, int, int, name_type> records;
+
+static void soa(const records &v)
+{
+   t::bench b("scan price, qty: soa_vector columns");
+   double sum = 0;
+   for (unsigned p = 0; p < passes; ++p)
+   {
+      const double *price = v.data<0>();
+      const int *qty = v.data<1>();
+      for (ttl::size_t i = 0, n = v.size(); i < n; ++i)
+         if (qty[i] > 5)
+            sum += price[i];
+   }
+   b.report((unsigned long)passes * count);
+   t::use(sum);
+}
+
+static void soa_rows(const records &v)
+{
+   t::bench b("scan price, qty: soa_vector rows");
+   double sum = 0;
+   for (unsigned p = 0; p < passes; ++p)
+      for (auto r: v)
+         if (r.get<1>() > 5)
+            sum += r.get<0>();
+   b.report((unsigned long)passes * count);
+   t::use(sum);
+}
+
+void test()
+{
+   ttl::vector<record> v;
+   records s;
+   v.reserve(count);
+   s.reserve(count);
+   name_type name = { "" };
+   for (unsigned i = 0; i < count; ++i)
+   {
+      record r = { i * 0.25, int(i % 10), int(i), "" };
+      v.push_back(r);
+      s.push_back(r.price, r.qty, r.id, name);
+   }
+   printf("%u records, %lu bytes each, %lu bytes read per record by the column scan\n",
+          count, (unsigned long)sizeof(record), (unsigned long)(sizeof(double) + sizeof(int)));
+   aos(v);
+   soa(s);
+   soa_rows(s);
+}
+#else
+void test()
+{
+   printf("soa_vector needs C++11\n");
+}
+#endif
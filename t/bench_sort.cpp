@@ -0,0 +1,67 @@
+// vim: sw=3 ts=8 et
+#include <algorithm>
+#include "bench.hpp"
+#include "ttl/utility.hpp"
+#include "ttl/algorithm.hpp"
+
+// 1M ints, against the sorts of the standard library
+static const unsigned n = 1 << 20;
+static const unsigned rounds = 5;
+static int input[n], v[n];
+
+enum shape { random_keys, sorted_keys, reversed_keys, few_keys, shapes };
+static const char *const shape_names[] = { "random", "sorted", "reversed", "few keys" };
+
+static void fill(shape s)
+{
+   for (unsigned i = 0; i < n; ++i)
+      input[i] = s == random_keys ? (int)(rnd(1 << 15) << 15 | rnd(1 << 15)):
+                 s == sorted_keys ? (int)i:
+                 s == reversed_keys ? (int)(n - i): (int)rnd(16);
+}
+
+struct ttl_sort { static void run(int *f, int *l) { ttl::sort(f, l); } };
+struct std_sort { static void run(int *f, int *l) { std::sort(f, l); } };
+struct ttl_stable_sort { static void run(int *f, int *l) { ttl::stable_sort(f, l); } };
+struct std_stable_sort { static void run(int *f, int *l) { std::stable_sort(f, l); } };
+// the smallest 1000
+struct ttl_partial_sort { static void run(int *f, int *l) { ttl::partial_sort(f, f + 1000, l); } };
+struct std_partial_sort { static void run(int *f, int *l) { std::partial_sort(f, f + 1000, l); } };
+struct ttl_nth_element { static void run(int *f, int *l) { ttl::nth_element(f, f + (l - f) / 2, l); } };
+struct std_nth_element { static void run(int *f, int *l) { std::nth_element(f, f + (l - f) / 2, l); } };
+
+// the time per element, the copy of the input excluded
+template<class Sort>
+static void run(const char *what, shape s)
+{
+   char name[64];
+   snprintf(name, sizeof(name), "%s %s", what, shape_names[s]);
+   uint64_t ns = 0;
+   unsigned long allocs = t::allocations, bytes = t::allocated_bytes;
+   for (unsigned r = 0; r < rounds; ++r)
+   {
+      memcpy(v, input, sizeof(v));
+      const uint64_t start = t::now_ns();
+      Sort::run(v, v + n);
+      ns += t::now_ns() - start;
+      t::use(v[n / 2]);
+   }
+   printf("%-40s %10.2f ns/op %10lu allocs %12lu bytes\n", name, (double)ns / rounds / n,
+          t::allocations - allocs, t::allocated_bytes - bytes);
+}
+
+void test()
+{
+   for (int s = 0; s < shapes; ++s)
+   {
+      fill((shape)s);
+      run<ttl_sort>("ttl::sort", (shape)s);
+      run<std_sort>("std::sort", (shape)s);
+      run<ttl_stable_sort>("ttl::stable_sort", (shape)s);
+      run<std_stable_sort>("std::stable_sort", (shape)s);
+      run<ttl_partial_sort>("ttl::partial_sort 1000", (shape)s);
+      run<std_partial_sort>("std::partial_sort 1000", (shape)s);
+      run<ttl_nth_element>("ttl::nth_element", (shape)s);
+      run<std_nth_element>("std::nth_element", (shape)s);
+   }
+}
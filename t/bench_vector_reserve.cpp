@@ -0,0 +1,30 @@
+// vim: sw=3 ts=8 et
+#include "bench.hpp"
+#include "ttl/vector.hpp"
+#include "ttl/mmap_allocator.hpp"
+
+// grows a buffer by doubling its capacity, touching every element
+template<class Vector>
+static void grow(const char *name, ttl::size_t size)
+{
+   t::bench b(name);
+   Vector v;
+   unsigned long reallocations = 0;
+   for (ttl::size_t capacity = 4096; capacity <= size; capacity *= 2, ++reallocations)
+   {
+      v.reserve(capacity);
+      unsigned *tail = v.append_uninitialized(capacity - v.size());
+      for (unsigned *e = v.end(); tail != e; ++tail)
+         *tail = (unsigned)(e - tail);
+   }
+   b.report(reallocations);
+   t::use(v);
+}
+
+void test()
+{
+   const ttl::size_t size = 64 * 1024 * 1024; // 256MB of unsigned
+   grow<ttl::vector<unsigned> >("vector<unsigned>", size);
+   grow<ttl::vector<unsigned, ttl::mmap_allocator<> > >("vector<unsigned, mmap_allocator<> >", size);
+   grow<ttl::vector<unsigned, ttl::mmap_allocator<1024 * 1024, true> > >("vector<unsigned, mmap_allocator<huge> >", size);
+}
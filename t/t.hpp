@@ -27,6 +27,22 @@ namespace t
 
 template <class C> inline const C &constify(C &c) { return c; }
 
+// A pseudo-random generator, the same numbers on every run. Every test
+// has a sequence of its own, in rnd_seed, unless it passes its own seed.
+static unsigned rnd_seed = 1;
+static inline unsigned rnd(unsigned &seed, unsigned n)
+{
+   seed = seed * 1103515245 + 12345;
+   return (seed >> 16) % n;
+}
+static inline unsigned rnd(unsigned n) { return rnd(rnd_seed, n); }
+// all of the 32 bits
+static inline unsigned rnd()
+{
+   rnd_seed = rnd_seed * 1103515245 + 12345;
+   return (rnd_seed >> 8) ^ (rnd_seed << 20);
+}
+
 struct testtype
 {
    static bool verbose;
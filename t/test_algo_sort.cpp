@@ -0,0 +1,211 @@
+// vim: sw=3 ts=8 et
+#include "t.hpp"
+#include "ttl/utility.hpp"
+#include "ttl/functional.hpp"
+#include "ttl/algorithm.hpp"
+
+// ordered by key only, with the position it started at to check the
+// stability, and a count of the live ones for the buffer of stable_sort
+struct item
+{
+   static int live;
+   int key, index;
+   item(): key(0), index(0) { ++live; }
+   item(int k, int i): key(k), index(i) { ++live; }
+   item(const item &o): key(o.key), index(o.index) { ++live; }
+   ~item() { --live; }
+   bool operator<(const item &o) const { return key < o.key; }
+};
+int item::live = 0;
+
+struct by_key_desc
+{
+   bool operator()(const item &a, const item &b) const { return b.key < a.key; }
+};
+
+static const int max_n = 3000;
+
+enum shape { random_keys, few_keys, sorted_keys, reversed_keys, organ_pipe, shapes };
+static const char *const shape_names[] = { "random", "few keys", "sorted", "reversed", "organ pipe" };
+
+static void fill(item *v, int n, shape s)
+{
+   for (int i = 0; i < n; ++i)
+   {
+      int k = 0;
+      switch (s)
+      {
+      case random_keys: k = rnd(100000); break;
+      case few_keys: k = rnd(4); break;
+      case sorted_keys: k = i; break;
+      case reversed_keys: k = n - i; break;
+      case organ_pipe: k = i < n / 2 ? i: n - i; break;
+      default: break;
+      }
+      v[i] = item(k, i);
+   }
+}
+
+// the keys of v are those of the input, as counted by key modulo 1024
+static bool same_keys(const item *v, int n, const item *in)
+{
+   static int count[1024];
+   memset(count, 0, sizeof(count));
+   for (int i = 0; i < n; ++i)
+   {
+      ++count[in[i].key % 1024];
+      --count[v[i].key % 1024];
+   }
+   for (int i = 0; i < 1024; ++i)
+      if (count[i])
+         return false;
+   return true;
+}
+
+static bool stable(const item *v, int n)
+{
+   for (int i = 1; i < n; ++i)
+      if (v[i].key == v[i - 1].key && v[i].index < v[i - 1].index)
+         return false;
+   return true;
+}
+
+void test()
+{
+   static item in[max_n], v[max_n];
+   static const int sizes[] = { 0, 1, 2, 3, 15, 16, 17, 33, 100, 1000, max_n };
+
+   printf("sort\n");
+   for (int s = 0; s < shapes; ++s)
+      for (unsigned z = 0; z < countof(sizes); ++z)
+      {
+         const int n = sizes[z];
+         fill(in, n, (shape)s);
+         ttl::copy(in, in + n, v);
+         ttl::sort(v, v + n);
+         assert(ttl::is_sorted(v, v + n) && same_keys(v, n, in));
+         ttl::copy(in, in + n, v);
+         ttl::sort(v, v + n, by_key_desc());
+         assert(ttl::is_sorted(v, v + n, by_key_desc()) && same_keys(v, n, in));
+      }
+
+   printf("stable_sort, with and without a buffer\n");
+   for (int s = 0; s < shapes; ++s)
+   {
+      for (unsigned z = 0; z < countof(sizes); ++z)
+      {
+         const int n = sizes[z];
+         fill(in, n, (shape)s);
+         const int live = item::live;
+         ttl::copy(in, in + n, v);
+         ttl::stable_sort(v, v + n);
+         assert(ttl::is_sorted(v, v + n) && same_keys(v, n, in) && stable(v, n));
+         ttl::copy(in, in + n, v);
+         ttl::stable_sort(v, v + n, by_key_desc());
+         assert(ttl::is_sorted(v, v + n, by_key_desc()) && same_keys(v, n, in) && stable(v, n));
+         ttl::copy(in, in + n, v);
+         ttl::stable_sort(v, v + n, ttl::less<item>(), (item *)0);
+         assert(ttl::is_sorted(v, v + n) && same_keys(v, n, in) && stable(v, n));
+         // the buffer is left raw
+         void *raw = malloc(sizeof(item) * ((n + 1) / 2) + 1);
+         ttl::copy(in, in + n, v);
+         ttl::stable_sort(v, v + n, ttl::less<item>(), (item *)raw);
+         assert(ttl::is_sorted(v, v + n) && same_keys(v, n, in) && stable(v, n));
+         free(raw);
+         assert(item::live == live);
+      }
+      printf("  %s\n", shape_names[s]);
+   }
+
+   printf("partial_sort\n");
+   for (int s = 0; s < shapes; ++s)
+      for (unsigned z = 0; z < countof(sizes); ++z)
+      {
+         const int n = sizes[z];
+         fill(in, n, (shape)s);
+         const int ms[] = { 0, 1, n / 3, n };
+         for (unsigned m = 0; m < countof(ms); ++m)
+         {
+            ttl::copy(in, in + n, v);
+            ttl::partial_sort(v, v + ms[m], v + n);
+            assert(ttl::is_sorted(v, v + ms[m]) && same_keys(v, n, in));
+            for (int i = ms[m]; i < n && ms[m]; ++i)
+               assert(!(v[i] < v[ms[m] - 1]));
+         }
+      }
+
+   printf("nth_element\n");
+   for (int s = 0; s < shapes; ++s)
+      for (unsigned z = 0; z < countof(sizes); ++z)
+      {
+         const int n = sizes[z];
+         fill(in, n, (shape)s);
+         ttl::copy(in, in + n, v);
+         ttl::sort(v, v + n);
+         static item sorted[max_n];
+         ttl::copy(v, v + n, sorted);
+         for (int k = 0; k < n; k += 1 + n / 7)
+         {
+            ttl::copy(in, in + n, v);
+            ttl::nth_element(v, v + k, v + n);
+            assert(v[k].key == sorted[k].key && same_keys(v, n, in));
+            for (int i = 0; i < k; ++i)
+               assert(!(v[k] < v[i]));
+            for (int i = k + 1; i < n; ++i)
+               assert(!(v[i] < v[k]));
+         }
+         // nth == last does nothing
+         ttl::copy(in, in + n, v);
+         ttl::nth_element(v, v + n, v + n);
+         for (int i = 0; i < n; ++i)
+            assert(v[i].index == i);
+      }
+
+   printf("ints\n");
+   {
+      int a[] = { 5, 3, 9, 1, 7, 3, 8, 2, 6, 4, 0 };
+      ttl::sort(a, a + countof(a));
+      for (unsigned i = 0; i < countof(a); ++i)
+         assert(a[i] == (int)i - (i > 3));
+      ttl::sort(a, a + countof(a), ttl::greater<int>());
+      assert(ttl::is_sorted(a, a + countof(a), ttl::greater<int>()) && a[0] == 9);
+      ttl::stable_sort(a, a + countof(a));
+      assert(ttl::is_sorted(a, a + countof(a)));
+   }
+
+   printf("rotate\n");
+   {
+      int a[] = { 1, 2, 3, 4, 5, 6, 7 };
+      assert(ttl::rotate(a, a + 3, a + 7) == a + 4 && a[0] == 4 && a[3] == 7 && a[4] == 1 && a[6] == 3);
+      assert(ttl::rotate(a, a, a + 7) == a + 7 && ttl::rotate(a, a + 7, a + 7) == a && a[0] == 4);
+      // all the splits of a small range
+      for (int n = 1; n < 12; ++n)
+         for (int m = 0; m <= n; ++m)
+         {
+            int b[12];
+            for (int i = 0; i < n; ++i)
+               b[i] = i;
+            assert(ttl::rotate(b, b + m, b + n) == b + n - m);
+            for (int i = 0; i < n; ++i)
+               assert(b[i] == (i + m) % n);
+         }
+   }
+
+   printf("large ranges in place\n");
+   {
+      // a rotation of one element, and a merge without a buffer which
+      // rotates all the first run: neither recurses on the length
+      const int n = 4 << 20;
+      int *a = (int *)malloc(n * sizeof(int));
+      for (int i = 0; i < n; ++i)
+         a[i] = i;
+      assert(ttl::rotate(a, a + n - 1, a + n) == a + 1 && a[0] == n - 1 && a[1] == 0);
+      for (int i = 0; i < n; ++i)
+         a[i] = i + 1;
+      a[n - 1] = 0;
+      ttl::stable_sort(a, a + n, ttl::less<int>(), (int *)0);
+      for (int i = 0; i < n; ++i)
+         assert(a[i] == i);
+      free(a);
+   }
+}
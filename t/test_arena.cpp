@@ -0,0 +1,295 @@
+// vim: sw=3 ts=8 et
+#include "ttl/algorithm.hpp"
+#include "ttl/arena.hpp"
+#include "ttl/vector.hpp"
+#include "ttl/small_vector.hpp"
+#include "ttl/deque.hpp"
+#include "ttl/list.hpp"
+#include "ttl/forward_list.hpp"
+#include "ttl/backward_list.hpp"
+#include "ttl/lazy_queue.hpp"
+#include "ttl/map.hpp"
+#include "ttl/set.hpp"
+#include "ttl/interval_map.hpp"
+#include "ttl/sorted_vector_map.hpp"
+#include "ttl/soa_vector.hpp"
+#include "ttl/lru_cache.hpp"
+#include "t.hpp"
+
+namespace
+{
+   // counts the blocks it has outstanding, in a counter of its own
+   struct counting_allocator: ttl::allocator
+   {
+      int *live;
+      explicit counting_allocator(int &counter): live(&counter) {}
+      void *allocate(ttl::size_t bytes) { ++*live; return ttl::allocator::allocate(bytes); }
+      void deallocate(void *p, ttl::size_t bytes)
+      {
+         if (p)
+            --*live;
+         ttl::allocator::deallocate(p, bytes);
+      }
+   };
+
+   // a monotonic one, which counts the calls to deallocate
+   struct counting_arena
+   {
+      ttl::arena *a;
+      int *calls;
+      counting_arena(ttl::arena &r, int &counter): a(&r), calls(&counter) {}
+      void *allocate(ttl::size_t bytes) { return a->allocate(bytes); }
+      void deallocate(void *, ttl::size_t) { ++*calls; }
+      void *reallocate(void *, ttl::size_t, ttl::size_t) { return 0; }
+   };
+
+   typedef ttl::allocator_ref<ttl::arena> arena_ref;
+   typedef ttl::allocator_ref<ttl::pool> pool_ref;
+}
+
+namespace ttl
+{
+   template<> struct is_monotonic_allocator<counting_arena>: true_type {};
+}
+
+void test()
+{
+   printf("sizeof list<int> %lu, with arena %lu\n",
+          (unsigned long)sizeof(ttl::list<int>),
+          (unsigned long)sizeof(ttl::list<int, arena_ref>));
+   assert(sizeof(ttl::list<int>) == sizeof(ttl::list<int, ttl::allocator>));
+   assert(sizeof(ttl::map<int, int>) == sizeof(ttl::map<int, int, ttl::less<int>, ttl::allocator>));
+
+   printf("all the containers allocate through the allocator\n");
+   {
+      int live = 0;
+      counting_allocator a(live);
+      {
+         ttl::list<testtype, counting_allocator> l(a);
+         ttl::forward_list<testtype, counting_allocator> fl(a);
+         ttl::backward_list<testtype, counting_allocator> bl(a);
+         ttl::lazy_queue<testtype, counting_allocator> lq(a);
+         ttl::vector<testtype, counting_allocator> v(a);
+         ttl::small_vector<testtype, 2, counting_allocator> sv(a);
+         ttl::deque<testtype, 4, counting_allocator> d(a);
+         ttl::map<int, testtype, ttl::less<int>, counting_allocator> m(a);
+         ttl::set<int, ttl::less<int>, counting_allocator> s(a);
+         ttl::interval_map<int, int, ttl::less<int>, counting_allocator> im(a);
+         ttl::sorted_vector_map<int, int, ttl::less<int>, counting_allocator> svm(a);
+         ttl::lru_cache<int, testtype, 16, ttl::less<int>, ttl::lru_no_evict, false, counting_allocator> lru(a);
+#if __cplusplus >= 201103L
+         ttl::basic_soa_vector<counting_allocator, int, testtype> soa(a);
+#endif
+         testtype::verbose = false;
+         for (int i = 0; i < 20; ++i)
+         {
+            l.push_back(i);
+            fl.push_front(i);
+            bl.push_back(i);
+            lq.push_back(i);
+            v.push_back(i);
+            sv.push_back(i);
+            d.push_front(i);
+            m[i] = i;
+            s.insert(i);
+            im.insert(i, i + 1, i);
+            svm[i] = i;
+            lru.put(i, i);
+#if __cplusplus >= 201103L
+            soa.push_back(i, testtype(i));
+#endif
+         }
+         assert(live > 20 * 8); // a block per node at least
+         l.pop_front();
+         fl.pop_front();
+         bl.pop_front();
+         lq.pop_front();
+         lq.cleanup();
+         m.erase(3);
+         s.erase(3);
+         im.erase(3, 4);
+         lru.erase(10);
+
+         ttl::list<testtype, counting_allocator> lc(l);
+         ttl::map<int, testtype, ttl::less<int>, counting_allocator> mc(m);
+         assert(lc == l && mc == m);
+#if __cplusplus >= 201103L
+         ttl::basic_soa_vector<counting_allocator, int, testtype> soac(soa);
+         assert(soac.size() == 20 && soac[19].get<1>() == 19);
+#endif
+      }
+      printf("live blocks: %d\n", live);
+      assert(live == 0);
+   }
+
+   printf("arena\n");
+   {
+      ttl::arena a(1024);
+      {
+         ttl::list<int, arena_ref> l((arena_ref(a)));
+         ttl::map<int, int, ttl::less<int>, arena_ref> m((arena_ref(a)));
+         for (int i = 0; i < 1000; ++i)
+         {
+            l.push_back(i);
+            m[i] = -i;
+         }
+         assert(l.size() == 1000 && l.back() == 999);
+         assert(m[500] == -500);
+         ttl::list<int, arena_ref> c(l);
+         assert(&c.get_allocator().resource() == &a);
+         assert(c == l);
+      }
+      printf("blocks %lu\n", (unsigned long)a.blocks());
+      assert(a.blocks() > 1);
+      void *p = a.allocate(4000); // larger than a block
+      assert(p);
+      memset(p, 0, 4000);
+      a.reset();
+      assert(a.blocks() == 0);
+
+      // the last allocation grows in place
+      ttl::vector<int, arena_ref> v((arena_ref(a)));
+      v.reserve(16);
+      const int *data = v.data();
+      v.reserve(64);
+      assert(v.data() == data && v.capacity() == 64);
+      for (int i = 0; i < 64; ++i)
+         v.push_back(i);
+      assert(v.data() == data);
+      a.allocate(1);
+      v.reserve(128);
+      assert(v.data() != data);
+      for (int i = 0; i < 64; ++i)
+         assert(v[i] == i);
+   }
+
+   printf("growing blocks\n");
+   {
+      ttl::arena a(256);
+      unsigned char *prev = 0;
+      for (int i = 0; i < 10; ++i)
+      {
+         unsigned char *p = static_cast<unsigned char *>(a.allocate(200));
+         memset(p, i, 200);
+         if (prev)
+            assert(*prev == i - 1);
+         prev = p;
+      }
+      // 256, 512, 1024 and 2048 bytes
+      printf("blocks %lu\n", (unsigned long)a.blocks());
+      assert(a.blocks() == 4);
+      a.reset();
+      assert(a.blocks() == 0);
+      a.allocate(200);
+      a.allocate(200);
+      assert(a.blocks() == 2); // from the first size again
+   }
+
+   printf("stack buffer\n");
+   {
+      char buffer[4096];
+      ttl::arena a(buffer, sizeof(buffer), 1024);
+      for (int round = 0; round < 3; ++round)
+      {
+         {
+            ttl::map<int, int, ttl::less<int>, arena_ref> m((arena_ref(a)));
+            for (int i = 0; i < 50; ++i)
+               m[i] = i;
+            assert(m[49] == 49);
+            char *n = static_cast<char *>(static_cast<void *>(&m[0]));
+            assert(n >= buffer && n < buffer + sizeof(buffer));
+         }
+         assert(a.blocks() == 0);
+         a.reset();
+      }
+      ttl::vector<char, arena_ref> v((arena_ref(a)));
+      v.resize(5000, 'x');
+      assert(a.blocks() == 1);
+      assert(v.data() < buffer || v.data() >= buffer + sizeof(buffer));
+   }
+
+   printf("no walk to free the nodes of an arena\n");
+   {
+      ttl::arena a;
+      int calls = 0;
+      {
+         ttl::map<int, int, ttl::less<int>, counting_arena> m(counting_arena(a, calls));
+         ttl::list<int, counting_arena> l(counting_arena(a, calls));
+         ttl::forward_list<int, counting_arena> fl(counting_arena(a, calls));
+         ttl::lru_cache<int, int, 64, ttl::less<int>, ttl::lru_no_evict, false, counting_arena>
+            lru((counting_arena(a, calls)));
+         for (int i = 0; i < 100; ++i)
+         {
+            m[i] = i;
+            l.push_back(i);
+            fl.push_front(i);
+            lru.put(i, i);
+         }
+         assert(calls == 36); // the evictions
+         m.erase(5);
+         assert(calls == 37);
+         m.clear();
+         l.clear();
+         lru.clear();
+         assert(m.empty() && l.empty() && lru.empty());
+         l.push_back(1);
+         assert(l.size() == 1 && l.front() == 1);
+      }
+      assert(calls == 37);
+      {
+         // unless the elements have destructors
+         ttl::list<testtype, counting_arena> l(counting_arena(a, calls));
+         for (int i = 0; i < 10; ++i)
+            l.push_back(i);
+      }
+      assert(calls == 47);
+   }
+
+   printf("pool\n");
+   {
+      ttl::pool p(0, 16);
+      {
+         ttl::set<int, ttl::less<int>, pool_ref> s((pool_ref(p)));
+         for (int i = 0; i < 100; ++i)
+            s.insert(i);
+         assert(p.size() > sizeof(int));
+         assert(p.free_blocks() == 12); // 7 chunks of 16
+         for (int i = 0; i < 100; i += 2)
+            s.erase(i);
+         assert(p.free_blocks() == 62);
+         for (int i = 0; i < 50; ++i)
+            s.insert(1000 + i); // reused
+         assert(p.free_blocks() == 12);
+         assert(s.count(1049) && !s.count(0));
+      }
+      assert(p.free_blocks() == 112);
+
+      // the allocations of another size do not use the blocks
+      ttl::sorted_vector_map<int, int, ttl::less<int>, pool_ref> svm((pool_ref(p)));
+      svm[1] = 1;
+      assert(p.free_blocks() == 112);
+   }
+
+   printf("splice between the lists of the same arena\n");
+   {
+      ttl::arena a, b;
+      assert(ttl::allocators_equal(arena_ref(a), arena_ref(a)));
+      assert(!ttl::allocators_equal(arena_ref(a), arena_ref(b)));
+      assert(ttl::allocators_equal(ttl::allocator(), ttl::allocator()));
+      ttl::list<int, arena_ref> l((arena_ref(a))), m((arena_ref(a)));
+      for (int i = 0; i < 4; ++i)
+      {
+         l.push_back(2 * i);
+         m.push_back(2 * i + 1);
+      }
+      l.merge(m);
+      assert(l.size() == 8 && m.empty());
+      l.splice(l.begin(), m); // nothing to move
+      m.splice(m.end(), l, l.begin());
+      m.splice(m.end(), l, l.begin(), l.end());
+      assert(l.empty() && m.size() == 8);
+      int i = 0;
+      for (ttl::list<int, arena_ref>::const_iterator it = m.begin(); it != m.end(); ++it)
+         assert(*it == i++);
+   }
+}
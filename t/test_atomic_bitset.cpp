@@ -0,0 +1,86 @@
+// vim: sw=3 ts=8 et
+#include <pthread.h>
+#include "ttl/atomic_bitset.hpp"
+#include "t.hpp"
+
+template class ttl::atomic_bitset<1000>;
+
+enum { threads = 4, ids = 300, held = 100, rounds = 200000 };
+
+static ttl::atomic_bitset<ids> bits;
+// the thread holding each ID, 0 for none
+static int owner[ids];
+static int failed;
+
+// takes and releases IDs at random, each one held by a single thread
+static void *worker(void *arg)
+{
+   const int self = (int)(ttl::size_t)arg;
+   unsigned seed = self;
+   ttl::size_t mine[held], n = 0, hint = self * ids / threads;
+   for (unsigned r = 0; r < rounds; ++r)
+   {
+      if (n < held && rnd(seed, 2))
+      {
+         const ttl::size_t id = bits.acquire_first_clear(hint);
+         if (id == bits.size())
+            continue;
+         int none = 0;
+         if (!__atomic_compare_exchange_n(&owner[id], &none, self + 1, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            __atomic_store_n(&failed, 1, __ATOMIC_RELAXED);
+         mine[n++] = hint = id;
+      }
+      else if (n)
+      {
+         const ttl::size_t i = rnd(seed, n), id = mine[i];
+         mine[i] = mine[--n];
+         if (__atomic_exchange_n(&owner[id], 0, __ATOMIC_RELAXED) != self + 1)
+            __atomic_store_n(&failed, 1, __ATOMIC_RELAXED);
+         if (!bits.test_and_reset(id))
+            __atomic_store_n(&failed, 1, __ATOMIC_RELAXED);
+      }
+   }
+   return (void *)n;
+}
+
+void test()
+{
+   printf("single thread\n");
+   {
+      static ttl::atomic_bitset<130> b;
+      assert(b.none() && b.size() == 130);
+      assert(!b.test_and_set(5) && b.test_and_set(5) && b[5]);
+      assert(b.test_and_reset(5) && !b.test_and_reset(5) && !b[5]);
+      for (ttl::size_t i = 0; i < 130; ++i)
+         assert(b.acquire_first_clear() == i);
+      assert(b.all() && b.count() == 130 && b.acquire_first_clear() == 130);
+      b.reset(129);
+      b.reset(3);
+      // from the word of the hint, then round to the first
+      assert(b.acquire_first_clear(100) == 129);
+      assert(b.acquire_first_clear(100) == 3);
+      assert(b.acquire_first_clear(1000) == 130);
+      b.reset(64);
+      assert(b.acquire_first_clear(129) == 64);
+      b.reset();
+      assert(b.none() && b.acquire_first_clear(128) == 128);
+   }
+
+   printf("%d threads taking %d IDs\n", threads, ids);
+   {
+      pthread_t t[threads];
+      for (int i = 0; i < threads; ++i)
+         pthread_create(&t[i], 0, worker, (void *)(ttl::size_t)i);
+      ttl::size_t n = 0;
+      for (int i = 0; i < threads; ++i)
+      {
+         void *r;
+         pthread_join(t[i], &r);
+         n += (ttl::size_t)r;
+      }
+      assert(!failed);
+      assert(bits.count() == n);
+      for (ttl::size_t i = 0; i < ids; ++i)
+         assert(bits.test(i) == (owner[i] != 0));
+   }
+}
@@ -1,5 +1,6 @@
 // vim: sw=3 ts=8 et
 #include <bitset>
+#include "ttl/utility.hpp"
 #include "ttl/bitset.hpp"
 #include "t.hpp"
 
@@ -22,6 +23,13 @@ ttl::bitset<16> &negate(ttl::bitset<16> &bs)
    return bs = ~bs;
 }
 
+// counts and sums the positions of the set bits
+struct collect
+{
+   unsigned n, sum;
+   void operator()(ttl::size_t i) { ++n; sum += i; }
+};
+
 void test()
 {
    ttl::bitset<128> bs0(0xfefeffUL);
@@ -30,6 +38,7 @@ void test()
    ttl::bitset<256> bs2("0101010101");
    ttl::bitset<0>   bs3("0101010101");
    ttl::bitset<0>   bs3_ = bs3;
+   assert(bs3_ == bs3);
 
    print_bitset("<128>:UL  ", bs0);
    print_bitset("<128>:ULL ", bs064);
@@ -65,6 +74,11 @@ void test()
    assert(bs4.to_ulong() == 0xfffdul);
    print_bitset("rset      ", bs4);
 
+   bs4.set(1, true);
+   assert(bs4.to_ulong() == 0xfffful);
+   bs4.set(1, false);
+   assert(bs4.to_ulong() == 0xfffdul);
+
    bs4.flip();
    assert(bs4.to_ulong() == 0x2ul);
    print_bitset("flip      ", bs4);
@@ -212,6 +226,75 @@ void test()
    print_bitset("<66>:65 >>  1: ", ttl::bitset<66>().set(65) >> 1);
    assert(ttl::bitset<66>().set(65) >> 1 == ttl::bitset<66>().set(64));
 
+   {
+      // the word shifts against the bits one by one, with the unused bits
+      // of the last word set
+      ttl::bitset<200> b200;
+      b200.set();
+      b200.reset(3).reset(64).reset(100).reset(199);
+      const unsigned shifts[] = { 0, 1, 5, 63, 64, 65, 128, 131, 199, 200, 300 };
+      for (unsigned j = 0; j < countof(shifts); ++j)
+      {
+         const unsigned sh = shifts[j];
+         ttl::bitset<200> l = b200 << sh, r = b200 >> sh;
+         unsigned lc = 0, rc = 0;
+         for (unsigned i = 0; i < 200; ++i)
+         {
+            assert(l[i] == (i >= sh && b200[i - sh]));
+            assert(r[i] == (i + sh < 200 && b200[i + sh]));
+            lc += l[i];
+            rc += r[i];
+         }
+         assert(l.count() == lc && r.count() == rc);
+         ttl::bitset<200> l2(b200), r2(b200);
+         assert((l2 <<= sh) == l && (r2 >>= sh) == r);
+      }
+   }
+
+   {
+      // the scans of the set bits, with the unused bits of the last word
+      // set to be ignored
+      ttl::bitset<200> b200;
+      assert(b200.find_first() == 200 && b200.find_last() == 200);
+      b200.set(199 + 8);
+      assert(b200.find_first() == 200 && b200.find_last() == 200);
+      const unsigned pos[] = { 0, 5, 63, 64, 130, 199 };
+      for (unsigned j = 0; j < countof(pos); ++j)
+         b200.set(pos[j]);
+      unsigned j = 0;
+      for (ttl::size_t i = b200.find_first(); i < b200.size(); i = b200.find_next(i))
+         assert(i == pos[j++]);
+      assert(j == countof(pos) && b200.find_last() == 199);
+      b200.reset(199);
+      assert(b200.find_last() == 130 && b200.find_next(130) == 200);
+      collect c = { 0, 0 };
+      c = b200.for_each_set(c);
+      assert(c.n == 5 && c.sum == 0 + 5 + 63 + 64 + 130);
+      assert(ttl::bitset<64>(0x8001ul).find_last() == 15 && ttl::bitset<64>(0x8000ul).find_first() == 15);
+   }
+
+   {
+      // the long sets go through the SIMD kernels, the last words and the
+      // unused bits through the word loops
+      ttl::bitset<1300> a, b;
+      for (unsigned i = 0; i < 1300; i += 3)
+         a.set(i);
+      for (unsigned i = 0; i < 1300; i += 5)
+         b.set(i);
+      assert(a.count() == 434 && b.count() == 260);
+      assert(ttl::count_and(a, b) == 87 && (a & b).count() == 87);
+      assert((a | b).count() == 434 + 260 - 87 && (a ^ b).count() == 434 + 260 - 2 * 87);
+      assert(ttl::intersects(a, b) && !ttl::intersects(a, ~a));
+      assert((~a).count() == 1300 - 434 && ~~a == a);
+      ttl::bitset<1300> c(a);
+      assert(c == a);
+      c.flip(1298);
+      assert(c != a && ttl::count_and(c, ~a) == 1 && ttl::intersects(c, ~a));
+      c = a;
+      c.set(1300 + 5);
+      assert(c == a && c.count() == a.count());
+   }
+
    assert((bs3 & bs3) == (bs3 &= bs3));
    assert((bs3 |= bs3) == (bs3 | bs3));
    assert((bs3 ^= bs3) == (bs3 ^ bs3));
@@ -227,12 +310,78 @@ void test()
 
    {
       // setting a bit in the unused space must not affect the result of
-      // count()
-      ttl::bitset<16> b16;
-      b16.set(16, true);
-      assert(b16.count() == 0);
-      assert(b16.all() == false);
-      assert(b16.any() == false);
-      assert(b16.none() == true);
+      // count(); bitset<16> has none, with its 16 bit word
+      ttl::bitset<12> b12;
+      b12.set(12, true);
+      b12.set(15);
+      assert(b12.count() == 0);
+      assert(b12.all() == false);
+      assert(b12.any() == false);
+      assert(b12.none() == true);
+      assert(b12.to_ulong() == 0);
+   }
+
+   {
+      // the words by default are the smallest which hold the set
+      assert(sizeof(ttl::bitset<1>) == 1 && sizeof(ttl::bitset<8>) == 1);
+      assert(sizeof(ttl::bitset<10>) == 2 && sizeof(ttl::bitset<16>) == 2);
+      assert(sizeof(ttl::bitset<17>) == 4 && sizeof(ttl::bitset<32>) == 4);
+      assert(sizeof(ttl::bitset<33>) == sizeof(unsigned long) && sizeof(ttl::bitset<200>) % sizeof(unsigned long) == 0);
+      struct packed { ttl::bitset<10> flags; unsigned short id; };
+      assert(sizeof(packed) == 4);
+
+      // a chosen word, the same bits
+      ttl::bitset<100, unsigned char> b8(0x123456789abcdef0ull);
+      ttl::bitset<100, unsigned> b32(0x123456789abcdef0ull);
+      ttl::bitset<100> b64(0x123456789abcdef0ull);
+      assert(sizeof(b8) == 13 && b8.capacity() == 104);
+      assert(b8.to_ullong() == 0x123456789abcdef0ull && b32.to_ullong() == 0x123456789abcdef0ull);
+      assert(b8.count() == b64.count() && b32.count() == b64.count());
+      for (ttl::size_t i = 0; i < 100; ++i)
+         assert(b8[i] == b64[i] && b32[i] == b64[i]);
+      b8.set(99).set(70);
+      b64.set(99).set(70);
+      assert(b8.find_first() == b64.find_first() && b8.find_last() == 99 && b8.find_next(64) == 70);
+      assert((b8 << 29).count() == (b64 << 29).count() && (b8 >> 29).to_ullong() == (b64 >> 29).to_ullong());
+      assert((ttl::bitset<100>(b8) == b64 && ttl::bitset<100, unsigned char>(b64) == b8));
+      ttl::bitset<100, unsigned char> c8(b8);
+      c8.flip(3);
+      assert(ttl::count_and(b8, c8) == b8.count() - b8[3] && (b8 ^ c8).count() == 1);
+      // and through the SIMD kernels
+      ttl::bitset<1300, unsigned char> l8;
+      ttl::bitset<1300> l64;
+      for (unsigned i = 0; i < 1300; i += 3)
+      {
+         l8.set(i);
+         l64.set(i);
+      }
+      assert(l8.count() == 434 && (l8 & ~l8).none() && (l8 | ~l8).all());
+      assert((l8 == ttl::bitset<1300, unsigned char>(l64)));
+      ttl::bitset<3, unsigned char> b3(0xfful);
+      assert(b3.count() == 3 && b3.all() && b3.to_ulong() == 7);
+   }
+
+#if defined(TTL_BITS_SIMD) && defined(__x86_64__)
+   {
+      // the lanes of the popcount sums hold counts of 2^32 bits and more
+      assert(ttl::bits_sse2_sum(_mm_set_epi64x(1ll << 32, 5)) == ((ttl::size_t)1 << 32) + 5);
+   }
+#endif
+
+#if __cplusplus >= 201103L // C++11
+   {
+      // constant bitsets
+      constexpr ttl::bitset<12> k(0x801ul);
+      static_assert(k.test(0) && k[11] && !k.test(1) && !k.test(12), "constexpr test");
+      static_assert(ttl::bitset<64, unsigned char>(0x8000000000000001ull).test(63), "constexpr construction");
+      static_assert(ttl::bitset<100, unsigned char>(~0ull).test(63) && !ttl::bitset<100, unsigned char>(~0ull).test(64), "constexpr construction");
+      static_assert(!ttl::bitset<200>().test(5), "constexpr default");
+      assert(k.count() == 2);
+#if __cplusplus >= 201402L // C++14
+      constexpr ttl::bitset<12> m = ttl::bitset<12>(0x30ul).set(9).reset(4).flip(0).set(1, true);
+      static_assert(m[9] && !m[4] && m[5] && m[0] && m[1] && !m[2], "constexpr set, reset, flip");
+      assert(m.to_ulong() == 0x223);
+#endif
    }
+#endif
 }
@@ -0,0 +1,92 @@
+// vim: sw=3 ts=8 et
+#include "ttl/bloom_filter.hpp"
+#include "t.hpp"
+
+template class ttl::bloom_filter<1000, 3>;
+template class ttl::blocked_bloom_filter<1000, 3>;
+
+// a hash of C strings, FNV-1a
+struct string_hash
+{
+   ttl::size_t operator()(const char *s) const
+   {
+      ttl::size_t h = 2166136261u;
+      for (; *s; ++s)
+         h = (h ^ (unsigned char)*s) * 16777619u;
+      return h;
+   }
+};
+
+enum { keys = 10000 };
+
+// no false negatives, false positives near the expected rate, the batched
+// queries as the single ones
+template<class Filter>
+static void check(Filter &f, double expected)
+{
+   static unsigned k[keys];
+   static bool maybe[keys];
+   for (unsigned i = 0; i < keys; ++i)
+      k[i] = i * 7919 + 13;
+   f.clear();
+   assert(f.count() == 0 && !f.might_contain(k[0]));
+   f.insert(k, k + keys);
+   for (unsigned i = 0; i < keys; ++i)
+      assert(f.might_contain(k[i]));
+   assert(f.might_contain(k, k + keys, maybe) == keys);
+   // keys which were not inserted
+   for (unsigned i = 0; i < keys; ++i)
+      k[i] = i * 7919 + 14;
+   ttl::size_t fp = 0;
+   for (unsigned i = 0; i < keys; ++i)
+      fp += f.might_contain(k[i]);
+   assert(f.might_contain(k, k + keys, maybe) == fp);
+   for (unsigned i = 0; i < keys; ++i)
+      assert(maybe[i] == f.might_contain(k[i]));
+   const double rate = (double)fp / keys;
+   printf("%lu bits set of %lu, %.4f false positives, %.4f expected\n",
+          (unsigned long)f.count(), (unsigned long)f.size(), rate, expected);
+   assert(rate < expected * 2 + 0.002);
+}
+
+void test()
+{
+   printf("bloom_filter\n");
+   {
+      // 10 bits a key
+      static ttl::bloom_filter<keys * 10, 7, unsigned> f;
+      check(f, 0.0082);
+      static ttl::bloom_filter<keys * 20, 4, unsigned> g;
+      check(g, 0.0024);
+   }
+
+   printf("blocked_bloom_filter\n");
+   {
+      static ttl::blocked_bloom_filter<keys * 10, 7, unsigned> f;
+      assert(f.size() % 512 == 0 && f.size() >= keys * 10);
+      check(f, 0.0082);
+      static ttl::blocked_bloom_filter<keys * 20, 4, unsigned> g;
+      check(g, 0.0024);
+   }
+
+   printf("a hash of strings\n");
+   {
+      static ttl::bloom_filter<4096, 5, const char *, string_hash> f;
+      static ttl::blocked_bloom_filter<4096, 5, const char *, string_hash> b;
+      const char *in[] = { "alpha", "beta", "gamma", "delta" };
+      f.insert(in, in + 4);
+      b.insert(in, in + 4);
+      for (unsigned i = 0; i < 4; ++i)
+      {
+         char copy[16];
+         strcpy(copy, in[i]);
+         assert(f.might_contain(copy) && b.might_contain(copy));
+      }
+      assert(!f.might_contain("epsilon") && !b.might_contain("epsilon"));
+      // the union has the keys of both
+      static ttl::bloom_filter<4096, 5, const char *, string_hash> g;
+      g.insert("epsilon");
+      g |= f;
+      assert(g.might_contain("epsilon") && g.might_contain("alpha"));
+   }
+}
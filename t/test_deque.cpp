@@ -0,0 +1,102 @@
+// vim: sw=3 ts=8 et
+#include "ttl/utility.hpp"
+#include "ttl/algorithm.hpp"
+#include "ttl/deque.hpp"
+#include "t.hpp"
+
+template class ttl::deque<testtype, 4>;
+
+static int live;
+
+struct counted
+{
+   int value;
+   counted(int v = 0): value(v) { ++live; }
+   counted(const counted &o): value(o.value) { ++live; }
+   ~counted() { --live; }
+};
+
+void test()
+{
+   typedef ttl::deque<testtype, 4> testdeque;
+   static const int numbers[] = {0,1,2,3,4,5,6,7,8,9};
+
+   printf("default ctor:\n");
+   testdeque d0;
+   testtype::verbose = false;
+   assert(d0.empty() && d0.begin() == d0.end());
+
+   printf("push_back, push_front\n");
+   for (int i = 5; i < 10; ++i)
+      d0.push_back(testtype(i));
+   for (int i = 4; i >= 0; --i)
+      d0.push_front(testtype(i));
+   print_iter("d0: ", d0.cbegin(), d0.cend());
+   assert(d0.size() == 10);
+   assert(ttl::equal(d0.cbegin(), d0.cend(), numbers, numbers + 10));
+   assert(d0.front() == 0 && d0.back() == 9 && d0[7] == 7);
+
+   printf("random access iterators\n");
+   {
+      testdeque::iterator i = d0.begin() + 6;
+      assert(*i == 6 && i[-2] == 4 && i - d0.begin() == 6);
+      i -= 3;
+      assert(i->value == 3);
+      assert(d0.begin() < i && i <= d0.end());
+      testdeque::const_iterator c = i;
+      assert(*--c == 2);
+   }
+
+   printf("stable references\n");
+   {
+      ttl::deque<int, 8> d;
+      d.push_back(0);
+      int *first = &d.front();
+      for (int i = 1; i < 1000; ++i)
+         d.push_back(i), d.push_front(-i);
+      assert(first == &d[999] && *first == 0);
+      assert(d.size() == 1999 && d.front() == -999 && d.back() == 999);
+      for (int i = 0; i < 999; ++i)
+         d.pop_front();
+      assert(first == &d.front());
+   }
+
+   printf("queue\n");
+   {
+      ttl::deque<counted, 16> q;
+      int next = 0, expected = 0;
+      for (int round = 0; round < 100; ++round)
+      {
+         for (int i = 0; i < 37; ++i)
+            q.push_back(counted(next++));
+         while (q.size() > 5)
+         {
+            assert(q.front().value == expected++);
+            q.pop_front();
+         }
+      }
+      assert(live == 5);
+      ttl::deque<counted, 16> c(q);
+      assert(live == 10);
+      while (!q.empty())
+         q.pop_back();
+      q.clean();
+      assert(c.size() == 5 && c.back().value == next - 1);
+   }
+   assert(live == 0);
+
+   printf("copy, assignment, swap\n");
+   {
+      testdeque a(numbers, numbers + 10), b;
+      b = a;
+      assert(a == b);
+      b.pop_front();
+      assert(a != b);
+      a.swap(b);
+      assert(a.size() == 9 && b.size() == 10 && a.front() == 1);
+      a.clear();
+      assert(a.empty());
+      a.push_front(testtype(1));
+      assert(a.size() == 1 && a.back() == 1);
+   }
+}
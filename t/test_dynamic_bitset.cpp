@@ -0,0 +1,199 @@
+// vim: sw=3 ts=8 et
+#include "ttl/utility.hpp"
+#include "ttl/arena.hpp"
+#include "ttl/dynamic_bitset.hpp"
+#include "t.hpp"
+
+template class ttl::dynamic_bitset<>;
+
+typedef ttl::dynamic_bitset<> bits;
+
+// the bits, one per bool
+struct plain
+{
+   bool b[2000];
+   unsigned n;
+};
+
+static void fill(bits &s, plain &p, unsigned n)
+{
+   s.resize(n);
+   s.reset();
+   p.n = n;
+   for (unsigned i = 0; i < n; ++i)
+   {
+      p.b[i] = rnd(3) == 0;
+      s.set(i, p.b[i]);
+   }
+}
+
+static bool same(const bits &s, const plain &p)
+{
+   if (s.size() != p.n)
+      return false;
+   unsigned c = 0;
+   for (unsigned i = 0; i < p.n; ++i)
+   {
+      if (s[i] != p.b[i])
+         return false;
+      c += p.b[i];
+   }
+   return s.count() == c && s.any() == (c != 0) && s.all() == (c == p.n && c);
+}
+
+// sums the positions of the set bits
+struct sum
+{
+   ttl::size_t s;
+   void operator()(ttl::size_t i) { s += i; }
+};
+
+void test()
+{
+   printf("set, reset, flip, resize\n");
+   {
+      bits s;
+      assert(s.empty() && s.none() && !s.all() && s.count() == 0);
+      assert(s.is_inline() && s.capacity() == s.inline_capacity());
+      s.resize(70, true);
+      assert(s.size() == 70 && s.all() && s.count() == 70 && s.is_inline());
+      s.reset(3).flip(69);
+      assert(!s[3] && !s[69] && s.count() == 68 && !s.all());
+      s[3] = true;
+      assert(s.test(3) && !s.test(70));
+      s.resize(75);
+      assert(s.count() == 69 && !s[72]);
+      s.resize(200, true);
+      assert(!s.is_inline() && s.count() == 69 + 125);
+      s.resize(66);
+      assert(s.all() && s.slots() == 2 && s.slot(1) == 3);
+      s.flip();
+      assert(s.none() && s.slot(0) == 0);
+      s.set();
+      assert(s.all());
+      s.clear();
+      assert(s.empty() && s.none());
+   }
+
+   printf("push_back\n");
+   {
+      bits s;
+      for (unsigned i = 0; i < 300; ++i)
+         s.push_back(i % 3 == 0);
+      assert(s.size() == 300 && s.count() == 100);
+      for (unsigned i = 0; i < 300; ++i)
+         assert(s[i] == (i % 3 == 0));
+      s.pop_back();
+      assert(s.size() == 299 && s.count() == 100);
+      s.pop_back();
+      s.pop_back();
+      assert(s.size() == 297 && s.count() == 99);
+   }
+
+   printf("operators against bools\n");
+   {
+      static plain p, q;
+      bits a, b;
+      const unsigned sizes[] = { 1, 5, 63, 64, 65, 127, 128, 129, 500, 1000, 1300, 2000 };
+      for (unsigned k = 0; k < countof(sizes); ++k)
+      {
+         const unsigned n = sizes[k];
+         fill(a, p, n);
+         fill(b, q, n);
+         assert(same(a, p) && same(b, q));
+
+         bits c = a & b;
+         plain r = p;
+         for (unsigned i = 0; i < n; ++i)
+            r.b[i] = p.b[i] && q.b[i];
+         assert(same(c, r));
+         c = a | b;
+         for (unsigned i = 0; i < n; ++i)
+            r.b[i] = p.b[i] || q.b[i];
+         assert(same(c, r));
+         c = a ^ b;
+         for (unsigned i = 0; i < n; ++i)
+            r.b[i] = p.b[i] != q.b[i];
+         assert(same(c, r));
+         c = ~a;
+         for (unsigned i = 0; i < n; ++i)
+            r.b[i] = !p.b[i];
+         assert(same(c, r));
+         assert(a == a && a != c && (a ^ a).none());
+         assert(ttl::count_and(a, b) == (a & b).count());
+         assert(ttl::intersects(a, b) == (a & b).any() && !ttl::intersects(a, c));
+         c = a;
+         c.flip(n - 1);
+         assert(c != a && ttl::intersects(c, ~a) == !a[n - 1] && ttl::count_and(c, ~a) == !a[n - 1]);
+
+         const unsigned shifts[] = { 0, 1, 7, 63, 64, 65, 130, n - 1, n, n + 5 };
+         for (unsigned j = 0; j < countof(shifts); ++j)
+         {
+            const unsigned sh = shifts[j];
+            c = a << sh;
+            for (unsigned i = 0; i < n; ++i)
+               r.b[i] = i >= sh && p.b[i - sh];
+            assert(same(c, r));
+            c = a >> sh;
+            for (unsigned i = 0; i < n; ++i)
+               r.b[i] = i + sh < n && p.b[i + sh];
+            assert(same(c, r));
+         }
+      }
+   }
+
+   printf("find_first, find_next, find_last, for_each_set\n");
+   {
+      static plain p;
+      bits a;
+      const unsigned sizes[] = { 1, 63, 64, 65, 200, 1000 };
+      for (unsigned k = 0; k < countof(sizes); ++k)
+      {
+         const unsigned n = sizes[k];
+         fill(a, p, n);
+         unsigned expected = 0;
+         while (expected < n && !p.b[expected])
+            ++expected;
+         for (ttl::size_t i = a.find_first(); i < n; i = a.find_next(i))
+         {
+            assert(i == expected);
+            while (++expected < n && !p.b[expected]);
+         }
+         assert(expected == n);
+         unsigned last = n;
+         for (unsigned i = 0; i < n; ++i)
+            if (p.b[i])
+               last = i;
+         assert(a.find_last() == last);
+         a.reset();
+         assert(a.find_first() == n && a.find_last() == n);
+      }
+      bits b(300);
+      b.set(2).set(64).set(299);
+      sum s = { 0 };
+      assert(b.for_each_set(s).s == 2 + 64 + 299);
+   }
+
+   printf("copy, swap, allocator\n");
+   {
+      bits a(10, true), b(1000);
+      b.set(999);
+      bits c(b);
+      assert(c == b && c.count() == 1);
+      a.swap(b);
+      assert(a.size() == 1000 && a[999] && b.size() == 10 && b.all());
+      bits d(2000);
+      d.set(1);
+      ttl::swap(a, d);
+      assert(a.size() == 2000 && a[1] && d.size() == 1000 && d[999]);
+
+      typedef ttl::allocator_ref<ttl::arena> arena_ref;
+      ttl::arena ar;
+      ttl::dynamic_bitset<0, arena_ref> e((arena_ref(ar)));
+      assert(!e.is_inline() || e.capacity() == 0);
+      e.resize(4096, true);
+      assert(e.count() == 4096 && ar.blocks() >= 1);
+      ttl::dynamic_bitset<0, arena_ref> f(e);
+      assert(f == e && f.get_allocator() == e.get_allocator());
+   }
+}
@@ -4,6 +4,12 @@
 #include "ttl/fixed_vector.hpp"
 #include "t.hpp"
 
+struct is_odd
+{
+   bool operator()(int v) const { return v & 1; }
+   bool operator()(const testtype &t) const { return t.value & 1; }
+};
+
 void test()
 {
    typedef ttl::fixed_vector<testtype, 16> testvector;
@@ -198,6 +204,65 @@ void test()
       assert(ttl::equal(v.begin(), v.end(), ascii, ascii + countof(ascii)));
    }
 
+   {
+      printf("try_push_back, append\n");
+      testvector v;
+      assert(v.append(in, in + countof(in)) == 5);
+      assert(v.append(ascii, ascii + countof(ascii)) == 7);
+      assert(v.append(ascii, ascii + countof(ascii)) == 4);
+      assert(v.full() && v.back() == ascii[3]);
+      assert(!v.try_push_back(testtype(1)));
+      v.pop_back();
+      assert(v.try_push_back(testtype(1)) && v.back() == 1);
+      assert(v.append_n(in, 5) == 0);
+      v.clear();
+      assert(v.append_n(ascii, 3) == 3 && v[2] == ascii[2]);
+
+      // trivially copyable: memcpy
+      ttl::fixed_vector<int, 8> iv;
+      assert(iv.append(ascii, ascii + 5) == 5);
+      assert(iv.append(ascii, ascii + 5) == 3);
+      assert(ttl::equal(iv.begin(), iv.begin() + 5, ascii, ascii + 5));
+      assert(ttl::equal(iv.begin() + 5, iv.end(), ascii, ascii + 3));
+      iv.clear();
+      int *p = const_cast<int *>(ascii);
+      assert(iv.append_n(p, 7) == 7);
+      assert(iv.append(p, p) == 0);
+      assert(iv.append_n(p, 7) == 1);
+      assert(ttl::equal(iv.begin(), iv.begin() + 7, ascii, ascii + 7));
+      assert(iv.back() == ascii[0]);
+   }
+
+   {
+      printf("erase_unordered, erase_if\n");
+      testvector v;
+      v.assign(ascii, ascii + countof(ascii));
+      assert(*v.erase_unordered(v.begin() + 1) == ascii[6]);
+      assert(v.size() == 6 && v[1] == ascii[6] && v[5] == ascii[5]);
+      assert(v.erase_unordered(v.end() - 1) == v.end());
+      assert(v.size() == 5 && v.back() == ascii[4]);
+      v.push_back(testtype('H'));
+      assert(v.erase_if(is_odd()) == 4); // 'A', 'G', 'C', 'D', 'E', 'H'
+      assert(v.size() == 2 && v[0] == 'D' && v[1] == 'H');
+
+      ttl::fixed_vector<int, 16> iv;
+      for (int i = 0; i < 10; ++i)
+         iv.push_back(i);
+      assert(iv.erase_if(is_odd()) == 5);
+      for (int i = 0; i < 5; ++i)
+         assert(iv[i] == i * 2);
+      assert(*iv.erase_unordered(iv.begin()) == 8);
+      assert(iv.size() == 4 && iv[0] == 8 && iv[3] == 6);
+      assert(iv.erase_if(is_odd()) == 0 && iv.size() == 4);
+   }
+
+   {
+      printf("elements aligned beyond a pointer\n");
+      struct { char c; ttl::fixed_vector<long double, 2> v; } s;
+      s.v.push_back(1);
+      assert((ttl::size_t)s.v.data() % __alignof__(long double) == 0);
+   }
+
    printf("destructors:\n");
    testtype::verbose = true;
 }
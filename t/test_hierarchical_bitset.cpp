@@ -0,0 +1,112 @@
+// vim: sw=3 ts=8 et
+#include "ttl/utility.hpp"
+#include "ttl/bitset.hpp"
+#include "ttl/hierarchical_bitset.hpp"
+#include "t.hpp"
+
+template class ttl::hierarchical_bitset<1 << 20>;
+
+// the scans against a bitset with the same bits
+template<ttl::size_t N>
+static void check(const ttl::hierarchical_bitset<N> &h, const ttl::bitset<N> &b)
+{
+   assert(h.count() == b.count() && h.any() == b.any() && h.none() == b.none() && h.all() == b.all());
+   ttl::size_t first_clear = N;
+   for (ttl::size_t i = 0; i < N; ++i)
+      if (!b[i])
+      {
+         first_clear = i;
+         break;
+      }
+   assert(h.find_first_set() == b.find_first());
+   assert(h.find_first_clear() == first_clear);
+   for (ttl::size_t n = 0; n < 20; ++n)
+   {
+      const ttl::size_t i = rnd(N);
+      assert(h.test(i) == b.test(i) && h[i] == b[i]);
+      assert(h.find_next_set(i) == b.find_next(i));
+      ttl::size_t c = i + 1;
+      while (c < N && b[c])
+         ++c;
+      assert(h.find_next_clear(i) == c);
+   }
+}
+
+template<ttl::size_t N>
+static void random(unsigned density)
+{
+   static ttl::hierarchical_bitset<N> h;
+   static ttl::bitset<N> b;
+   h.reset();
+   b.reset();
+   check(h, b);
+   for (unsigned round = 0; round < 200; ++round)
+   {
+      for (unsigned i = 0; i < 20; ++i)
+      {
+         const ttl::size_t x = rnd(N);
+         const bool v = rnd(100) < density;
+         h.set(x, v);
+         b.set(x, v);
+      }
+      check(h, b);
+   }
+   h.set();
+   b.set();
+   check(h, b);
+   // a single clear bit, anywhere
+   for (unsigned i = 0; i < 20; ++i)
+   {
+      const ttl::size_t x = rnd(N);
+      h.reset(x);
+      b.reset(x);
+      check(h, b);
+      assert(h.find_first_clear() == x && h.find_next_clear(x) == N);
+      h.set(x);
+      b.set(x);
+   }
+   assert(h.all() && h.find_first_clear() == N);
+}
+
+void test()
+{
+   printf("random, against bitset\n");
+   {
+      const unsigned density[] = { 5, 50, 95 };
+      for (unsigned d = 0; d < countof(density); ++d)
+      {
+         random<1>(density[d]);
+         random<63>(density[d]);
+         random<64>(density[d]);
+         random<65>(density[d]);
+         random<4096>(density[d]);
+         random<4097>(density[d]);
+         random<300000>(density[d]);
+      }
+   }
+
+   printf("ID allocation in 1M\n");
+   {
+      static ttl::hierarchical_bitset<1 << 20> ids;
+      // the first IDs go in order
+      for (ttl::size_t i = 0; i < 200000; ++i)
+      {
+         const ttl::size_t id = ids.find_first_clear();
+         assert(id == i);
+         ids.set(id);
+      }
+      assert(ids.count() == 200000);
+      ids.reset(70000).reset(3);
+      assert(ids.find_first_clear() == 3);
+      ids.set(3);
+      assert(ids.find_first_clear() == 70000);
+      ids.set(70000);
+      assert(ids.find_first_clear() == 200000 && ids.find_next_clear(200000) == 200001);
+      ids.set();
+      assert(ids.find_first_clear() == ids.size() && ids.find_next_set(ids.size() - 2) == ids.size() - 1);
+      ids.reset(ids.size() - 1);
+      assert(ids.find_first_clear() == ids.size() - 1 && ids.find_next_set(ids.size() - 2) == ids.size());
+      ids.reset();
+      assert(ids.none() && ids.find_first_set() == ids.size());
+   }
+}
@@ -0,0 +1,139 @@
+// vim: sw=3 ts=8 et
+#include "t.hpp"
+#include "ttl/interval_map.hpp"
+
+typedef ttl::interval_map<int, int> imap;
+
+struct collector
+{
+   int count, sum;
+   collector(): count(0), sum(0) {}
+   void operator()(const imap::value_type &v) { ++count; sum += v.second; }
+};
+
+static bool red(const ttl::rbnode *n)
+{
+   return n && n->color == ttl::rbnode::RED;
+}
+
+// checks the tree invariants, returns the black height
+static int check(const ttl::rbnode *n, int &max)
+{
+   if (!n)
+      return 1;
+   const imap::node *x = static_cast<const imap::node *>(n);
+   int lmax = x->data.first.second, rmax = lmax;
+   int lh = check(n->left, lmax);
+   int rh = check(n->right, rmax);
+   assert(lh == rh);
+   assert(!red(n->right)); // left-leaning
+   assert(!(red(n) && red(n->left)));
+   if (n->left)
+      assert(n->left->parent == n);
+   if (n->right)
+      assert(n->right->parent == n);
+   max = lmax > rmax ? lmax: rmax;
+   if (x->data.first.second > max)
+      max = x->data.first.second;
+   assert(x->max == max);
+   return lh + !red(n);
+}
+
+static void check(const imap &m)
+{
+   int max = 0;
+   check(m.get_root(), max);
+}
+
+struct interval { int lo, hi; bool in; };
+
+static void compare(const imap &m, const interval *iv, int n, int lo, int hi)
+{
+   collector c = m.find_overlapping(lo, hi, collector());
+   int count = 0, sum = 0;
+   for (int i = 0; i < n; ++i)
+      if (iv[i].in && iv[i].lo < hi && lo < iv[i].hi)
+         ++count, sum += i;
+   assert(c.count == count);
+   assert(c.sum == sum);
+   assert(m.overlaps(lo, hi) == (count != 0));
+}
+
+void test()
+{
+   printf("sizeof interval_map<int,int>::node %lu\n", (unsigned long)sizeof(imap::node));
+   {
+      imap m;
+      assert(m.empty());
+      assert(m.begin() == m.end());
+      assert(!m.overlaps(0, 10));
+      assert(m.find_overlapping(0, 10, collector()).count == 0);
+   }
+
+   imap m;
+   assert(m.insert(10, 20, 1).second);
+   assert(m.insert(15, 16, 2).second);
+   assert(m.insert(30, 40, 3).second);
+   assert(!m.insert(10, 20, 4).second); // unique intervals
+   assert(m.find(10, 20)->second == 1);
+   assert(m.find(10, 21) == m.end());
+   check(m);
+
+   printf("find_overlapping\n");
+   assert(m.find_overlapping(0, 10, collector()).count == 0); // half-open
+   assert(m.find_overlapping(20, 30, collector()).count == 0);
+   assert(m.find_overlapping(19, 31, collector()).count == 2);
+   assert(m.find_overlapping(15, 16, collector()).sum == 3);
+   assert(m.overlaps(39, 100));
+   assert(!m.overlaps(40, 100));
+
+   printf("iteration\n");
+   {
+      int prev = -1;
+      for (imap::const_iterator i = constify(m).begin(); i != constify(m).end(); ++i)
+      {
+         assert(prev < i->first.first);
+         prev = i->first.first;
+      }
+   }
+
+   printf("erase\n");
+   assert(m.erase(10, 20) == 1);
+   assert(m.erase(10, 20) == 0);
+   check(m);
+   assert(m.find_overlapping(17, 19, collector()).count == 0);
+   m.erase(m.find(15, 16));
+   check(m);
+   m.clear();
+   assert(m.empty());
+
+   printf("random intervals\n");
+   static interval iv[600];
+   const int n = countof(iv);
+   for (int i = 0; i < n; ++i)
+   {
+      iv[i].lo = rnd(10000);
+      iv[i].hi = iv[i].lo + 1 + rnd(i % 10 ? 50: 2000);
+      iv[i].in = m.insert(iv[i].lo, iv[i].hi, i).second;
+   }
+   check(m);
+   for (int q = 0; q < 200; ++q)
+   {
+      int lo = rnd(10000);
+      compare(m, iv, n, lo, lo + 1 + rnd(300));
+   }
+   for (int i = 0; i < n; i += 2)
+      if (iv[i].in)
+      {
+         assert(m.erase(iv[i].lo, iv[i].hi) == 1);
+         iv[i].in = false;
+         if (!(i % 64))
+            check(m);
+      }
+   check(m);
+   for (int q = 0; q < 200; ++q)
+   {
+      int lo = rnd(10000);
+      compare(m, iv, n, lo, lo + 1 + rnd(300));
+   }
+}
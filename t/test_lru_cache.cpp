@@ -0,0 +1,92 @@
+// vim: sw=3 ts=8 et
+#include "t.hpp"
+#include "ttl/lru_cache.hpp"
+
+static int evicted_key, evictions;
+
+struct on_evict
+{
+   template<typename Pair>
+   void operator()(Pair &p) const { evicted_key = p.first; ++evictions; }
+};
+
+static int live;
+
+struct counted
+{
+   int v;
+   counted(int i = 0): v(i) { ++live; }
+   counted(const counted &o): v(o.v) { ++live; }
+   ~counted() { --live; }
+};
+
+template<class Cache>
+static void test_cache()
+{
+   evictions = 0;
+   {
+      Cache c;
+      assert(c.empty());
+      assert(!c.lru() && !c.mru());
+      assert(!c.get(1));
+      for (int i = 0; i < 4; ++i)
+         assert(c.put(i, counted(i * 10)).second);
+      assert(c.full());
+      assert(c.size() == 4);
+      assert(c.lru()->first == 0);
+      assert(c.mru()->first == 3);
+
+      assert(c.get(0)->v == 0); // touch: 1 is the least recently used now
+      assert(c.lru()->first == 1);
+      assert(c.peek(1)->v == 10); // does not touch
+      assert(c.lru()->first == 1);
+
+      assert(c.put(4, counted(40)).second);
+      assert(evictions == 1 && evicted_key == 1);
+      assert(!c.contains(1));
+      assert(c.size() == 4);
+
+      assert(!c.put(2, counted(22)).second); // assign and touch
+      assert(c.get(2)->v == 22);
+      assert(c.lru()->first == 3);
+      assert(c.put(5, counted(50)).second);
+      assert(evicted_key == 3);
+
+      assert(c.erase(0));
+      assert(!c.erase(0));
+      assert(c.size() == 3);
+      assert(c.put(6, counted(60)).second);
+      assert(evictions == 2);
+      assert(live == 4);
+
+      for (int i = 100; i < 200; ++i)
+         c.put(i, counted(i));
+      assert(evictions == 102);
+      assert(c.lru()->first == 196 && c.mru()->first == 199);
+      c.clear();
+      assert(c.empty() && live == 0);
+      c.put(1, counted(1));
+   }
+   assert(live == 0);
+}
+
+void test()
+{
+   typedef ttl::lru_cache<int, counted, 4, ttl::less<int>, on_evict> heap_cache;
+   typedef ttl::lru_cache<int, counted, 4, ttl::less<int>, on_evict, true> pool_cache;
+   printf("sizeof lru_cache<int,int,4> %lu, preallocated %lu\n",
+          (unsigned long)sizeof(ttl::lru_cache<int, int, 4>),
+          (unsigned long)sizeof(ttl::lru_cache<int, int, 4, ttl::less<int>, ttl::lru_no_evict, true>));
+   printf("heap nodes\n");
+   test_cache<heap_cache>();
+   printf("preallocated nodes\n");
+   test_cache<pool_cache>();
+
+   printf("preallocated nodes of a value aligned beyond a pointer\n");
+   {
+      ttl::lru_cache<int, long double, 8, ttl::less<int>, ttl::lru_no_evict, true> c;
+      for (int i = 0; i < 8; ++i)
+         assert((ttl::size_t)c.put(i, i).first % __alignof__(long double) == 0);
+      assert(*c.get(7) == 7);
+   }
+}
@@ -13,6 +13,13 @@
 
 typedef ttl::map<int, char> i2cmap;
 
+static unsigned long comparisons;
+
+struct counting_less
+{
+   bool operator()(int a, int b) const { ++comparisons; return a < b; }
+};
+
 
 namespace ttl
 {
@@ -234,4 +241,55 @@ void test()
          printf(" {%d: 0x%02x}", it->first, (unsigned char)it->second);
       printf("\n");
    }
+   printf("try_emplace, insert_or_assign\n");
+   {
+      i2cmap ma;
+      assert(ma.try_emplace(1, 'a').second == true);
+      assert(ma.try_emplace(1, 'b').second == false);
+      assert(ma.try_emplace(1, 'b').first->second == 'a');
+      assert(ma.try_emplace(2).second == true);
+      assert(ma.at(2) == '\0');
+      assert(ma.insert_or_assign(1, 'c').second == false);
+      assert(ma.at(1) == 'c');
+      assert(ma.insert_or_assign(3, 'd').second == true);
+      assert(ma.insert_or_assign(3, 'd').first == ma.find(3));
+      assert(ma.at(3) == 'd');
+      ++ma[4];
+      ++ma[4];
+      assert(ma.at(4) == 2);
+   }
+   printf("operator[] descends the tree once\n");
+   {
+      ttl::map<int, int, counting_less> mc;
+      for (int i = 0; i < 64; ++i)
+         mc[i] = i;
+      comparisons = 0;
+      for (int i = 0; i < 64; ++i)
+         ++mc[i];
+      unsigned long upsert = comparisons;
+      comparisons = 0;
+      for (int i = 0; i < 64; ++i)
+         assert(mc.find(i)->second == i + 1);
+      printf(" comparisons: operator[] %lu, find %lu\n", upsert, comparisons);
+      assert(upsert == comparisons);
+   }
+   printf("count_range, range\n");
+   {
+      i2cmap ma;
+      for (int i = 0; i < 100; i += 2)
+         ma[i] = (char)i;
+      assert(ma.count_range(10, 20) == 5);
+      assert(ma.count_range(11, 21) == 5);
+      assert(ma.count_range(-10, 1000) == 50);
+      assert(ma.count_range(20, 10) == 0);
+      assert(ma.count_range(10, 10) == 0);
+      assert(ma.count_range(99, 1000) == 0);
+      int n = 0;
+      ttl::iterator_range<i2cmap::iterator> r = ma.range(10, 20);
+      for (i2cmap::iterator it = r.begin(); it != r.end(); ++it, ++n)
+         assert(it->first == 10 + n * 2);
+      assert(n == 5);
+      assert(constify(ma).range(20, 10).empty());
+      assert(ma.range(200, 300).begin() == ma.end());
+   }
 }
@@ -0,0 +1,82 @@
+// vim: sw=3 ts=8 et
+#include "ttl/algorithm.hpp"
+#include "ttl/vector.hpp"
+#include "ttl/mmap_allocator.hpp"
+#include "t.hpp"
+
+typedef ttl::mmap_allocator<16 * 1024, true> small_threshold;
+
+// counts the blocks the allocator grew
+struct counting_remap: small_threshold
+{
+   static unsigned remaps;
+   void *reallocate(void *p, ttl::size_t bytes, ttl::size_t new_bytes)
+   {
+      void *n = small_threshold::reallocate(p, bytes, new_bytes);
+      remaps += n != 0;
+      return n;
+   }
+};
+unsigned counting_remap::remaps = 0;
+
+void test()
+{
+   printf("sizeof vector<int> %lu, with mmap_allocator %lu\n",
+          (unsigned long)sizeof(ttl::vector<int>),
+          (unsigned long)sizeof(ttl::vector<int, small_threshold>));
+   assert(sizeof(ttl::vector<int>) == sizeof(ttl::vector<int, small_threshold>));
+   assert(small_threshold::round(1) == (ttl::size_t)sysconf(_SC_PAGESIZE));
+
+   printf("growth across the threshold\n");
+   {
+      ttl::vector<unsigned, small_threshold> v;
+      unsigned n = 0;
+      for (ttl::size_t capacity = 16; capacity <= 1024 * 1024; capacity *= 2)
+      {
+         v.reserve(capacity);
+         assert(v.capacity() == capacity);
+         unsigned *tail = v.append_uninitialized(capacity - v.size());
+         for (unsigned *e = v.end(); tail != e; ++tail)
+            *tail = n++;
+      }
+      for (unsigned i = 0; i < v.size(); ++i)
+         assert(v[i] == i);
+      v.resize(10);
+      v.push_back(10);
+      assert(v.size() == 11 && v.back() == 10);
+   }
+
+   printf("push_back and insert grow with mremap\n");
+   {
+      ttl::vector<unsigned, counting_remap> v;
+      for (unsigned i = 0; i < 8192; ++i)
+         v.push_back(i);
+      // the capacity doubles: one mremap per doubling, not per element
+      assert(counting_remap::remaps > 0 && counting_remap::remaps <= 4);
+      assert(v.capacity() == 8192);
+      const unsigned remaps = counting_remap::remaps;
+      v.insert(v.begin() + 100, 3, 7u);
+      assert(counting_remap::remaps > remaps);
+      // the values in the vector outlive the move of its block
+      for (unsigned i = 0; i < 3000; ++i)
+         v.push_back(v[i]);
+      v.insert(v.begin(), v.back());
+      assert(v.size() == 8192 + 3 + 3000 + 1);
+      assert(v[0] == v.back() && v[1] == 0 && v[101] == 7 && v[104] == 100);
+      for (unsigned i = 0; i < 3000; ++i)
+         assert(v[8192 + 3 + 1 + i] == v[1 + i]);
+   }
+
+   printf("non-relocatable elements\n");
+   {
+      testtype::verbose = false;
+      ttl::vector<testtype, small_threshold> v;
+      for (int i = 0; i < 5000; ++i)
+         v.push_back(testtype(i));
+      v.reserve(20000);
+      for (int i = 0; i < 5000; ++i)
+         assert(v[i] == i);
+      ttl::vector<testtype, small_threshold> c(v);
+      assert(c == v);
+   }
+}
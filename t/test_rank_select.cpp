@@ -0,0 +1,96 @@
+// vim: sw=3 ts=8 et
+#include "ttl/utility.hpp"
+#include "ttl/bitset.hpp"
+#include "ttl/dynamic_bitset.hpp"
+#include "ttl/rank_select.hpp"
+#include "t.hpp"
+
+template class ttl::rank_select<>;
+template class ttl::rank_select<ttl::allocator, unsigned char>;
+
+// rank and select of every position against a count of the bits
+template<class Bits>
+static void check(const Bits &b)
+{
+   ttl::rank_select<ttl::allocator, typename Bits::slot_type> rs(b);
+   assert(rs.size() == b.size() && rs.count() == b.count());
+   ttl::size_t r = 0;
+   for (ttl::size_t i = 0; i < b.size(); ++i)
+   {
+      assert(rs.rank(i) == r);
+      if (b[i])
+      {
+         assert(rs.select(r) == i);
+         ++r;
+      }
+   }
+   assert(rs.rank(b.size()) == r && rs.select(r) == b.size());
+}
+
+void test()
+{
+   printf("dynamic_bitset, random densities\n");
+   {
+      const unsigned sizes[] = { 0, 1, 63, 64, 65, 511, 512, 2047, 2048, 2049, 5000, 8192, 20000 };
+      const unsigned density[] = { 1, 2, 10, 1000 };
+      for (unsigned k = 0; k < countof(sizes); ++k)
+         for (unsigned d = 0; d < countof(density); ++d)
+         {
+            ttl::dynamic_bitset<> b(sizes[k]);
+            for (unsigned i = 0; i < sizes[k]; ++i)
+               if (rnd(density[d]) == 0)
+                  b.set(i);
+            check(b);
+         }
+      ttl::dynamic_bitset<> all(10000, true);
+      check(all);
+      ttl::dynamic_bitset<> none(10000);
+      check(none);
+   }
+
+   printf("bitset, with the unused bits of the last word set\n");
+   {
+      static ttl::bitset<5000> b;
+      b.set();
+      for (unsigned i = 0; i < 5000; i += 3)
+         b.reset(i);
+      b.reset(4999);
+      check(b);
+      // only the bits after a few empty superblocks
+      b.reset();
+      b.set(4100).set(4998);
+      ttl::rank_select<> rs(b);
+      assert(rs.select(0) == 4100 && rs.select(1) == 4998 && rs.select(2) == 5000);
+      assert(rs.rank(4100) == 0 && rs.rank(4101) == 1 && rs.rank(4999) == 2);
+   }
+
+   printf("bitsets of small words\n");
+   {
+      ttl::bitset<20> b20(0xf0f0ful);
+      check(b20);
+      ttl::rank_select<ttl::allocator, ttl::bitset<20>::slot_type> rs(b20);
+      assert(rs.count() == 12 && rs.rank(19) == 11 && rs.select(0) == 0 && rs.select(4) == 8);
+      ttl::bitset<12> b12(0x801ul);
+      check(b12);
+      ttl::bitset<5> b5(0x1aul);
+      check(b5);
+      // many words of 8 bits, across superblocks
+      static ttl::bitset<5000, unsigned char> b8;
+      for (unsigned i = 0; i < 5000; ++i)
+         if (rnd(3) == 0)
+            b8.set(i);
+      check(b8);
+   }
+
+   printf("overhead\n");
+   {
+      ttl::dynamic_bitset<> b(1 << 20);
+      ttl::rank_select<> rs(b);
+      printf("%lu bytes of index for %lu bytes of bits\n",
+             (unsigned long)rs.index_bytes(), (unsigned long)b.size() / 8);
+      assert(rs.index_bytes() * 100 <= b.size() / 8 * 5);
+      ttl::dynamic_bitset<> empty;
+      rs.build(empty);
+      assert(rs.size() == 0 && rs.count() == 0 && rs.rank(0) == 0 && rs.select(0) == 0);
+   }
+}
@@ -0,0 +1,103 @@
+// vim: sw=3 ts=8 et
+// Changes the layout of rbnode, so it is not linked into all-in-one
+#define TTL_RBTREE_SUBTREE_SIZE 1
+#include "t.hpp"
+#include "ttl/rbtree.hpp"
+#include "ttl/map.hpp"
+#include "ttl/interval_map.hpp"
+
+typedef ttl::rbtree<int, int, ttl::select_same<int>, ttl::less<int> > inttree;
+
+static ttl::size_t check(const ttl::rbnode *n)
+{
+   if (!n)
+      return 0;
+   ttl::size_t size = 1 + check(n->left) + check(n->right);
+   assert(n->size == size);
+   return size;
+}
+
+static bool in[1000];
+
+static ttl::size_t brute_count(int lo, int hi)
+{
+   ttl::size_t c = 0;
+   for (int i = lo; i < hi; ++i)
+      c += in[i];
+   return c;
+}
+
+void test()
+{
+   inttree t;
+   assert(t.count_range(0, 10) == 0);
+   assert(t.rank(5) == 0);
+
+   printf("random insert\n");
+   for (int i = 0; i < 700; ++i)
+   {
+      int k = rnd(countof(in));
+      in[k] = t.insert_unique(k).second || in[k];
+   }
+   check(t.get_root());
+   assert(t.rank(countof(in)) == brute_count(0, countof(in)));
+   for (int q = 0; q < 300; ++q)
+   {
+      int lo = rnd(countof(in)), hi = rnd(countof(in));
+      assert(t.count_range(lo, hi) == (lo < hi ? brute_count(lo, hi): 0));
+      assert(t.rank(lo) == brute_count(0, lo));
+   }
+
+   printf("random erase\n");
+   for (int i = 0; i < 500; ++i)
+   {
+      int k = rnd(countof(in));
+      inttree::node *n = t.remove(k);
+      assert(!!n == in[k]);
+      delete n;
+      in[k] = false;
+      if (!(i % 50))
+         check(t.get_root());
+   }
+   check(t.get_root());
+   for (int q = 0; q < 300; ++q)
+   {
+      int lo = rnd(countof(in)), hi = rnd(countof(in));
+      assert(t.count_range(lo, hi) == (lo < hi ? brute_count(lo, hi): 0));
+   }
+
+   printf("copy\n");
+   {
+      inttree c;
+      c.assign(t);
+      check(c.get_root());
+      assert(c.count_range(0, countof(in)) == t.count_range(0, countof(in)));
+   }
+
+   printf("map\n");
+   {
+      ttl::map<int, int> m;
+      for (int i = 0; i < 100; ++i)
+         m[i * 10] = i;
+      assert(m.count_range(0, 1000) == 100);
+      assert(m.count_range(15, 55) == 4);
+      for (int i = 0; i < 100; i += 2)
+         m.erase(i * 10);
+      assert(m.count_range(0, 1000) == 50);
+      assert(m.count_range(15, 55) == 2);
+   }
+
+   printf("interval_map\n");
+   {
+      ttl::interval_map<int, int> im;
+      for (int i = 0; i < 300; ++i)
+      {
+         int lo = rnd(10000);
+         im.insert(lo, lo + 1 + rnd(100), i);
+      }
+      check(im.get_root());
+      for (int i = 0; i < 300; ++i)
+         im.erase(im.begin());
+      assert(im.empty());
+   }
+}
@@ -0,0 +1,77 @@
+// vim: sw=3 ts=8 et
+// Changes the layout of rbtree_base, so it is not linked into all-in-one
+#define TTL_RBTREE_STATS 1
+#include "t.hpp"
+#include "ttl/map.hpp"
+#include "ttl/set.hpp"
+
+static void print(const char *name, const ttl::rbtree_stats &s)
+{
+   printf("%s: nodes %lu height %lu black height %lu\n"
+          "  lookups %lu comparisons %lu rotations %lu flips %lu"
+          " move_left %lu move_right %lu allocations %lu\n",
+          name, (unsigned long)s.nodes, (unsigned long)s.height,
+          (unsigned long)s.black_height,
+          s.lookups, s.comparisons, s.rotations, s.flips,
+          s.move_lefts, s.move_rights, s.allocations);
+}
+
+void test()
+{
+   ttl::rbtree_stats s;
+   {
+      ttl::set<int> e;
+      e.stats(s);
+      assert(s.nodes == 0 && s.height == 0 && s.black_height == 0);
+      assert(s.lookups == 0 && s.allocations == 0);
+   }
+
+   ttl::map<int, int> m;
+   const int N = 1000;
+   for (int i = 0; i < N; ++i)
+      m.insert(ttl::make_pair(i, i)); // sequential keys: many rotations
+   m.stats(s);
+   print("sequential", s);
+   assert(s.nodes == N);
+   assert(s.allocations == N);
+   assert(s.lookups == N);
+   assert(s.rotations > 0 && s.flips > 0);
+   // LLRB: height <= 2*log2(N+1)
+   assert(s.height <= 20);
+   assert(s.black_height >= s.height / 2);
+   {
+      ttl::size_t total = 0;
+      for (unsigned d = 0; d < ttl::rbtree_stats::MAX_DEPTH; ++d)
+         total += s.depth[d];
+      assert(total == N);
+      assert(s.depth[0] == 1);
+      assert(s.depth[s.height - 1] > 0 && s.depth[s.height] == 0);
+   }
+
+   m.reset_stats();
+   m.stats(s);
+   assert(s.lookups == 0 && s.comparisons == 0 && s.rotations == 0);
+   assert(s.nodes == N);
+
+   for (int i = 0; i < N; ++i)
+      assert(m.find(i) != m.end());
+   m.stats(s);
+   print("lookups", s);
+   assert(s.lookups == N);
+   assert(s.comparisons >= N && s.comparisons <= N * 2 * s.height);
+   assert(s.rotations == 0 && s.allocations == 0);
+
+   m.reset_stats();
+   for (int i = 0; i < N; i += 2)
+      assert(m.erase(i) == 1);
+   m.stats(s);
+   print("erase", s);
+   assert(s.nodes == N / 2);
+   assert(s.lookups == N / 2);
+   assert(s.move_lefts + s.move_rights > 0);
+   assert(s.allocations == 0);
+
+   ttl::map<int, int> c(m);
+   c.stats(s);
+   assert(s.allocations == N / 2 && s.nodes == N / 2);
+}
@@ -0,0 +1,239 @@
+// vim: sw=3 ts=8 et
+#include "ttl/utility.hpp"
+#include "ttl/dynamic_bitset.hpp"
+#include "ttl/roaring_bitmap.hpp"
+#include "t.hpp"
+
+template class ttl::roaring_bitmap<>;
+
+typedef ttl::roaring_bitmap<> bitmap;
+// the values of the tests are below 4 chunks, plus a few far ones
+typedef ttl::dynamic_bitset<> plain;
+static const unsigned range = 4 << 16;
+
+struct collect
+{
+   unsigned *v;
+   ttl::size_t n;
+   void operator()(unsigned x) { v[n++] = x; }
+};
+
+// contents, cardinality, iteration and for_each against the reference
+static void check(const bitmap &b, const plain &p)
+{
+   static unsigned v[range];
+   assert(b.cardinality() == p.count() && b.empty() == p.none());
+   collect c = { v, 0 };
+   c = b.for_each(c);
+   assert(c.n == p.count());
+   ttl::size_t n = 0;
+   for (bitmap::const_iterator i = b.begin(); i != b.end(); ++i, ++n)
+      assert(n < c.n && *i == v[n] && p[*i]);
+   assert(n == c.n);
+   for (unsigned i = 0; i < range; i += 1 + rnd(50))
+      assert(b.contains(i) == p[i]);
+}
+
+// round trip through serialize
+static void check_serialized(const bitmap &b)
+{
+   ttl::size_t bytes = b.serialized_bytes();
+   unsigned char *buf = (unsigned char *)malloc(bytes);
+   b.serialize(buf);
+   bitmap d;
+   assert(d.deserialize(buf, bytes));
+   assert(d == b && d.serialized_bytes() == bytes);
+   free(buf);
+}
+
+static void fill(bitmap &b, plain &p, unsigned n, unsigned first, unsigned span)
+{
+   for (unsigned i = 0; i < n; ++i)
+   {
+      const unsigned x = first + rnd(span);
+      assert(b.insert(x) == !p[x]);
+      p.set(x);
+   }
+}
+
+void test()
+{
+   printf("insert, erase, contains against a bitset\n");
+   {
+      bitmap b;
+      plain p(range);
+      check(b, p);
+      // an array chunk, a dense one, one across the 4096 values boundary
+      fill(b, p, 1000, 0, 65536);
+      fill(b, p, 30000, 65536, 65536);
+      fill(b, p, 4096, 2 << 16, 8192);
+      check(b, p);
+      check_serialized(b);
+      for (unsigned i = 0; i < 40000; ++i)
+      {
+         const unsigned x = rnd(range);
+         assert(b.erase(x) == p[x]);
+         p.reset(x);
+      }
+      check(b, p);
+      check_serialized(b);
+      // erasing everything drops the chunks
+      for (unsigned i = 0; i < range; ++i)
+         b.erase(i);
+      assert(b.empty() && b.chunks() == 0 && b.begin() == b.end());
+   }
+
+   printf("runs\n");
+   {
+      bitmap b;
+      plain p(range);
+      for (unsigned i = 1000; i < 60000; ++i)
+      {
+         b.insert(i);
+         p.set(i);
+      }
+      b.insert(70000);
+      p.set(70000);
+      const ttl::size_t before = b.serialized_bytes();
+      b.optimize();
+      // a run and an array of one
+      assert(b.serialized_bytes() == 4 + 8 + 4 + 8 + 2);
+      assert(before > b.serialized_bytes());
+      check(b, p);
+      check_serialized(b);
+      // a run split by an erase and a value inserted between runs
+      assert(b.erase(30000) && !b.erase(30000));
+      p.reset(30000);
+      assert(b.insert(65000));
+      p.set(65000);
+      check(b, p);
+      b.optimize();
+      check(b, p);
+      check_serialized(b);
+   }
+
+   printf("values in far chunks\n");
+   {
+      bitmap b;
+      const unsigned v[] = { 0u, 65535u, 65536u, 0x7fffffffu, 0x80000000u, 0xfffffffeu, 0xffffffffu };
+      for (unsigned i = 0; i < countof(v); ++i)
+         assert(b.insert(v[i]));
+      assert(b.cardinality() == countof(v) && b.chunks() == 5);
+      unsigned n = 0;
+      for (bitmap::const_iterator i = b.begin(); i != b.end(); ++i)
+         assert(*i == v[n++]);
+      assert(n == countof(v) && b.contains(0xffffffffu) && !b.contains(0xfffffffdu));
+      check_serialized(b);
+   }
+
+   printf("set operations\n");
+   {
+      for (unsigned round = 0; round < 6; ++round)
+      {
+         bitmap a, b;
+         plain pa(range), pb(range);
+         // sparse, dense and run chunks, in different mixes each round
+         fill(a, pa, 500 + round * 3000, 0, 2 << 16);
+         fill(b, pb, 20000 - round * 3000, 1 << 16, 3 << 16);
+         for (unsigned i = 3 << 16; i < (3 << 16) + 12000 * round; ++i)
+         {
+            a.insert(i);
+            pa.set(i);
+         }
+         if (round % 2)
+         {
+            a.optimize();
+            b.optimize();
+         }
+
+         bitmap u = a | b, x = a & b, d = a - b;
+         check(u, pa | pb);
+         check(x, pa & pb);
+         check(d, pa & ~pb);
+         check_serialized(u);
+         check_serialized(x);
+         check_serialized(d);
+         assert((b | a) == u && (b & a) == x);
+         assert((u - a) == (b - a));
+
+         bitmap s(a);
+         s |= s;
+         assert(s == a);
+         s &= s;
+         assert(s == a);
+         s -= s;
+         assert(s.empty());
+         s.swap(u);
+         assert(u.empty() && s == (a | b));
+      }
+   }
+
+   printf("representations\n");
+   {
+      bitmap b;
+      // 4096 values are an array, one more a bitset
+      for (unsigned i = 0; i < 4096; ++i)
+         b.insert(i * 16);
+      assert(b.serialized_bytes() == 4 + 8 + 4096 * 2);
+      b.insert(1);
+      assert(b.serialized_bytes() == 4 + 8 + 8192);
+      b.erase(1);
+      assert(b.serialized_bytes() == 4 + 8 + 4096 * 2);
+      // every other value: a bitset after optimize, since the runs are larger
+      for (unsigned i = 0; i < 65536; i += 2)
+         b.insert(i);
+      b.optimize();
+      assert(b.serialized_bytes() == 4 + 8 + 8192);
+      // a full chunk is a single run
+      for (unsigned i = 1; i < 65536; i += 2)
+         b.insert(i);
+      b.optimize();
+      assert(b.cardinality() == 65536 && b.serialized_bytes() == 4 + 8 + 4);
+      bitmap e;
+      e.insert(65535);
+      b &= e;
+      assert(b.cardinality() == 1 && b.contains(65535) && b.serialized_bytes() == 4 + 8 + 2);
+   }
+
+   printf("corrupt buffers\n");
+   {
+      bitmap b;
+      b.insert(5);
+      b.insert(7);
+      b.insert(70000);
+      unsigned char buf[64];
+      const ttl::size_t bytes = b.serialized_bytes();
+      assert(bytes == 4 + 8 + 4 + 8 + 2);
+      b.serialize(buf);
+      bitmap d;
+      assert(d.deserialize(buf, bytes) && d == b);
+      // short, long and empty buffers
+      assert(!d.deserialize(buf, bytes - 1) && d.empty());
+      assert(!d.deserialize(buf, bytes + 1) && d.empty());
+      assert(!d.deserialize(buf, 3) && d.empty());
+      unsigned char c[64];
+      // unsorted values
+      memcpy(c, buf, bytes);
+      c[12] = 9;
+      assert(!d.deserialize(c, bytes) && d.empty());
+      // keys out of order
+      memcpy(c, buf, bytes);
+      c[16] = 0;
+      assert(!d.deserialize(c, bytes) && d.empty());
+      // a bad kind
+      memcpy(c, buf, bytes);
+      c[6] = 3;
+      assert(!d.deserialize(c, bytes) && d.empty());
+      // a run with its first after its last
+      memcpy(c, buf, bytes);
+      c[6] = 2;
+      assert(d.deserialize(c, bytes) && d.cardinality() == 3 + 1);
+      c[12] = 8;
+      assert(!d.deserialize(c, bytes) && d.empty());
+      // an empty set is just the count
+      bitmap e;
+      assert(e.serialized_bytes() == 4);
+      e.serialize(c);
+      assert(d.deserialize(c, 4) && d.empty());
+   }
+}
@@ -199,4 +199,18 @@ void test()
          printf(" {%d}", *it);
       printf("\n");
    }
+   printf("count_range, range\n");
+   {
+      intset sa;
+      for (int i = 0; i < 100; i += 3)
+         sa.insert(i);
+      assert(sa.count_range(0, 100) == 34);
+      assert(sa.count_range(3, 9) == 2);
+      assert(sa.count_range(9, 3) == 0);
+      int n = 0;
+      ttl::iterator_range<intset::const_iterator> r = constify(sa).range(4, 13);
+      for (intset::const_iterator it = r.begin(); it != r.end(); ++it, ++n)
+         assert(*it == 6 + n * 3);
+      assert(n == 3);
+   }
 }
@@ -0,0 +1,104 @@
+// vim: sw=3 ts=8 et
+#include "ttl/utility.hpp"
+#include "ttl/algorithm.hpp"
+#include "ttl/small_vector.hpp"
+#include "t.hpp"
+
+template class ttl::small_vector<testtype, 4>;
+
+static int live;
+
+struct counted
+{
+   int value;
+   counted(int v = 0): value(v) { ++live; }
+   counted(const counted &o): value(o.value) { ++live; }
+   ~counted() { --live; }
+   bool operator==(const counted &o) const { return value == o.value; }
+};
+
+void test()
+{
+   typedef ttl::small_vector<testtype, 4> testvector;
+   static const int numbers[] = {0,1,2,3,4,5,6,7,8,9};
+
+   printf("default ctor:\n");
+   testvector v0;
+   testtype::verbose = false;
+   assert(v0.empty() && v0.is_inline());
+   assert(v0.capacity() == 4 && testvector::inline_capacity() == 4);
+
+   printf("inline storage\n");
+   for (int i = 0; i < 4; ++i)
+      v0.push_back(testtype(i));
+   assert(v0.is_inline() && v0.size() == 4);
+   assert(ttl::equal(v0.cbegin(), v0.cend(), numbers));
+   v0.insert(v0.begin() + 1, testtype(10));
+   print_iter("after spilling v0: ", v0.cbegin(), v0.cend());
+   assert(!v0.is_inline() && v0.size() == 5 && v0.capacity() == 8);
+   assert(v0[0] == 0 && v0[1] == 10 && v0[2] == 1 && v0[4] == 3);
+
+   printf("geometric growth\n");
+   {
+      testvector v;
+      ttl::size_t reallocations = 0;
+      const testtype *data = v.data();
+      for (int i = 0; i < 1000; ++i)
+      {
+         v.push_back(testtype(i));
+         if (v.data() != data)
+            ++reallocations, data = v.data();
+      }
+      printf(" 1000 push_backs, %lu reallocations, capacity %lu\n",
+             (unsigned long)reallocations, (unsigned long)v.capacity());
+      assert(reallocations <= 8);
+      assert(v.size() == 1000 && v[999] == 999);
+   }
+
+   printf("copy, assignment, swap\n");
+   {
+      testvector small(2, testtype(7)), big(numbers, numbers + 10);
+      assert(small.is_inline() && !big.is_inline());
+      testvector c(big);
+      assert(c == big);
+      c = small;
+      assert(c == small && c.size() == 2);
+      small.swap(big);
+      assert(small.size() == 10 && big.size() == 2);
+      assert(ttl::equal(small.cbegin(), small.cend(), numbers));
+      assert(big[1] == 7);
+   }
+
+   printf("erase, resize\n");
+   {
+      testvector v(numbers, numbers + 10);
+      v.erase(v.begin(), v.begin() + 8);
+      assert(v.size() == 2 && v[0] == 8 && v[1] == 9);
+      v.resize(5, testtype(1));
+      assert(v.size() == 5 && v[4] == 1);
+      v.resize(1);
+      assert(v.size() == 1);
+      v.pop_back();
+      assert(v.empty());
+   }
+
+   printf("inline elements aligned beyond a pointer\n");
+   {
+      ttl::small_vector<long double, 3> v;
+      for (int i = 0; i < 3; ++i)
+         v.push_back(i);
+      assert(v.capacity() == 3);
+      assert((ttl::size_t)v.data() % __alignof__(long double) == 0);
+   }
+
+   printf("no leaks\n");
+   {
+      ttl::small_vector<counted, 3> v;
+      for (int i = 0; i < 20; ++i)
+         v.insert(v.begin(), counted(i));
+      assert(live == 20);
+      v.erase(v.begin() + 2, v.end());
+      assert(live == 2);
+   }
+   assert(live == 0);
+}
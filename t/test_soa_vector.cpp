@@ -0,0 +1,102 @@
+// vim: sw=3 ts=8 et
+#include "ttl/algorithm.hpp"
+#include "ttl/soa_vector.hpp"
+#include "t.hpp"
+
+#if __cplusplus >= 201103L // C++11
+namespace
+{
+   struct qty_over
+   {
+      int n;
+      template<class Row> bool operator()(const Row &r) const { return r.template get<1>() > n; }
+   };
+}
+
+void test()
+{
+   typedef ttl::soa_vector<double, int, testtype> records;
+   testtype::verbose = false;
+
+   printf("push_back and columns\n");
+   {
+      records v;
+      assert(v.empty() && v.size() == 0);
+      for (int i = 0; i < 100; ++i)
+         v.push_back(i * 0.5, i % 10, testtype(i));
+      assert(v.size() == 100 && v.capacity() >= 100);
+      assert(v[10].get<0>() == 5.0 && v[10].get<1>() == 0 && v[10].get<2>() == 10);
+      assert(v.back().get<2>() == 99);
+
+      double sum = 0;
+      for (double d: v.column<0>())
+         sum += d;
+      assert(sum == 0.5 * 99 * 100 / 2);
+      assert(v.column<1>().size() == 100);
+      assert(ttl::count(v.data<1>(), v.data<1>() + v.size(), 3) == 10);
+
+      v[3].get<1>() = 42;
+      assert(v.data<1>()[3] == 42);
+      v.pop_back();
+      assert(v.size() == 99 && v.back().get<2>() == 98);
+   }
+
+   printf("zipped iterator with the algorithms\n");
+   {
+      records v;
+      for (int i = 0; i < 50; ++i)
+         v.push_back(i, i % 5, testtype(-i));
+      qty_over q = { 2 };
+      assert(ttl::count_if(v.begin(), v.end(), q) == 20);
+      records::iterator i = ttl::find_if(v.begin(), v.end(), q);
+      assert(i - v.begin() == 3 && (*i).get<2>() == -3);
+      assert(i[5].get<0>() == 8.0);
+      const records &c = v;
+      records::const_iterator ci = c.begin() + 10;
+      assert((*ci).get<0>() == 10.0 && ci - c.begin() == 10);
+      int n = 0;
+      for (auto r: c)
+         n += r.get<1>();
+      assert(n == 10 * (0 + 1 + 2 + 3 + 4));
+   }
+
+   printf("copy, resize, swap\n");
+   {
+      records v;
+      for (int i = 0; i < 20; ++i)
+         v.push_back(i, i, testtype(i));
+      records c(v);
+      assert(c.size() == 20);
+      for (int i = 0; i < 20; ++i)
+         assert(c[i].get<2>() == i && c.data<0>() != v.data<0>());
+      c.resize(5);
+      assert(c.size() == 5 && c.back().get<1>() == 4);
+      c.resize(8);
+      assert(c.size() == 8 && c[7].get<0>() == 0.0);
+      c.swap(v);
+      assert(c.size() == 20 && v.size() == 8);
+      records m(static_cast<records &&>(c));
+      assert(m.size() == 20 && c.empty());
+      v = m;
+      assert(v.size() == 20 && v[19].get<2>() == 19);
+      v.clear();
+      assert(v.empty());
+   }
+
+   printf("push_back of its own fields\n");
+   {
+      records v;
+      v.push_back(1.5, 7, testtype(3));
+      // the growths copy the fields of the old columns
+      for (int i = 1; i < 40; ++i)
+         v.push_back(v[0].get<0>(), v[i - 1].get<1>() + 1, v[0].get<2>());
+      for (int i = 0; i < 40; ++i)
+         assert(v[i].get<0>() == 1.5 && v[i].get<1>() == 7 + i && v[i].get<2>() == 3);
+   }
+}
+#else
+void test()
+{
+   printf("soa_vector needs C++11\n");
+}
+#endif
@@ -40,9 +40,24 @@ void test()
    m1.insert(ttl::make_pair((char)'f', (int)0xf));
    m1.insert(ttl::make_pair((char)255, 255));
    print_map("insert\n", m1);
-   //for (char c = 0; (unsigned)c <= 127u; ++c)
-   //   m1.insert(m1.end(), ttl::make_pair(c, (int)c));
-   //print_map("insert(iterator)\n", m1);
+   for (char c = 0; (unsigned)c <= 127u; ++c)
+      m1.insert(m1.end(), ttl::make_pair(c, (int)c));
+   print_map("insert(iterator)\n", m1);
+   assert(m1.size() == 129 && m1.count('a') == 1 && m1['a'] == 0xa);
+
+   assert(m1.erase('a') == 1 && m1.erase('a') == 0 && m1.count('a') == 0);
+   m1.erase(m1.find('b'));
+   m1.erase(m1.begin(), m1.find('0'));
+   assert(m1.size() == 129 - 2 - ('0' + 1) && m1.begin()->first == '0');
+   print_map("erase\n", m1);
+
+   m2 = m1;
+   assert(m2.size() == m1.size() && m2['z'] == 'z');
+   m2.swap(m);
+   assert(m2.empty() && m.size() == m1.size());
+   ttl::sorted_vector_map<char, int> m3(m.begin(), m.end());
+   assert(m3.size() == m.size() && m3.count('0') == 1);
+
    m1.clear();
    print_map("clear: ", m1);
 }
@@ -2,6 +2,18 @@
 #include "ttl/type_traits.hpp"
 #include "t.hpp"
 
+struct relocatable
+{
+   int *p;
+   relocatable(): p(new int) {}
+   relocatable(const relocatable &o): p(new int(*o.p)) {}
+   ~relocatable() { delete p; }
+};
+namespace ttl
+{
+   template<> struct is_trivially_relocatable<relocatable>: true_type {};
+}
+
 void test()
 {
    printf("int:      is_integral: %d\n", ttl::is_integral<int>::value);
@@ -16,4 +28,14 @@ void test()
    printf("uint: is_signed: %d\n", ttl::is_signed<unsigned int>::value);
    printf("int:  is_unsigned: %d\n", ttl::is_unsigned<int>::value);
    printf("uint: is_unsigned: %d\n", ttl::is_unsigned<unsigned int>::value);
+   printf("int:      is_trivially_copyable: %d\n", ttl::is_trivially_copyable<int>::value);
+   printf("testtype: is_trivially_copyable: %d\n", ttl::is_trivially_copyable<testtype>::value);
+   assert(ttl::is_trivially_copyable<int>::value);
+   assert(ttl::is_trivially_copyable<int *>::value);
+   assert(!ttl::is_trivially_copyable<testtype>::value);
+   assert(ttl::is_trivially_destructible<int>::value);
+   assert(!ttl::is_trivially_destructible<testtype>::value);
+   assert(ttl::is_trivially_relocatable<int>::value);
+   assert(ttl::is_trivially_relocatable<relocatable>::value);
+   assert(!ttl::is_trivially_relocatable<testtype>::value);
 }
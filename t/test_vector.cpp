@@ -6,6 +6,26 @@
 
 template class ttl::vector<testtype>;
 
+struct is_odd
+{
+   bool operator()(int v) const { return v & 1; }
+   bool operator()(const testtype &t) const { return t.value & 1; }
+};
+
+#if __cplusplus >= 201103L
+// counts its copies; moved when the vector grows
+struct movable
+{
+   static int copies;
+   int v;
+   movable(int i): v(i) {}
+   movable(const movable &o): v(o.v) { ++copies; }
+   movable(movable &&o): v(o.v) { o.v = -1; }
+   ~movable() {}
+};
+int movable::copies = 0;
+#endif
+
 void test()
 {
    typedef ttl::vector<testtype> testvector;
@@ -205,6 +225,102 @@ void test()
       assert(v.capacity() > capacity);
    }
 
+   {
+      printf("erase_unordered, erase_if\n");
+      testvector v;
+      v.assign(ascii, ascii + countof(ascii));
+      assert(*v.erase_unordered(v.begin() + 1) == ascii[6]);
+      assert(v.size() == 6 && v[1] == ascii[6] && v[5] == ascii[5]);
+      assert(v.erase_unordered(v.end() - 1) == v.end());
+      assert(v.size() == 5 && v.back() == ascii[4]);
+      v.push_back(testtype('H'));
+      assert(v.erase_if(is_odd()) == 4); // 'A', 'G', 'C', 'D', 'E', 'H'
+      assert(v.size() == 2 && v[0] == 'D' && v[1] == 'H');
+
+      ttl::vector<int> iv;
+      for (int i = 0; i < 10; ++i)
+         iv.push_back(i);
+      assert(iv.erase_if(is_odd()) == 5);
+      for (int i = 0; i < 5; ++i)
+         assert(iv[i] == i * 2);
+      assert(*iv.erase_unordered(iv.begin()) == 8);
+      assert(iv.size() == 4 && iv[0] == 8 && iv[3] == 6);
+      assert(iv.erase_if(is_odd()) == 0 && iv.size() == 4);
+   }
+
+   {
+      printf("resize_uninitialized, append_uninitialized\n");
+      ttl::vector<unsigned> b;
+      b.resize_uninitialized(3);
+      assert(b.size() == 3);
+      unsigned *tail = b.append_uninitialized(5);
+      assert(tail == b.data() + 3 && b.size() == 8);
+      for (unsigned i = 0; i < b.size(); ++i)
+         b[i] = i;
+      ttl::size_t capacity = b.capacity(), reallocations = 0;
+      for (int i = 0; i < 1000; ++i)
+      {
+         *b.append_uninitialized(1) = 8 + i;
+         if (b.capacity() != capacity)
+            ++reallocations, capacity = b.capacity();
+      }
+      assert(reallocations <= 8);
+      for (unsigned i = 0; i < b.size(); ++i)
+         assert(b[i] == i);
+      b.resize_uninitialized(4);
+      assert(b.size() == 4 && b[3] == 3);
+
+      testvector v(2, testtype(5));
+      testtype *t = v.append_uninitialized(2); // non-trivial types are default-constructed
+      assert(t[0] == -1 && t[1] == -1 && v.size() == 4 && v[1] == 5);
+   }
+
+   printf("insert of its own elements\n");
+   {
+      testtype::verbose = false;
+      testvector v;
+      v.reserve(8);
+      for (int i = 0; i < 4; ++i)
+         v.push_back(testtype(i));
+      // in place: the elements from pos move before the new one is copied
+      v.insert(v.begin(), v.back());
+      v.insert(v.begin() + 1, 2, v[3]);
+      assert(v.size() == 7 && v[0] == 3 && v[1] == 2 && v[2] == 2 && v[3] == 0 && v[6] == 3);
+      ttl::vector<unsigned> u;
+      for (unsigned i = 0; i < 100; ++i)
+         u.push_back(u.empty() ? 0: u[i - 1] + 1);
+      u.insert(u.begin(), u[99]);
+      assert(u[0] == 99 && u[1] == 0 && u[100] == 99);
+   }
+
+#if __cplusplus >= 201103L
+   printf("growth moves the elements\n");
+   {
+      ttl::vector<movable> v;
+      for (int i = 0; i < 100; ++i)
+         v.push_back(movable(i));
+      assert(movable::copies == 100); // those of push_back only
+      for (int i = 0; i < 100; ++i)
+         assert(v[i].v == i);
+   }
+#endif
+
+   printf("push_back reallocates O(log N) times\n");
+   {
+      testtype::verbose = false;
+      testvector v;
+      ttl::size_t capacity = 0, reallocations = 0;
+      for (int i = 0; i < 1000; ++i)
+      {
+         v.push_back(testtype(i));
+         if (v.capacity() != capacity)
+            ++reallocations, capacity = v.capacity();
+      }
+      assert(reallocations <= 11);
+      for (int i = 0; i < 1000; ++i)
+         assert(v[i] == i);
+   }
+
    printf("destructors:\n");
    testtype::verbose = true;
 }
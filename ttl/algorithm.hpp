@@ -2,21 +2,24 @@
 //
 // Tiny Template Library: implementation of STL algorithms
 //
+// sort() is an introsort: quicksort on a median of 3 pivot down to ranges
+// of 16 elements, which a final insertion sort puts in order, and heapsort
+// for the ranges whose quicksort goes deeper than 2 log2 n. nth_element()
+// is the same quickselect. stable_sort() is a merge sort with a buffer of
+// half the range; it merges in place, in O(n log2(n)^2), when there is no
+// memory for it. None of them throws.
+//
 // This code is Public Domain
 //
 #ifndef _TINY_TEMPLATE_LIBRARY_ALGORITHM_HPP_
 #define _TINY_TEMPLATE_LIBRARY_ALGORITHM_HPP_
 
+#include <new>
 #include "types.hpp"
 #include "type_traits.hpp"
 
 namespace ttl
 {
-#if __cplusplus >= 201103L // C++11
-#define ttl_constexpr constexpr
-#else
-#define ttl_constexpr
-#endif
    template<class T1, class T2> struct pair;
    template<class T1, class T2> pair<T1,T2> make_pair(T1, T2);
 #if __cplusplus >= 201103L // C++11
@@ -26,6 +29,7 @@ namespace ttl
    template<class T> struct remove_reference;
    template<class T> typename remove_reference<T>::type &move(T &);
 #endif
+   template<typename T> void swap(T &, T &);
 
    //
    // Non-modifying sequence operations
@@ -487,6 +491,35 @@ namespace ttl
          swap(*first, *last);
    }
 
+   template<class ForwardIt>
+   ForwardIt rotate(ForwardIt first, ForwardIt n_first, ForwardIt last)
+   {
+      if (first == n_first)
+         return last;
+      if (n_first == last)
+         return first;
+      // swaps [first, n_first) forward a block at a time; what is left of
+      // it when read reaches last is rotated the same way, in a loop
+      ForwardIt read = n_first;
+      do
+      {
+         iter_swap(first++, read++);
+         if (first == n_first)
+            n_first = read;
+      }
+      while (read != last);
+      const ForwardIt result = first;
+      for (read = n_first; read != last;)
+      {
+         iter_swap(first++, read++);
+         if (first == n_first)
+            n_first = read;
+         else if (read == last)
+            read = n_first;
+      }
+      return result;
+   }
+
    template<class BidirIt, class OutputIt>
    OutputIt reverse_copy(BidirIt first, BidirIt last, OutputIt d_first)
    {
@@ -629,6 +662,374 @@ namespace ttl
       return is_sorted_until(first, last) == last;
    }
 
+   template<class ForwardIt, class Compare>
+   ForwardIt is_sorted_until(ForwardIt first, ForwardIt last, Compare comp)
+   {
+      if (first != last)
+      {
+         ForwardIt next = first;
+         while (++next != last)
+         {
+            if (comp(*next, *first))
+               return next;
+            first = next;
+         }
+      }
+      return last;
+   }
+
+   template<class ForwardIt, class Compare>
+   bool is_sorted(ForwardIt first, ForwardIt last, Compare comp)
+   {
+      return is_sorted_until(first, last, comp) == last;
+   }
+
+   // the comparison of the sorts without one
+   struct sort_less
+   {
+      template<class T>
+      bool operator()(const T &a, const T &b) const { return a < b; }
+   };
+
+   // the ranges left to the insertion sort
+   enum { sort_threshold = 16 };
+
+   // the depth of quicksort before heapsort, 2 log2 n
+   inline int sort_depth(ttl::ptrdiff_t n)
+   {
+      int depth = 0;
+      for (; n > 1; n >>= 1)
+         depth += 2;
+      return depth;
+   }
+
+   // the T * of the helpers is only there to name the value type
+   template<class RandomIt, class Compare, class T>
+   void sort_insertion(RandomIt first, RandomIt last, Compare comp, T *)
+   {
+      if (first == last)
+         return;
+      for (RandomIt i = first + 1; i < last; ++i)
+      {
+         T v = ttl::move(*i);
+         RandomIt j = i;
+         // below the first: no need to look for the bound on the way
+         if (comp(v, *first))
+            for (; j != first; --j)
+               *j = ttl::move(*(j - 1));
+         else
+            for (; comp(v, *(j - 1)); --j)
+               *j = ttl::move(*(j - 1));
+         *j = ttl::move(v);
+      }
+   }
+
+   // puts v in the hole of the heap [first, first + len), moving the
+   // larger children up
+   template<class RandomIt, class Compare, class T>
+   void sort_sift_down(RandomIt first, ttl::ptrdiff_t hole, ttl::ptrdiff_t len, T &v, Compare comp)
+   {
+      for (ttl::ptrdiff_t child; (child = 2 * hole + 1) < len; hole = child)
+      {
+         if (child + 1 < len && comp(first[child], first[child + 1]))
+            ++child;
+         if (!comp(v, first[child]))
+            break;
+         first[hole] = ttl::move(first[child]);
+      }
+      first[hole] = ttl::move(v);
+   }
+
+   template<class RandomIt, class Compare, class T>
+   void sort_make_heap(RandomIt first, RandomIt last, Compare comp, T *)
+   {
+      const ttl::ptrdiff_t len = last - first;
+      for (ttl::ptrdiff_t i = len / 2; i-- > 0;)
+      {
+         T v = ttl::move(first[i]);
+         sort_sift_down(first, i, len, v, comp);
+      }
+   }
+
+   template<class RandomIt, class Compare, class T>
+   void sort_heap_sort(RandomIt first, RandomIt last, Compare comp, T *)
+   {
+      for (ttl::ptrdiff_t len = last - first; len > 1;)
+      {
+         --len;
+         T v = ttl::move(first[len]);
+         first[len] = ttl::move(*first);
+         sort_sift_down(first, 0, len, v, comp);
+      }
+   }
+
+   // the smallest of [first, last) in order in [first, middle)
+   template<class RandomIt, class Compare, class T>
+   void sort_partial(RandomIt first, RandomIt middle, RandomIt last, Compare comp, T *p)
+   {
+      if (first == middle)
+         return;
+      sort_make_heap(first, middle, comp, p);
+      const ttl::ptrdiff_t len = middle - first;
+      for (RandomIt i = middle; i < last; ++i)
+         if (comp(*i, *first))
+         {
+            T v = ttl::move(*i);
+            *i = ttl::move(*first);
+            sort_sift_down(first, 0, len, v, comp);
+         }
+      sort_heap_sort(first, middle, comp, p);
+   }
+
+   // swaps the median of *a, *b and *c into *result
+   template<class RandomIt, class Compare>
+   void sort_median_to_first(RandomIt result, RandomIt a, RandomIt b, RandomIt c, Compare comp)
+   {
+      if (comp(*a, *b))
+      {
+         if (comp(*b, *c))
+            iter_swap(result, b);
+         else if (comp(*a, *c))
+            iter_swap(result, c);
+         else
+            iter_swap(result, a);
+      }
+      else if (comp(*a, *c))
+         iter_swap(result, a);
+      else if (comp(*b, *c))
+         iter_swap(result, c);
+      else
+         iter_swap(result, b);
+   }
+
+   // partitions [first, last) around *pivot, which is before it: there is
+   // an element on each side of the median which stops the scans, and
+   // they stop on the elements equal to the pivot too, so that runs of
+   // them are split in the middle
+   template<class RandomIt, class Compare>
+   RandomIt sort_partition(RandomIt first, RandomIt last, RandomIt pivot, Compare comp)
+   {
+      for (;;)
+      {
+         while (comp(*first, *pivot))
+            ++first;
+         --last;
+         while (comp(*pivot, *last))
+            --last;
+         if (!(first < last))
+            return first;
+         iter_swap(first, last);
+         ++first;
+      }
+   }
+
+   // [first, cut) is not above [cut, last), and cut is neither first nor last
+   template<class RandomIt, class Compare>
+   inline RandomIt sort_pivot(RandomIt first, RandomIt last, Compare comp)
+   {
+      const RandomIt mid = first + (last - first) / 2;
+      sort_median_to_first(first, first + 1, mid, last - 1, comp);
+      return sort_partition(first + 1, last, first, comp);
+   }
+
+   // leaves ranges of sort_threshold elements at most, in order
+   template<class RandomIt, class Compare, class T>
+   void sort_loop(RandomIt first, RandomIt last, int depth, Compare comp, T *p)
+   {
+      while (last - first > sort_threshold)
+      {
+         if (depth-- == 0)
+         {
+            sort_partial(first, last, last, comp, p);
+            return;
+         }
+         const RandomIt cut = sort_pivot(first, last, comp);
+         sort_loop(cut, last, depth, comp, p);
+         last = cut;
+      }
+   }
+
+   template<class RandomIt, class Compare>
+   void sort(RandomIt first, RandomIt last, Compare comp)
+   {
+      if (last - first < 2)
+         return;
+      sort_loop(first, last, sort_depth(last - first), comp, &*first);
+      sort_insertion(first, last, comp, &*first);
+   }
+
+   template<class RandomIt>
+   inline void sort(RandomIt first, RandomIt last)
+   {
+      sort(first, last, sort_less());
+   }
+
+   template<class RandomIt, class Compare>
+   void partial_sort(RandomIt first, RandomIt middle, RandomIt last, Compare comp)
+   {
+      if (first != middle)
+         sort_partial(first, middle, last, comp, &*first);
+   }
+
+   template<class RandomIt>
+   inline void partial_sort(RandomIt first, RandomIt middle, RandomIt last)
+   {
+      partial_sort(first, middle, last, sort_less());
+   }
+
+   template<class RandomIt, class Compare>
+   void nth_element(RandomIt first, RandomIt nth, RandomIt last, Compare comp)
+   {
+      if (nth == last)
+         return;
+      for (int depth = sort_depth(last - first); last - first > sort_threshold;)
+      {
+         if (depth-- == 0)
+         {
+            sort_partial(first, nth + 1, last, comp, &*first);
+            return;
+         }
+         const RandomIt cut = sort_pivot(first, last, comp);
+         if (cut <= nth)
+            first = cut;
+         else
+            last = cut;
+      }
+      sort_insertion(first, last, comp, &*first);
+   }
+
+   template<class RandomIt>
+   inline void nth_element(RandomIt first, RandomIt nth, RandomIt last)
+   {
+      nth_element(first, nth, last, sort_less());
+   }
+
+   // merges [first, middle) and [middle, last) by moving the first into the
+   // raw memory of buf, which is left raw again
+   template<class RandomIt, class Compare, class T>
+   void sort_merge_buffer(RandomIt first, RandomIt middle, RandomIt last, Compare comp, T *buf)
+   {
+      T *b = buf, *end = buf;
+      for (RandomIt i = first; i != middle; ++i, ++end)
+         ::new(static_cast<void *>(end)) T(ttl::move(*i));
+      RandomIt out = first;
+      for (; b != end && middle != last; ++out)
+         if (comp(*middle, *b))
+            *out = ttl::move(*middle++);
+         else
+            *out = ttl::move(*b++);
+      for (; b != end; ++out)
+         *out = ttl::move(*b++);
+      for (b = buf; b != end; ++b)
+         b->~T();
+   }
+
+   // the same when all of [middle, last) goes before [first, middle), as
+   // in reversed input: moves it through buf to the front
+   template<class RandomIt, class T>
+   void sort_swap_runs(RandomIt first, RandomIt middle, RandomIt last, T *buf)
+   {
+      T *b = buf, *end = buf;
+      for (RandomIt i = middle; i != last; ++i, ++end)
+         ::new(static_cast<void *>(end)) T(ttl::move(*i));
+      while (middle != first)
+         *--last = ttl::move(*--middle);
+      for (; b != end; ++b, ++first)
+      {
+         *first = ttl::move(*b);
+         b->~T();
+      }
+   }
+
+   // the same without memory: splits the larger run in two, finds where
+   // its middle goes in the other, rotates and merges both sides
+   template<class RandomIt, class Compare>
+   void sort_merge_inplace(RandomIt first, RandomIt middle, RandomIt last,
+                           ttl::ptrdiff_t len1, ttl::ptrdiff_t len2, Compare comp)
+   {
+      if (len1 == 0 || len2 == 0)
+         return;
+      if (len1 + len2 == 2)
+      {
+         if (comp(*middle, *first))
+            iter_swap(first, middle);
+         return;
+      }
+      RandomIt cut1, cut2;
+      if (len1 > len2)
+      {
+         cut1 = first + len1 / 2;
+         cut2 = lower_bound(middle, last, *cut1, comp);
+      }
+      else
+      {
+         cut2 = middle + len2 / 2;
+         cut1 = upper_bound(first, middle, *cut2, comp);
+      }
+      const RandomIt m = rotate(cut1, middle, cut2);
+      const ttl::ptrdiff_t d1 = cut1 - first, d2 = cut2 - middle;
+      sort_merge_inplace(first, cut1, m, d1, d2, comp);
+      sort_merge_inplace(m, cut2, last, len1 - d1, len2 - d2, comp);
+   }
+
+   // the sizes below which stable_sort() is an insertion sort
+   enum { stable_sort_threshold = 32 };
+
+   // buf is raw memory for half of [first, last), rounded up, or null
+   template<class RandomIt, class Compare, class T>
+   void sort_stable(RandomIt first, RandomIt last, Compare comp, T *buf)
+   {
+      if (last - first <= stable_sort_threshold)
+      {
+         sort_insertion(first, last, comp, buf);
+         return;
+      }
+      const RandomIt middle = first + (last - first) / 2;
+      sort_stable(first, middle, comp, buf);
+      sort_stable(middle, last, comp, buf);
+      // already in order, as the runs of sorted input are
+      if (!comp(*middle, *(middle - 1)))
+         return;
+      if (buf && comp(*(last - 1), *first))
+         sort_swap_runs(first, middle, last, buf);
+      else if (buf)
+         sort_merge_buffer(first, middle, last, comp, buf);
+      else
+         sort_merge_inplace(first, middle, last, middle - first, last - middle, comp);
+   }
+
+   template<class RandomIt, class Compare, class T>
+   void sort_stable_alloc(RandomIt first, RandomIt last, Compare comp, T *)
+   {
+      const ttl::size_t n = (last - first + 1) / 2;
+      T *buf = static_cast<T *>(::operator new(n * sizeof(T), std::nothrow));
+      sort_stable(first, last, comp, buf);
+      ::operator delete(buf, std::nothrow);
+   }
+
+   template<class RandomIt, class Compare>
+   void stable_sort(RandomIt first, RandomIt last, Compare comp)
+   {
+      if (last - first <= stable_sort_threshold)
+         sort_insertion(first, last, comp, first == last ? 0: &*first);
+      else
+         sort_stable_alloc(first, last, comp, &*first);
+   }
+
+   template<class RandomIt>
+   inline void stable_sort(RandomIt first, RandomIt last)
+   {
+      stable_sort(first, last, sort_less());
+   }
+
+   // with the caller's raw memory for (last - first + 1) / 2 elements, or
+   // in place when buffer is null
+   template<class RandomIt, class Compare, class T>
+   void stable_sort(RandomIt first, RandomIt last, Compare comp, T *buffer)
+   {
+      sort_stable(first, last, comp, buffer);
+   }
+
    //
    // Set operations on sorted ranges
    //
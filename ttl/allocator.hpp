@@ -0,0 +1,80 @@
+/////////////////////////////////////////////////// vim: sw=3 ts=8 et
+//
+// Tiny Template Library: storage allocators
+//
+// An allocator of the containers deals in untyped bytes:
+//
+//    void *allocate(size_t bytes);
+//    void deallocate(void *p, size_t bytes);  // bytes as allocated, p may be 0
+//    void *reallocate(void *p, size_t bytes, size_t new_bytes);
+//
+// reallocate moves the memory block (as memcpy would), returning 0 if it
+// cannot, in which case the block is left untouched. The containers use
+// it only for the trivially relocatable elements.
+//
+// The containers inherit the allocator, so a stateless one takes no space.
+// The ones with state (an arena, a pool) are shared with allocator_ref.
+//
+// This code is Public Domain
+//
+#ifndef _TINY_TEMPLATE_LIBRARY_ALLOCATOR_HPP_
+#define _TINY_TEMPLATE_LIBRARY_ALLOCATOR_HPP_ 1
+
+#include <new>
+#include "types.hpp"
+#include "type_traits.hpp"
+
+namespace ttl
+{
+   // The global operator new and delete
+   struct allocator
+   {
+      void *allocate(ttl::size_t bytes) { return ::operator new(bytes); }
+      void deallocate(void *p, ttl::size_t) { ::operator delete(p); }
+      void *reallocate(void *, ttl::size_t, ttl::size_t) { return 0; }
+   };
+
+   // A reference to an allocator: the containers constructed with it, and
+   // their copies, all allocate from the same Resource, which must outlive
+   // them. It cannot be default constructed.
+   template<class Resource>
+   class allocator_ref
+   {
+   public:
+      explicit allocator_ref(Resource &r): resource_(&r) {}
+
+      void *allocate(ttl::size_t bytes) { return resource_->allocate(bytes); }
+      void deallocate(void *p, ttl::size_t bytes) { resource_->deallocate(p, bytes); }
+      void *reallocate(void *p, ttl::size_t bytes, ttl::size_t new_bytes)
+      {
+         return resource_->reallocate(p, bytes, new_bytes);
+      }
+
+      Resource &resource() const { return *resource_; }
+      bool operator==(const allocator_ref &o) const { return resource_ == o.resource_; }
+      bool operator!=(const allocator_ref &o) const { return resource_ != o.resource_; }
+
+   private:
+      Resource *resource_;
+   };
+
+   // is_monotonic_allocator<A>::value == true if A::deallocate does nothing
+   // (an arena): the containers then skip the walks which would only free
+   // the nodes of trivially destructible elements.
+   template<class Allocator> struct is_monotonic_allocator: false_type {};
+   template<class Resource> struct is_monotonic_allocator<allocator_ref<Resource> >:
+      is_monotonic_allocator<Resource> {};
+
+   // allocators_equal(a, b) == true if what a allocates can be freed by b,
+   // as the nodes which splice moves between containers are: allocator_ref
+   // compares the resources, the others are taken as without state.
+   template<class Allocator>
+   inline bool allocators_equal(const Allocator &, const Allocator &) { return true; }
+   template<class Resource>
+   inline bool allocators_equal(const allocator_ref<Resource> &a, const allocator_ref<Resource> &b)
+   {
+      return a == b;
+   }
+}
+
+#endif // _TINY_TEMPLATE_LIBRARY_ALLOCATOR_HPP_
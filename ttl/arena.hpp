@@ -0,0 +1,218 @@
+/////////////////////////////////////////////////// vim: sw=3 ts=8 et
+//
+// Tiny Template Library: arena and pool allocators
+//
+// arena is monotonic: it hands out the memory of its blocks in order, and
+// frees nothing until reset (or its destruction), which frees everything at
+// once. The blocks double in size, and the first memory can be a buffer of
+// the caller, so a small arena on the stack does not allocate at all. The
+// trees and lists built on an arena do not walk their nodes to free them,
+// unless the elements have destructors. pool keeps the freed blocks of one
+// size for reuse.
+//
+// Both are noncopyable, and given to the containers with allocator_ref:
+//
+//    ttl::arena a;
+//    typedef ttl::allocator_ref<ttl::arena> arena_ref;
+//    ttl::list<int, arena_ref> l((arena_ref(a)));
+//
+// The containers must be gone before the arena is reset.
+//
+// This code is Public Domain
+//
+#ifndef _TINY_TEMPLATE_LIBRARY_ARENA_HPP_
+#define _TINY_TEMPLATE_LIBRARY_ARENA_HPP_ 1
+
+#include <new>
+#include "types.hpp"
+#include "allocator.hpp"
+
+namespace ttl
+{
+   // the alignment of the arena and pool allocations
+   inline ttl::size_t arena_align(ttl::size_t bytes)
+   {
+      const ttl::size_t a = 2 * sizeof(void *);
+      return (bytes + a - 1) & ~(a - 1);
+   }
+
+   class arena
+   {
+   public:
+      explicit arena(ttl::size_t block_size = 4096):
+         blocks_(0), ptr_(0), end_(0), buffer_(0), buffer_end_(0),
+         block_size_(block_size), next_size_(block_size) {}
+      // the memory of the buffer (on the stack, say) is used up first
+      arena(void *buffer, ttl::size_t bytes, ttl::size_t block_size = 4096):
+         blocks_(0), block_size_(block_size), next_size_(block_size)
+      {
+         char *b = static_cast<char *>(buffer);
+         buffer_ = b + (arena_align(ttl::size_t(b)) - ttl::size_t(b));
+         buffer_end_ = b + bytes < buffer_ ? buffer_: b + bytes;
+         ptr_ = buffer_;
+         end_ = buffer_end_;
+      }
+      ~arena() { reset(); }
+
+      void *allocate(ttl::size_t bytes)
+      {
+         bytes = arena_align(bytes);
+         if (ttl::size_t(end_ - ptr_) < bytes)
+            return allocate_block(bytes);
+         char *p = ptr_;
+         ptr_ += bytes;
+         return p;
+      }
+      // the memory is reclaimed by reset only
+      void deallocate(void *, ttl::size_t) {}
+      // the last allocation grows in place, when the block has room
+      void *reallocate(void *p, ttl::size_t bytes, ttl::size_t new_bytes)
+      {
+         char *c = static_cast<char *>(p);
+         if (!c || c + arena_align(bytes) != ptr_ || ttl::size_t(end_ - c) < arena_align(new_bytes))
+            return 0;
+         ptr_ = c + arena_align(new_bytes);
+         return p;
+      }
+
+      // frees all the blocks at once and starts over in the buffer
+      void reset()
+      {
+         while (blocks_)
+         {
+            block *b = blocks_;
+            blocks_ = b->next;
+            ::operator delete(b);
+         }
+         ptr_ = buffer_;
+         end_ = buffer_end_;
+         next_size_ = block_size_;
+      }
+
+      // the number of blocks from the heap
+      ttl::size_t blocks() const
+      {
+         ttl::size_t n = 0;
+         for (const block *b = blocks_; b; b = b->next)
+            ++n;
+         return n;
+      }
+
+   private:
+      struct block { block *next; };
+      block *blocks_; // the current block first
+      char *ptr_, *end_;
+      char *buffer_, *buffer_end_;
+      ttl::size_t block_size_, next_size_;
+
+      arena(const arena &);
+      arena &operator=(const arena &);
+
+      // The blocks double in size up to a megabyte (or the first size)
+      void *allocate_block(ttl::size_t bytes)
+      {
+         ttl::size_t size = bytes > next_size_ ? bytes: next_size_;
+         block *b = static_cast<block *>(::operator new(arena_align(sizeof(block)) + size));
+         char *p = reinterpret_cast<char *>(b) + arena_align(sizeof(block));
+         if (size > next_size_ && blocks_)
+         {
+            // a block of its own, behind the current one, which stays in use
+            b->next = blocks_->next;
+            blocks_->next = b;
+            return p;
+         }
+         b->next = blocks_;
+         blocks_ = b;
+         ptr_ = p + bytes;
+         end_ = p + size;
+         if (next_size_ < 1024 * 1024)
+            next_size_ *= 2;
+         return p;
+      }
+   };
+
+   template<> struct is_monotonic_allocator<arena>: true_type {};
+
+   // The blocks of the pool are of the size given to the constructor, or
+   // else of the size of the first allocation: the nodes of a list or a
+   // tree. The allocations of the other sizes go to the global operator new.
+   // The memory comes from the heap in chunks of per_chunk blocks.
+   class pool
+   {
+   public:
+      explicit pool(ttl::size_t size = 0, ttl::size_t per_chunk = 64):
+         size_(size), per_chunk_(per_chunk), free_(0), chunks_(0) {}
+      ~pool() { release(); }
+
+      void *allocate(ttl::size_t bytes)
+      {
+         if (!size_)
+            size_ = bytes;
+         if (bytes != size_)
+            return ::operator new(bytes);
+         if (!free_)
+            refill();
+         void *p = free_;
+         free_ = *static_cast<void **>(p);
+         return p;
+      }
+      void deallocate(void *p, ttl::size_t bytes)
+      {
+         if (bytes != size_)
+         {
+            ::operator delete(p);
+            return;
+         }
+         *static_cast<void **>(p) = free_;
+         free_ = p;
+      }
+      void *reallocate(void *, ttl::size_t, ttl::size_t) { return 0; }
+
+      // frees the chunks, all of their blocks must be free
+      void release()
+      {
+         while (chunks_)
+         {
+            chunk *c = chunks_;
+            chunks_ = c->next;
+            ::operator delete(c);
+         }
+         free_ = 0;
+      }
+
+      ttl::size_t size() const { return size_; }
+      ttl::size_t free_blocks() const
+      {
+         ttl::size_t n = 0;
+         for (void *p = free_; p; p = *static_cast<void **>(p))
+            ++n;
+         return n;
+      }
+
+   private:
+      struct chunk { chunk *next; };
+      ttl::size_t size_, per_chunk_;
+      void *free_;
+      chunk *chunks_;
+
+      pool(const pool &);
+      pool &operator=(const pool &);
+
+      void refill()
+      {
+         ttl::size_t slot = arena_align(size_ < sizeof(void *) ? sizeof(void *): size_);
+         chunk *c = static_cast<chunk *>(::operator new(arena_align(sizeof(chunk)) + per_chunk_ * slot));
+         c->next = chunks_;
+         chunks_ = c;
+         char *p = reinterpret_cast<char *>(c) + arena_align(sizeof(chunk)) + per_chunk_ * slot;
+         for (ttl::size_t i = 0; i < per_chunk_; ++i)
+         {
+            p -= slot;
+            *reinterpret_cast<void **>(p) = free_;
+            free_ = p;
+         }
+      }
+   };
+}
+
+#endif // _TINY_TEMPLATE_LIBRARY_ARENA_HPP_
@@ -0,0 +1,129 @@
+/////////////////////////////////////////////////// vim: sw=3 ts=8 et
+//
+// Tiny Template Library: a bitset of atomic words, for slots and IDs
+// taken and released by several threads without a lock
+//
+// test_and_set() and test_and_reset() are a single atomic or, and;
+// acquire_first_clear() sets the first clear bit with a compare and swap
+// loop on its word, retrying in the word if another thread got there
+// first. Each thread starts its search at a hint of its own, such as the
+// last ID it took, so that threads mostly work on words of their own
+// instead of all contending for the first words.
+//
+//    static ttl::atomic_bitset<4096> ids;
+//    ttl::size_t hint = thread_index * 4096 / threads;
+//    ...
+//    ttl::size_t id = ids.acquire_first_clear(hint); // size() when all are taken
+//    hint = id;
+//    ...
+//    ids.test_and_reset(id);
+//
+// The read-modify-write operations are acquire and release: the data of
+// the slot written before a release is seen after the acquire. count()
+// is a relaxed snapshot, exact only when no thread is changing the bits.
+// It needs the __atomic builtins of gcc and clang.
+//
+// This code is Public Domain
+//
+#ifndef _TINY_TEMPLATE_LIBRARY_ATOMIC_BITSET_HPP_
+#define _TINY_TEMPLATE_LIBRARY_ATOMIC_BITSET_HPP_ 1
+
+#include <limits.h>
+#include "types.hpp"
+#include "bits.hpp"
+
+namespace ttl
+{
+   template<ttl::size_t N>
+   class atomic_bitset
+   {
+   public:
+      typedef unsigned long slot_type;
+
+   private:
+      enum { BPW = sizeof(slot_type) * CHAR_BIT, slots = (N + BPW - 1) / BPW };
+
+      slot_type bits_[slots];
+
+      static slot_type full(ttl::size_t s)
+      {
+         return s == slots - 1 && N % BPW ? (1ul << N % BPW) - 1: (slot_type)-1;
+      }
+      static slot_type mask(ttl::size_t pos) { return 1ul << pos % BPW; }
+
+      atomic_bitset(const atomic_bitset &); /* none */
+      atomic_bitset &operator=(const atomic_bitset &); /* none */
+
+   public:
+      atomic_bitset() { reset(); }
+
+      ttl::size_t size() const { return N; }
+
+      bool test(ttl::size_t pos) const
+      {
+         return __atomic_load_n(&bits_[pos / BPW], __ATOMIC_ACQUIRE) & mask(pos);
+      }
+      bool operator[](ttl::size_t pos) const { return test(pos); }
+
+      // the bit as it was before
+      bool test_and_set(ttl::size_t pos)
+      {
+         return __atomic_fetch_or(&bits_[pos / BPW], mask(pos), __ATOMIC_ACQ_REL) & mask(pos);
+      }
+      bool test_and_reset(ttl::size_t pos)
+      {
+         return __atomic_fetch_and(&bits_[pos / BPW], ~mask(pos), __ATOMIC_ACQ_REL) & mask(pos);
+      }
+      void set(ttl::size_t pos) { __atomic_fetch_or(&bits_[pos / BPW], mask(pos), __ATOMIC_RELEASE); }
+      void reset(ttl::size_t pos) { __atomic_fetch_and(&bits_[pos / BPW], ~mask(pos), __ATOMIC_RELEASE); }
+
+      // sets the first clear bit from the word of hint on, going round to
+      // the first word, and returns it; size() when all are set
+      ttl::size_t acquire_first_clear(ttl::size_t hint = 0);
+
+      // the bits set, relaxed
+      ttl::size_t count() const
+      {
+         ttl::size_t n = 0;
+         for (ttl::size_t s = 0; s < slots; ++s)
+            n += bits_popcount(__atomic_load_n(&bits_[s], __ATOMIC_RELAXED));
+         return n;
+      }
+      bool any() const { return count() != 0; }
+      bool none() const { return count() == 0; }
+      bool all() const { return count() == N; }
+
+      // clears all the bits, not to be run along with the other threads
+      void reset()
+      {
+         for (ttl::size_t s = 0; s < slots; ++s)
+            __atomic_store_n(&bits_[s], 0, __ATOMIC_RELAXED);
+         __atomic_thread_fence(__ATOMIC_RELEASE);
+      }
+   };
+
+   template<ttl::size_t N>
+   ttl::size_t atomic_bitset<N>::acquire_first_clear(ttl::size_t hint)
+   {
+      const ttl::size_t first = hint < N ? hint / BPW: 0;
+      ttl::size_t s = first;
+      do
+      {
+         slot_type w = __atomic_load_n(&bits_[s], __ATOMIC_RELAXED);
+         // a failed exchange loads the word again
+         while (slot_type clear = ~w & full(s))
+         {
+            const unsigned b = bits_lowest(clear);
+            if (__atomic_compare_exchange_n(&bits_[s], &w, w | 1ul << b, true,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+               return s * BPW + b;
+         }
+         if (++s == slots)
+            s = 0;
+      }
+      while (s != first);
+      return N;
+   }
+}
+
+#endif // _TINY_TEMPLATE_LIBRARY_ATOMIC_BITSET_HPP_
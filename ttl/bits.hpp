@@ -0,0 +1,280 @@
+/////////////////////////////////////////////////// vim: sw=3 ts=8 et
+//
+// Tiny Template Library: operations on arrays of words of bits, shared by
+// bitset and dynamic_bitset
+//
+// The bit i of an array is the bit i % W of the word i / W, W being the
+// number of bits of a word.
+//
+// This code is Public Domain
+//
+#ifndef _TINY_TEMPLATE_LIBRARY_BITS_HPP_
+#define _TINY_TEMPLATE_LIBRARY_BITS_HPP_ 1
+
+#include <limits.h>
+#include "types.hpp"
+#include "bits_simd.hpp"
+
+namespace ttl
+{
+   // the number of set bits of a word
+   template<typename W>
+   inline unsigned bits_popcount(W w)
+   {
+#ifdef __GNUC__
+      return sizeof(W) <= sizeof(unsigned) ? __builtin_popcount(w):
+         sizeof(W) <= sizeof(unsigned long) ? __builtin_popcountl(w): __builtin_popcountll(w);
+#else
+      unsigned c = 0;
+      for (; w; w &= w - 1)
+         ++c;
+      return c;
+#endif
+   }
+
+   // the index of the lowest set bit of a non-zero word
+   template<typename W>
+   inline unsigned bits_lowest(W w)
+   {
+#ifdef __GNUC__
+      return sizeof(W) <= sizeof(unsigned) ? __builtin_ctz(w):
+         sizeof(W) <= sizeof(unsigned long) ? __builtin_ctzl(w): __builtin_ctzll(w);
+#else
+      unsigned c = 0;
+      for (; !(w & 1); w >>= 1)
+         ++c;
+      return c;
+#endif
+   }
+
+   // the index of the highest set bit of a non-zero word
+   template<typename W>
+   inline unsigned bits_highest(W w)
+   {
+#ifdef __GNUC__
+      return sizeof(W) <= sizeof(unsigned) ? sizeof(unsigned) * CHAR_BIT - 1 - __builtin_clz(w):
+         sizeof(W) <= sizeof(unsigned long) ? sizeof(unsigned long) * CHAR_BIT - 1 - __builtin_clzl(w):
+         sizeof(unsigned long long) * CHAR_BIT - 1 - __builtin_clzll(w);
+#else
+      unsigned c = 0;
+      while (w >>= 1)
+         ++c;
+      return c;
+#endif
+   }
+
+   // The operations on n words below use the SIMD kernels of bits_simd.hpp
+   // where they can, and finish word by word.
+
+   template<typename W>
+   inline ttl::size_t bits_count(const W *w, ttl::size_t n)
+   {
+      ttl::size_t c = 0, i = 0;
+#ifdef TTL_BITS_SIMD
+      i = bits_simd_count(w, n * sizeof(W), c) / sizeof(W);
+#endif
+      for (; i < n; ++i)
+         c += bits_popcount(w[i]);
+      return c;
+   }
+
+   // the number of bits set in both a and b
+   template<typename W>
+   inline ttl::size_t bits_count_and(const W *a, const W *b, ttl::size_t n)
+   {
+      ttl::size_t c = 0, i = 0;
+#ifdef TTL_BITS_SIMD
+      i = bits_simd_count_and(a, b, n * sizeof(W), c) / sizeof(W);
+#endif
+      for (; i < n; ++i)
+         c += bits_popcount((W)(a[i] & b[i]));
+      return c;
+   }
+
+   // true if a bit is set in both a and b
+   template<typename W>
+   inline bool bits_intersects(const W *a, const W *b, ttl::size_t n)
+   {
+      bool found = false;
+      ttl::size_t i = 0;
+#ifdef TTL_BITS_SIMD
+      i = bits_simd_intersects(a, b, n * sizeof(W), found) / sizeof(W);
+#endif
+      for (; !found && i < n; ++i)
+         found = (a[i] & b[i]) != 0;
+      return found;
+   }
+
+   template<typename W>
+   inline bool bits_equal(const W *a, const W *b, ttl::size_t n)
+   {
+      bool equal = true;
+      ttl::size_t i = 0;
+#ifdef TTL_BITS_SIMD
+      i = bits_simd_equal(a, b, n * sizeof(W), equal) / sizeof(W);
+#endif
+      for (; equal && i < n; ++i)
+         equal = a[i] == b[i];
+      return equal;
+   }
+
+   template<typename W>
+   inline void bits_and(W *d, const W *s, ttl::size_t n)
+   {
+      ttl::size_t i = 0;
+#ifdef TTL_BITS_SIMD
+      i = bits_simd_and(d, s, n * sizeof(W)) / sizeof(W);
+#endif
+      for (; i < n; ++i)
+         d[i] &= s[i];
+   }
+
+   template<typename W>
+   inline void bits_or(W *d, const W *s, ttl::size_t n)
+   {
+      ttl::size_t i = 0;
+#ifdef TTL_BITS_SIMD
+      i = bits_simd_or(d, s, n * sizeof(W)) / sizeof(W);
+#endif
+      for (; i < n; ++i)
+         d[i] |= s[i];
+   }
+
+   template<typename W>
+   inline void bits_xor(W *d, const W *s, ttl::size_t n)
+   {
+      ttl::size_t i = 0;
+#ifdef TTL_BITS_SIMD
+      i = bits_simd_xor(d, s, n * sizeof(W)) / sizeof(W);
+#endif
+      for (; i < n; ++i)
+         d[i] ^= s[i];
+   }
+
+   // d = ~s, d may be s
+   template<typename W>
+   inline void bits_not(W *d, const W *s, ttl::size_t n)
+   {
+      ttl::size_t i = 0;
+#ifdef TTL_BITS_SIMD
+      i = bits_simd_not(d, s, n * sizeof(W)) / sizeof(W);
+#endif
+      for (; i < n; ++i)
+         d[i] = (W)~s[i];
+   }
+
+   // The scans below take the number of bits, not of words, and ignore the
+   // bits past it in the last word.
+
+   // the first set bit at or after pos, bits if there is none
+   template<typename W>
+   ttl::size_t bits_find_next(const W *w, ttl::size_t bits, ttl::size_t pos)
+   {
+      const ttl::size_t BPW = sizeof(W) * CHAR_BIT;
+      if (pos >= bits)
+         return bits;
+      ttl::size_t i = pos / BPW;
+      const ttl::size_t n = (bits + BPW - 1) / BPW;
+      W x = w[i] & (W)((W)-1 << pos % BPW);
+      while (!x)
+      {
+         if (++i == n)
+            return bits;
+         x = w[i];
+      }
+      pos = i * BPW + bits_lowest(x);
+      return pos < bits ? pos: bits;
+   }
+
+   // the last set bit, bits if there is none
+   template<typename W>
+   ttl::size_t bits_find_last(const W *w, ttl::size_t bits)
+   {
+      const ttl::size_t BPW = sizeof(W) * CHAR_BIT;
+      if (!bits)
+         return bits;
+      ttl::size_t i = (bits - 1) / BPW;
+      W x = w[i];
+      if (bits % BPW)
+         x &= (W)(((W)1 << bits % BPW) - 1);
+      for (;;)
+      {
+         if (x)
+            return i * BPW + bits_highest(x);
+         if (!i--)
+            return bits;
+         x = w[i];
+      }
+   }
+
+   // calls f(pos) for each set bit, in order
+   template<typename W, class UnaryFunction>
+   UnaryFunction bits_for_each(const W *w, ttl::size_t bits, UnaryFunction f)
+   {
+      const ttl::size_t BPW = sizeof(W) * CHAR_BIT;
+      for (ttl::size_t i = 0, n = (bits + BPW - 1) / BPW; i < n; ++i)
+      {
+         W x = w[i];
+         if (i == n - 1 && bits % BPW)
+            x &= (W)(((W)1 << bits % BPW) - 1);
+         for (; x; x &= x - 1)
+            f(i * BPW + bits_lowest(x));
+      }
+      return f;
+   }
+
+   // Shifts the n words by pos bits towards the higher bits, with the carry
+   // between the words; the vacated bits become zero, the bits shifted out
+   // of the last word are lost.
+   template<typename W>
+   void bits_shift_up(W *w, ttl::size_t n, ttl::size_t pos)
+   {
+      const ttl::size_t BPW = sizeof(W) * CHAR_BIT;
+      const ttl::size_t ws = pos / BPW, bs = pos % BPW;
+      ttl::size_t i;
+      if (ws >= n)
+      {
+         for (i = 0; i < n; ++i)
+            w[i] = 0;
+         return;
+      }
+      if (!bs)
+         for (i = n; i-- > ws;)
+            w[i] = w[i - ws];
+      else
+      {
+         for (i = n - 1; i > ws; --i)
+            w[i] = (W)(w[i - ws] << bs) | (W)(w[i - ws - 1] >> (BPW - bs));
+         w[ws] = (W)(w[0] << bs);
+      }
+      for (i = 0; i < ws; ++i)
+         w[i] = 0;
+   }
+
+   // Shifts the n words by pos bits towards the lower bits; the vacated
+   // bits become zero, so the bits past the end of the set must be zero.
+   template<typename W>
+   void bits_shift_down(W *w, ttl::size_t n, ttl::size_t pos)
+   {
+      const ttl::size_t BPW = sizeof(W) * CHAR_BIT;
+      const ttl::size_t ws = pos / BPW, bs = pos % BPW;
+      ttl::size_t i = 0;
+      if (ws < n)
+      {
+         if (!bs)
+            for (; i + ws < n; ++i)
+               w[i] = w[i + ws];
+         else
+         {
+            for (; i + ws + 1 < n; ++i)
+               w[i] = (W)(w[i + ws] >> bs) | (W)(w[i + ws + 1] << (BPW - bs));
+            w[i] = (W)(w[n - 1] >> bs);
+            ++i;
+         }
+      }
+      for (; i < n; ++i)
+         w[i] = 0;
+   }
+}
+
+#endif // _TINY_TEMPLATE_LIBRARY_BITS_HPP_
@@ -0,0 +1,287 @@
+/////////////////////////////////////////////////// vim: sw=3 ts=8 et
+//
+// Tiny Template Library: SSE2 and AVX2 kernels of the word operations of
+// bits.hpp, on x86 with GCC or clang
+//
+// The kernels work on whole blocks of 16 (SSE2) or 32 (AVX2) bytes. The
+// bits_simd_* entry points take a length in bytes and return the number
+// of bytes they did, for the caller to finish the tail word by word; they
+// do nothing for short arrays, where the setup costs more than it saves.
+//
+// SSE2 is part of x86-64, so it is chosen at compile time. AVX2 is chosen
+// at run time if the CPU has it, unless the code is compiled for AVX2
+// anyway. TTL_BITS_NO_AVX2 leaves out the AVX2 kernels, TTL_BITS_NO_SIMD
+// all of them.
+//
+// This code is Public Domain
+//
+#ifndef _TINY_TEMPLATE_LIBRARY_BITS_SIMD_HPP_
+#define _TINY_TEMPLATE_LIBRARY_BITS_SIMD_HPP_ 1
+
+#include "types.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__) && !defined(TTL_BITS_NO_SIMD)
+#define TTL_BITS_SIMD 1
+#ifndef TTL_BITS_NO_AVX2
+#define TTL_BITS_AVX2 1
+#endif
+#endif
+
+#ifdef TTL_BITS_SIMD
+#include <immintrin.h>
+
+namespace ttl
+{
+   // the arrays shorter than this are left to the word loops
+   static const ttl::size_t bits_simd_min_bytes = 64;
+
+   //
+   // SSE2
+   //
+   inline void bits_sse2_and(void *d, const void *s, ttl::size_t blocks)
+   {
+      __m128i *o = static_cast<__m128i *>(d);
+      const __m128i *i = static_cast<const __m128i *>(s);
+      for (; blocks--; ++o, ++i)
+         _mm_storeu_si128(o, _mm_and_si128(_mm_loadu_si128(o), _mm_loadu_si128(i)));
+   }
+   inline void bits_sse2_or(void *d, const void *s, ttl::size_t blocks)
+   {
+      __m128i *o = static_cast<__m128i *>(d);
+      const __m128i *i = static_cast<const __m128i *>(s);
+      for (; blocks--; ++o, ++i)
+         _mm_storeu_si128(o, _mm_or_si128(_mm_loadu_si128(o), _mm_loadu_si128(i)));
+   }
+   inline void bits_sse2_xor(void *d, const void *s, ttl::size_t blocks)
+   {
+      __m128i *o = static_cast<__m128i *>(d);
+      const __m128i *i = static_cast<const __m128i *>(s);
+      for (; blocks--; ++o, ++i)
+         _mm_storeu_si128(o, _mm_xor_si128(_mm_loadu_si128(o), _mm_loadu_si128(i)));
+   }
+   inline void bits_sse2_not(void *d, const void *s, ttl::size_t blocks)
+   {
+      __m128i *o = static_cast<__m128i *>(d);
+      const __m128i *i = static_cast<const __m128i *>(s);
+      const __m128i ones = _mm_set1_epi32(-1);
+      for (; blocks--; ++o, ++i)
+         _mm_storeu_si128(o, _mm_xor_si128(_mm_loadu_si128(i), ones));
+   }
+   inline bool bits_sse2_zero(__m128i v)
+   {
+      return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) == 0xffff;
+   }
+   inline bool bits_sse2_equal(const void *a, const void *b, ttl::size_t blocks)
+   {
+      const __m128i *i = static_cast<const __m128i *>(a), *j = static_cast<const __m128i *>(b);
+      for (; blocks--; ++i, ++j)
+         if (!bits_sse2_zero(_mm_xor_si128(_mm_loadu_si128(i), _mm_loadu_si128(j))))
+            return false;
+      return true;
+   }
+   inline bool bits_sse2_intersects(const void *a, const void *b, ttl::size_t blocks)
+   {
+      const __m128i *i = static_cast<const __m128i *>(a), *j = static_cast<const __m128i *>(b);
+      for (; blocks--; ++i, ++j)
+         if (!bits_sse2_zero(_mm_and_si128(_mm_loadu_si128(i), _mm_loadu_si128(j))))
+            return true;
+      return false;
+   }
+   // the bit counts of the bytes, summed into two 64 bit lanes
+   inline __m128i bits_sse2_popcount(__m128i v)
+   {
+      const __m128i m1 = _mm_set1_epi8(0x55), m2 = _mm_set1_epi8(0x33), m4 = _mm_set1_epi8(0x0f);
+      v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi64(v, 1), m1));
+      v = _mm_add_epi8(_mm_and_si128(v, m2), _mm_and_si128(_mm_srli_epi64(v, 2), m2));
+      v = _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi64(v, 4)), m4);
+      return _mm_sad_epu8(v, _mm_setzero_si128());
+   }
+   // the two 64 bit lanes; a 32 bit size_t holds no more anyway
+   inline ttl::size_t bits_sse2_sum(__m128i acc)
+   {
+#ifdef __x86_64__
+      return (ttl::size_t)_mm_cvtsi128_si64(acc) + (ttl::size_t)_mm_cvtsi128_si64(_mm_srli_si128(acc, 8));
+#else
+      return (ttl::size_t)_mm_cvtsi128_si32(acc) + (ttl::size_t)_mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+#endif
+   }
+   inline ttl::size_t bits_sse2_count(const void *a, ttl::size_t blocks)
+   {
+      const __m128i *i = static_cast<const __m128i *>(a);
+      __m128i acc = _mm_setzero_si128();
+      for (; blocks--; ++i)
+         acc = _mm_add_epi64(acc, bits_sse2_popcount(_mm_loadu_si128(i)));
+      return bits_sse2_sum(acc);
+   }
+   inline ttl::size_t bits_sse2_count_and(const void *a, const void *b, ttl::size_t blocks)
+   {
+      const __m128i *i = static_cast<const __m128i *>(a), *j = static_cast<const __m128i *>(b);
+      __m128i acc = _mm_setzero_si128();
+      for (; blocks--; ++i, ++j)
+         acc = _mm_add_epi64(acc, bits_sse2_popcount(_mm_and_si128(_mm_loadu_si128(i), _mm_loadu_si128(j))));
+      return bits_sse2_sum(acc);
+   }
+
+#ifdef TTL_BITS_AVX2
+   //
+   // AVX2, with the nibble lookup table popcount
+   //
+#define TTL_BITS_AVX2_TARGET __attribute__((target("avx2")))
+   TTL_BITS_AVX2_TARGET inline void bits_avx2_and(void *d, const void *s, ttl::size_t blocks)
+   {
+      __m256i *o = static_cast<__m256i *>(d);
+      const __m256i *i = static_cast<const __m256i *>(s);
+      for (; blocks--; ++o, ++i)
+         _mm256_storeu_si256(o, _mm256_and_si256(_mm256_loadu_si256(o), _mm256_loadu_si256(i)));
+   }
+   TTL_BITS_AVX2_TARGET inline void bits_avx2_or(void *d, const void *s, ttl::size_t blocks)
+   {
+      __m256i *o = static_cast<__m256i *>(d);
+      const __m256i *i = static_cast<const __m256i *>(s);
+      for (; blocks--; ++o, ++i)
+         _mm256_storeu_si256(o, _mm256_or_si256(_mm256_loadu_si256(o), _mm256_loadu_si256(i)));
+   }
+   TTL_BITS_AVX2_TARGET inline void bits_avx2_xor(void *d, const void *s, ttl::size_t blocks)
+   {
+      __m256i *o = static_cast<__m256i *>(d);
+      const __m256i *i = static_cast<const __m256i *>(s);
+      for (; blocks--; ++o, ++i)
+         _mm256_storeu_si256(o, _mm256_xor_si256(_mm256_loadu_si256(o), _mm256_loadu_si256(i)));
+   }
+   TTL_BITS_AVX2_TARGET inline void bits_avx2_not(void *d, const void *s, ttl::size_t blocks)
+   {
+      __m256i *o = static_cast<__m256i *>(d);
+      const __m256i *i = static_cast<const __m256i *>(s);
+      const __m256i ones = _mm256_set1_epi32(-1);
+      for (; blocks--; ++o, ++i)
+         _mm256_storeu_si256(o, _mm256_xor_si256(_mm256_loadu_si256(i), ones));
+   }
+   TTL_BITS_AVX2_TARGET inline bool bits_avx2_equal(const void *a, const void *b, ttl::size_t blocks)
+   {
+      const __m256i *i = static_cast<const __m256i *>(a), *j = static_cast<const __m256i *>(b);
+      for (; blocks--; ++i, ++j)
+      {
+         const __m256i x = _mm256_xor_si256(_mm256_loadu_si256(i), _mm256_loadu_si256(j));
+         if (!_mm256_testz_si256(x, x))
+            return false;
+      }
+      return true;
+   }
+   TTL_BITS_AVX2_TARGET inline bool bits_avx2_intersects(const void *a, const void *b, ttl::size_t blocks)
+   {
+      const __m256i *i = static_cast<const __m256i *>(a), *j = static_cast<const __m256i *>(b);
+      for (; blocks--; ++i, ++j)
+         if (!_mm256_testz_si256(_mm256_loadu_si256(i), _mm256_loadu_si256(j)))
+            return true;
+      return false;
+   }
+   TTL_BITS_AVX2_TARGET inline __m256i bits_avx2_popcount(__m256i v)
+   {
+      const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                             0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+      const __m256i m4 = _mm256_set1_epi8(0x0f);
+      const __m256i c = _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(v, m4)),
+                                        _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), m4)));
+      return _mm256_sad_epu8(c, _mm256_setzero_si256());
+   }
+   TTL_BITS_AVX2_TARGET inline ttl::size_t bits_avx2_sum(__m256i acc)
+   {
+      const __m128i s = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+      return bits_sse2_sum(s);
+   }
+   TTL_BITS_AVX2_TARGET inline ttl::size_t bits_avx2_count(const void *a, ttl::size_t blocks)
+   {
+      const __m256i *i = static_cast<const __m256i *>(a);
+      __m256i acc = _mm256_setzero_si256();
+      for (; blocks--; ++i)
+         acc = _mm256_add_epi64(acc, bits_avx2_popcount(_mm256_loadu_si256(i)));
+      return bits_avx2_sum(acc);
+   }
+   TTL_BITS_AVX2_TARGET inline ttl::size_t bits_avx2_count_and(const void *a, const void *b, ttl::size_t blocks)
+   {
+      const __m256i *i = static_cast<const __m256i *>(a), *j = static_cast<const __m256i *>(b);
+      __m256i acc = _mm256_setzero_si256();
+      for (; blocks--; ++i, ++j)
+         acc = _mm256_add_epi64(acc, bits_avx2_popcount(_mm256_and_si256(_mm256_loadu_si256(i), _mm256_loadu_si256(j))));
+      return bits_avx2_sum(acc);
+   }
+#undef TTL_BITS_AVX2_TARGET
+
+   inline bool bits_have_avx2()
+   {
+#ifdef __AVX2__
+      return true;
+#else
+      static const bool avx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") != 0);
+      return avx2;
+#endif
+   }
+#define TTL_BITS_DISPATCH(sse2, avx2) \
+      (bits_have_avx2() ? (avx2, bytes / 32 * 32): (sse2, bytes / 16 * 16))
+#else
+   inline bool bits_have_avx2() { return false; }
+#define TTL_BITS_DISPATCH(sse2, avx2) (sse2, bytes / 16 * 16)
+#endif
+
+   //
+   // the entry points, dispatched on the length and the CPU
+   //
+   inline ttl::size_t bits_simd_and(void *d, const void *s, ttl::size_t bytes)
+   {
+      if (bytes < bits_simd_min_bytes)
+         return 0;
+      return TTL_BITS_DISPATCH(bits_sse2_and(d, s, bytes / 16), bits_avx2_and(d, s, bytes / 32));
+   }
+   inline ttl::size_t bits_simd_or(void *d, const void *s, ttl::size_t bytes)
+   {
+      if (bytes < bits_simd_min_bytes)
+         return 0;
+      return TTL_BITS_DISPATCH(bits_sse2_or(d, s, bytes / 16), bits_avx2_or(d, s, bytes / 32));
+   }
+   inline ttl::size_t bits_simd_xor(void *d, const void *s, ttl::size_t bytes)
+   {
+      if (bytes < bits_simd_min_bytes)
+         return 0;
+      return TTL_BITS_DISPATCH(bits_sse2_xor(d, s, bytes / 16), bits_avx2_xor(d, s, bytes / 32));
+   }
+   inline ttl::size_t bits_simd_not(void *d, const void *s, ttl::size_t bytes)
+   {
+      if (bytes < bits_simd_min_bytes)
+         return 0;
+      return TTL_BITS_DISPATCH(bits_sse2_not(d, s, bytes / 16), bits_avx2_not(d, s, bytes / 32));
+   }
+   inline ttl::size_t bits_simd_equal(const void *a, const void *b, ttl::size_t bytes, bool &equal)
+   {
+      equal = true;
+      if (bytes < bits_simd_min_bytes)
+         return 0;
+      return TTL_BITS_DISPATCH(equal = bits_sse2_equal(a, b, bytes / 16), equal = bits_avx2_equal(a, b, bytes / 32));
+   }
+   inline ttl::size_t bits_simd_intersects(const void *a, const void *b, ttl::size_t bytes, bool &intersects)
+   {
+      intersects = false;
+      if (bytes < bits_simd_min_bytes)
+         return 0;
+      return TTL_BITS_DISPATCH(intersects = bits_sse2_intersects(a, b, bytes / 16),
+                               intersects = bits_avx2_intersects(a, b, bytes / 32));
+   }
+   inline ttl::size_t bits_simd_count(const void *a, ttl::size_t bytes, ttl::size_t &count)
+   {
+      count = 0;
+      if (bytes < bits_simd_min_bytes)
+         return 0;
+      return TTL_BITS_DISPATCH(count = bits_sse2_count(a, bytes / 16), count = bits_avx2_count(a, bytes / 32));
+   }
+   inline ttl::size_t bits_simd_count_and(const void *a, const void *b, ttl::size_t bytes, ttl::size_t &count)
+   {
+      count = 0;
+      if (bytes < bits_simd_min_bytes)
+         return 0;
+      return TTL_BITS_DISPATCH(count = bits_sse2_count_and(a, b, bytes / 16),
+                               count = bits_avx2_count_and(a, b, bytes / 32));
+   }
+#undef TTL_BITS_DISPATCH
+}
+#endif // TTL_BITS_SIMD
+
+#endif // _TINY_TEMPLATE_LIBRARY_BITS_SIMD_HPP_
@@ -2,6 +2,16 @@
 //
 // Tiny Template Library: the implementation of STL bitset
 //
+// The bits are kept in words of type Slot, by default the smallest of
+// unsigned char, short, int and long which holds N bits, so that a
+// bitset<10> takes 2 bytes and packs with the other members of a struct;
+// the larger sets use the native word. Under C++11 the construction from
+// an integer, test() and operator[] are constexpr, under C++14 set(),
+// reset() and flip() of a bit too: the masks of constant bitsets fold at
+// compile time.
+//
+//    static constexpr ttl::bitset<12> mask = ttl::bitset<12>(0x30ul).set(9); // C++14
+//
 // This code is Public Domain
 //
 #ifndef _TINY_TEMPLATE_LIBRARY_BITSET_HPP_
@@ -9,45 +19,96 @@
 
 #include <limits.h>
 #include "types.hpp"
+#include "bits.hpp"
 
 namespace ttl
 {
-   template<ttl::size_t N> class bitset
+   // the smallest word for N bits, up to unsigned long
+   template<int Rank> struct bitset_slot_of_rank { typedef unsigned long type; };
+   template<> struct bitset_slot_of_rank<1> { typedef unsigned type; };
+   template<> struct bitset_slot_of_rank<2> { typedef unsigned short type; };
+   template<> struct bitset_slot_of_rank<3> { typedef unsigned char type; };
+   template<ttl::size_t N>
+   struct bitset_slot
    {
+      typedef typename bitset_slot_of_rank<(N <= sizeof(unsigned char) * CHAR_BIT) +
+                                           (N <= sizeof(unsigned short) * CHAR_BIT) +
+                                           (N <= sizeof(unsigned) * CHAR_BIT)>::type type;
+   };
+
+#if __cplusplus >= 201103L // C++11
+   // the indexes of the words the constexpr constructors fill
+   template<ttl::size_t...> struct bitset_indices {};
+   template<ttl::size_t N, ttl::size_t... I> struct bitset_make_indices: bitset_make_indices<N - 1, N - 1, I...> {};
+   template<ttl::size_t... I> struct bitset_make_indices<0, I...> { typedef bitset_indices<I...> type; };
+#endif
+
+   template<ttl::size_t N, typename Slot = typename bitset_slot<N>::type> class bitset
+   {
+   public:
+      typedef Slot slot_type;
+
    private:
-      typedef unsigned long slot_type;
-      slot_type *bits_slot(ttl::size_t pos) { return bits_ + pos / (sizeof(slot_type) * CHAR_BIT); }
-      const slot_type *bits_slot(ttl::size_t pos) const { return bits_ + pos / (sizeof(slot_type) * CHAR_BIT); }
-      static slot_type bits_bit(ttl::size_t pos) { return pos % (sizeof(slot_type) * CHAR_BIT); }
-      slot_type bits_[(N + sizeof(slot_type) * CHAR_BIT - 1) / (sizeof(slot_type) * CHAR_BIT)];
+      enum { BPW = sizeof(slot_type) * CHAR_BIT, slots = (N + BPW - 1) / BPW,
+             // the words an unsigned long long fills
+             integer_slots = slots * BPW < sizeof(unsigned long long) * CHAR_BIT ? slots:
+                (sizeof(unsigned long long) * CHAR_BIT + BPW - 1) / BPW };
+
+      slot_type *bits_slot(ttl::size_t pos) { return bits_ + pos / BPW; }
+      const slot_type *bits_slot(ttl::size_t pos) const { return bits_ + pos / BPW; }
+      static ttl_constexpr slot_type bits_mask(ttl::size_t pos) { return (slot_type)((slot_type)1 << pos % BPW); }
+      // the word i of an integer
+      static ttl_constexpr slot_type integer_slot(unsigned long long bits, ttl::size_t i)
+      {
+         return i * BPW < sizeof(bits) * CHAR_BIT ? (slot_type)(bits >> i * BPW): 0;
+      }
+      void assign(unsigned long long bits)
+      {
+         for (ttl::size_t i = 0; i < slots; ++i)
+            bits_[i] = integer_slot(bits, i);
+      }
+#if __cplusplus >= 201103L // C++11
+      template<ttl::size_t... I>
+      constexpr bitset(unsigned long long bits, bitset_indices<I...>): bits_{ integer_slot(bits, I)... } {}
+      // bitset<0>: no word to fill
+      constexpr bitset(unsigned long long, bitset_indices<>): bits_{} {}
+#endif
+
+      slot_type bits_[slots];
 
    public:
-      static slot_type last_bits()
+      static ttl_constexpr slot_type last_bits()
       {
-         return sizeof(bits_)*CHAR_BIT == N ? (slot_type)-1: (1lu << (N % (sizeof(slot_type) * CHAR_BIT))) - 1lu;
+         return N % BPW ? (slot_type)(((slot_type)1 << N % BPW) - 1): (slot_type)-1;
       }
-      ttl::size_t last_slot_index() const {return N ? sizeof(bits_)/sizeof(*bits_) - 1: 0; }
+      ttl::size_t last_slot_index() const {return N ? slots - 1: 0; }
 
       // uninitializing ctor to avoid unneeded initialization
       bitset(const bitset &, bool) {}
 
    public:
-      bitset() { reset(); }
+      ttl_constexpr bitset(): bits_() {}
+#if __cplusplus >= 201103L // C++11
+      constexpr bitset(const bitset &other) = default;
+      constexpr bitset(unsigned long bits): bitset(bits, typename bitset_make_indices<integer_slots>::type()) {}
+      explicit constexpr bitset(unsigned long long bits): bitset(bits, typename bitset_make_indices<integer_slots>::type()) {}
+#else
       bitset(const bitset &other) { operator=(other); }
-      bitset(unsigned long bits);
-      explicit bitset(unsigned long long bits);
+      bitset(unsigned long bits) { assign(bits); }
+      explicit bitset(unsigned long long bits) { assign(bits); }
+#endif
       explicit bitset(const char *bits, ttl::size_t n = (ttl::size_t)-1, char zero = '0', char one = '1');
 
-      ~bitset() {}
-
-      template<ttl::size_t M> explicit bitset(const bitset<M> &other);
-      template<ttl::size_t M> operator bitset<M>() const
+      template<ttl::size_t M, typename S> explicit bitset(const bitset<M, S> &other);
+      template<ttl::size_t M, typename S> operator bitset<M, S>() const
       {
-         return bitset<M>(*this);
+         return bitset<M, S>(*this);
       }
-      template<ttl::size_t M> bitset &operator=(const bitset<M> &other);
+      template<ttl::size_t M, typename S> bitset &operator=(const bitset<M, S> &other);
 
       slot_type slot(ttl::size_t s) const { return bits_[s]; }
+      slot_type *data() { return bits_; }
+      const slot_type *data() const { return bits_; }
 
       bitset &operator=(const bitset &other);
 
@@ -58,7 +119,7 @@ namespace ttl
       {
       private:
          reference(const reference &other); /* none */
-         friend class bitset<N>;
+         friend class bitset;
          reference(slot_type *bits, slot_type mask): bits_(bits), mask_(mask) {}
          slot_type *bits_;
          slot_type mask_;
@@ -79,18 +140,15 @@ namespace ttl
          reference &flip() { *bits_ ^= mask_; return *this; }
       };
 
-      bool operator[](ttl::size_t pos) const
-      {
-         return pos < N && (*bits_slot(pos) & (1ul << bits_bit(pos)));
-      }
+      ttl_constexpr bool operator[](ttl::size_t pos) const { return test(pos); }
       reference operator[](ttl::size_t pos)
       {
-         return reference(bits_slot(pos), (pos < N) * 1ul << bits_bit(pos));
+         return reference(bits_slot(pos), pos < N ? bits_mask(pos): 0);
       }
 
-      bool test(ttl::size_t pos) const
+      ttl_constexpr bool test(ttl::size_t pos) const
       {
-         return pos < N && (*bits_slot(pos) & (1ul << bits_bit(pos)));
+         return pos < N && (bits_[pos / BPW] & bits_mask(pos));
       }
 
       bool all() const;
@@ -100,108 +158,93 @@ namespace ttl
       ttl::size_t size() const { return N; }
       ttl::size_t capacity() const { return sizeof(bits_) * CHAR_BIT; }
 
-      bitset<N> &operator&=(const bitset<N> &other);
-      bitset<N> &operator|=(const bitset<N> &other);
-      bitset<N> &operator^=(const bitset<N> &other);
-      bitset<N> operator~() const;
-
-      bitset<N> operator<<(ttl::size_t pos) const;
-      bitset<N> &operator<<=(ttl::size_t pos);
-      bitset<N> operator>>(ttl::size_t pos) const;
-      bitset<N> &operator>>=(ttl::size_t pos);
-
-      bitset<N> &set()
+      // the scans of the set bits return size() when there is none
+      ttl::size_t find_first() const { return bits_find_next(bits_, N, 0); }
+      ttl::size_t find_next(ttl::size_t pos) const { return bits_find_next(bits_, N, pos + 1); }
+      ttl::size_t find_last() const { return bits_find_last(bits_, N); }
+      // calls f(pos) for each set bit, in order
+      template<class UnaryFunction>
+      UnaryFunction for_each_set(UnaryFunction f) const { return bits_for_each(bits_, N, f); }
+
+      bitset &operator&=(const bitset &other);
+      bitset &operator|=(const bitset &other);
+      bitset &operator^=(const bitset &other);
+      bitset operator~() const;
+
+      bitset operator<<(ttl::size_t pos) const;
+      bitset &operator<<=(ttl::size_t pos);
+      bitset operator>>(ttl::size_t pos) const;
+      bitset &operator>>=(ttl::size_t pos);
+
+      bitset &set()
       {
-         for (unsigned i = 0; i < sizeof(bits_)/sizeof(*bits_); ++i)
+         for (ttl::size_t i = 0; i < slots; ++i)
             bits_[i] = (slot_type)-1;
          return *this;
       }
-      bitset<N> &set(ttl::size_t pos)
+      ttl_constexpr14 bitset &set(ttl::size_t pos)
       {
-         *bits_slot(pos) |= 1lu << bits_bit(pos);
+         bits_[pos / BPW] |= bits_mask(pos);
          return *this;
       }
-      bitset<N> &set(ttl::size_t pos, bool value)
+      ttl_constexpr14 bitset &set(ttl::size_t pos, bool value)
       {
-         const slot_type mask = (slot_type)value << bits_bit(pos);
-         *bits_slot(pos) = (*bits_slot(pos) & ~mask) | mask;
+         const slot_type mask = bits_mask(pos);
+         bits_[pos / BPW] = (slot_type)((bits_[pos / BPW] & ~mask) | (-(slot_type)value & mask));
          return *this;
       }
 
-      bitset<N> &reset()
+      bitset &reset()
       {
-         for (unsigned i = 0; i < sizeof(bits_)/sizeof(*bits_); ++i)
+         for (ttl::size_t i = 0; i < slots; ++i)
             bits_[i] = 0;
          return *this;
       }
-      bitset<N> &reset(ttl::size_t pos)
+      ttl_constexpr14 bitset &reset(ttl::size_t pos)
       {
-         *bits_slot(pos) &= ~(1lu << bits_bit(pos));
+         bits_[pos / BPW] &= (slot_type)~bits_mask(pos);
          return *this;
       }
 
-      bitset<N> &flip()
+      bitset &flip()
       {
-         for (unsigned i = 0; i < sizeof(bits_)/sizeof(*bits_); ++i)
-            bits_[i] = ~bits_[i];
+         for (ttl::size_t i = 0; i < slots; ++i)
+            bits_[i] = (slot_type)~bits_[i];
          return *this;
       }
-      bitset<N> &flip(ttl::size_t pos)
+      ttl_constexpr14 bitset &flip(ttl::size_t pos)
       {
-         *bits_slot(pos) ^= 1lu << bits_bit(pos);
+         bits_[pos / BPW] ^= bits_mask(pos);
          return *this;
       }
 
-      unsigned long to_ulong() const { return (N < sizeof(*bits_) * CHAR_BIT ? last_bits(): (slot_type)-1) & *bits_; }
-      unsigned long long to_ullong() const
-      {
-#if __SIZEOF_LONG__ < __SIZEOF_LONG_LONG__
-         const ttl::size_t BPW = sizeof(*bits_) * CHAR_BIT;
-         return static_cast<unsigned long long>(to_ulong()) |
-            (N < BPW + 1 ? 0ull:
-             (static_cast<unsigned long long>(bits_[1] & (N < BPW * 2 ? last_bits(): (slot_type)-1)) << BPW));
-#else
-         return static_cast<unsigned long long>(to_ulong());
-#endif
-      }
+      // the bits which fit, the others are lost
+      unsigned long to_ulong() const { return (unsigned long)to_ullong(); }
+      unsigned long long to_ullong() const;
    };
 
-   template<ttl::size_t N>
-   inline bitset<N>::bitset(unsigned long bits)
+   template<ttl::size_t N, typename Slot>
+   unsigned long long bitset<N, Slot>::to_ullong() const
    {
-      bits_[0] = bits;
-      for (unsigned i = 1; i < sizeof(bits_)/sizeof(*bits_); ++i)
-         bits_[i] = 0;
+      unsigned long long bits = 0;
+      for (ttl::size_t i = 0; i < integer_slots; ++i)
+         bits |= (unsigned long long)(i == slots - 1 ? bits_[i] & last_bits(): bits_[i]) << i * BPW;
+      return bits;
    }
-   template<ttl::size_t N>
-   bitset<N>::bitset(unsigned long long bits)
-   {
-#if __SIZEOF_LONG__ < __SIZEOF_LONG_LONG__
-      for (unsigned i = 0; i < sizeof(bits_)/sizeof(*bits_); ++i)
-      {
-         bits_[i] = bits & (unsigned long)-1;
-         bits >>= sizeof(slot_type) * CHAR_BIT;
-      }
-#else
-      bits_[0] = bits;
-      for (unsigned i = 1; i < sizeof(bits_)/sizeof(*bits_); ++i)
-         bits_[i] = 0;
-#endif
-   }
-   template<ttl::size_t N>
-   template<ttl::size_t M>
-   bitset<N>::bitset(const bitset<M> &other)
+   template<ttl::size_t N, typename Slot>
+   template<ttl::size_t M, typename S>
+   bitset<N, Slot>::bitset(const bitset<M, S> &other)
    {
       operator=(other);
    }
-   template<ttl::size_t N>
-   bitset<N>::bitset(const char *bits, ttl::size_t n, char zero, char one)
+   template<ttl::size_t N, typename Slot>
+   bitset<N, Slot>::bitset(const char *bits, ttl::size_t n, char zero, char one)
    {
       ttl::size_t i;
       for (i = 0; i < n; ++i)
          if (!(bits[i] == zero || bits[i] == one))
             break;
-      for (ttl::size_t s = i / (sizeof(slot_type) * CHAR_BIT); s < sizeof(bits_)/sizeof(*bits_); ++s)
+      for (ttl::size_t s = i / BPW; s < slots; ++s)
          bits_[s] = 0;
       for (; i--; ++bits)
          if (*bits == zero)
@@ -211,18 +254,15 @@ namespace ttl
          else
             break;
    }
-   template<ttl::size_t N>
-   inline bool bitset<N>::operator==(const bitset &other) const
+   template<ttl::size_t N, typename Slot>
+   inline bool bitset<N, Slot>::operator==(const bitset &other) const
    {
-      unsigned i;
-      for (i = 0; i < last_slot_index(); ++i)
-         if (bits_[i] != other.bits_[i])
-            return false;
-      return !((bits_[i] ^ other.bits_[i]) & last_bits());
+      const ttl::size_t i = last_slot_index();
+      return bits_equal(bits_, other.bits_, i) && !((bits_[i] ^ other.bits_[i]) & last_bits());
    }
 
-   template<ttl::size_t N>
-   inline bool bitset<N>::all() const
+   template<ttl::size_t N, typename Slot>
+   inline bool bitset<N, Slot>::all() const
    {
       unsigned i;
       for (i = 0; i < last_slot_index(); ++i)
@@ -230,8 +270,8 @@ namespace ttl
             return false;
       return (bits_[i] & last_bits()) == last_bits();
    }
-   template<ttl::size_t N>
-   inline bool bitset<N>::any() const
+   template<ttl::size_t N, typename Slot>
+   inline bool bitset<N, Slot>::any() const
    {
       unsigned i;
       for (i = 0; i < last_slot_index(); ++i)
@@ -239,8 +279,8 @@ namespace ttl
             return true;
       return bits_[i] & last_bits();
    }
-   template<ttl::size_t N>
-   inline bool bitset<N>::none() const
+   template<ttl::size_t N, typename Slot>
+   inline bool bitset<N, Slot>::none() const
    {
       unsigned i;
       for (i = 0; i < last_slot_index(); ++i)
@@ -248,131 +288,142 @@ namespace ttl
             return false;
       return !(bits_[i] & last_bits());
    }
-   template<ttl::size_t N>
-   ttl::size_t bitset<N>::count() const
+   template<ttl::size_t N, typename Slot>
+   ttl::size_t bitset<N, Slot>::count() const
    {
-      ttl::size_t c = 0;
-      for (unsigned i = 0; i < sizeof(bits_)/sizeof(*bits_); ++i)
-      {
-         slot_type b = bits_[i];
-         if (i == last_slot_index())
-            b &= last_bits();
-#ifdef __GNUC__
-         c += __builtin_popcountl(b);
-#else
-         while (b)
-         {
-            ++c;
-            b &= b - 1;
-         }
-#endif
-      }
-      return c;
+      const ttl::size_t i = last_slot_index();
+      return bits_count(bits_, i) + bits_popcount(bits_[i] & last_bits());
    }
-   template<ttl::size_t N>
-   inline bitset<N> &bitset<N>::operator=(const bitset &other)
+   template<ttl::size_t N, typename Slot>
+   inline bitset<N, Slot> &bitset<N, Slot>::operator=(const bitset &other)
    {
-      for (unsigned i = 0; i < sizeof(bits_)/sizeof(*bits_); ++i)
+      for (ttl::size_t i = 0; i < slots; ++i)
          bits_[i] = other.bits_[i];
       return *this;
    }
-   template<ttl::size_t N>
-   template<ttl::size_t M>
-   bitset<N> &bitset<N>::operator=(const bitset<M> &other)
+   template<ttl::size_t N, typename Slot>
+   template<ttl::size_t M, typename S>
+   bitset<N, Slot> &bitset<N, Slot>::operator=(const bitset<M, S> &other)
    {
-      unsigned i;
-      const ttl::size_t n = N < M ? capacity()/(sizeof(slot_type) * CHAR_BIT): other.capacity()/(sizeof(slot_type) * CHAR_BIT);
-      for (i = 0; i < n; ++i)
-         bits_[i] = other.slot(i);
-      for ( ; i < sizeof(bits_)/sizeof(*bits_); ++i)
+      ttl::size_t i = 0;
+      if (sizeof(S) == sizeof(slot_type))
+      {
+         const ttl::size_t n = N < M ? (ttl::size_t)slots: other.capacity() / BPW;
+         for (; i < n; ++i)
+            bits_[i] = (slot_type)other.slot(i);
+      }
+      else
+      {
+         // words of another size: bit by bit
+         reset();
+         for (; i < N && i < M; ++i)
+            if (other.test(i))
+               set(i);
+         i = (i + BPW - 1) / BPW;
+      }
+      for (; i < slots; ++i)
          bits_[i] = 0;
       return *this;
    }
 
-   template<const ttl::size_t N>
-   bitset<N> &bitset<N>::operator&=(const bitset<N> &other)
+   template<ttl::size_t N, typename Slot>
+   bitset<N, Slot> &bitset<N, Slot>::operator&=(const bitset &other)
    {
-      for (unsigned i = 0; i < sizeof(bits_)/sizeof(*bits_); ++i)
-         bits_[i] &= other.bits_[i];
+      bits_and(bits_, other.bits_, slots);
       return *this;
    }
-   template<const ttl::size_t N>
-   bitset<N> &bitset<N>::operator|=(const bitset<N> &other)
+   template<ttl::size_t N, typename Slot>
+   bitset<N, Slot> &bitset<N, Slot>::operator|=(const bitset &other)
    {
-      for (unsigned i = 0; i < sizeof(bits_)/sizeof(*bits_); ++i)
-         bits_[i] |= other.bits_[i];
+      bits_or(bits_, other.bits_, slots);
       return *this;
    }
-   template<const ttl::size_t N>
-   bitset<N> &bitset<N>::operator^=(const bitset<N> &other)
+   template<ttl::size_t N, typename Slot>
+   bitset<N, Slot> &bitset<N, Slot>::operator^=(const bitset &other)
    {
-      for (unsigned i = 0; i < sizeof(bits_)/sizeof(*bits_); ++i)
-         bits_[i] ^= other.bits_[i];
+      bits_xor(bits_, other.bits_, slots);
       return *this;
    }
-   template<const ttl::size_t N>
-   bitset<N> bitset<N>::operator~() const
+   template<ttl::size_t N, typename Slot>
+   bitset<N, Slot> bitset<N, Slot>::operator~() const
    {
-      bitset<N> other(*this, true);
-      for (unsigned i = 0; i < sizeof(bits_)/sizeof(*bits_); ++i)
-         other.bits_[i] = ~bits_[i];
+      bitset other(*this, true);
+      bits_not(other.bits_, bits_, slots);
       return other;
    }
 
-   template<const ttl::size_t N>
-   bitset<N> bitset<N>::operator<<(ttl::size_t pos) const
+   // the shifts move whole words, with the carry between them; the bits
+   // past N are cleared first, so they do not shift into the set
+   template<ttl::size_t N, typename Slot>
+   inline bitset<N, Slot> bitset<N, Slot>::operator<<(ttl::size_t pos) const
    {
-      bitset<N> other;
-      for (unsigned i = 0; pos < N; ++i, ++pos)
-         if (test(i))
-            other.set(pos);
-      return other;
+      bitset other(*this);
+      return other <<= pos;
    }
 
-   template<const ttl::size_t N>
-   bitset<N> &bitset<N>::operator<<=(ttl::size_t pos)
+   template<ttl::size_t N, typename Slot>
+   bitset<N, Slot> &bitset<N, Slot>::operator<<=(ttl::size_t pos)
    {
-      bitset<N> other = *this << pos;
-      return *this = other;
+      bits_shift_up(bits_, slots, pos);
+      bits_[last_slot_index()] &= last_bits();
+      return *this;
    }
 
-   template<const ttl::size_t N>
-   bitset<N> bitset<N>::operator>>(ttl::size_t pos) const
+   template<ttl::size_t N, typename Slot>
+   inline bitset<N, Slot> bitset<N, Slot>::operator>>(ttl::size_t pos) const
    {
-      bitset<N> other;
-      for (unsigned i = 0; pos < N; ++i, ++pos)
-         if (test(pos))
-            other.set(i);
-      return other;
+      bitset other(*this);
+      return other >>= pos;
+   }
+
+   template<ttl::size_t N, typename Slot>
+   bitset<N, Slot> &bitset<N, Slot>::operator>>=(ttl::size_t pos)
+   {
+      bits_[last_slot_index()] &= last_bits();
+      bits_shift_down(bits_, slots, pos);
+      return *this;
+   }
+
+   // the number of bits set in both a and b, without the temporary of
+   // (a & b).count()
+   template<ttl::size_t N, typename Slot>
+   ttl::size_t count_and(const bitset<N, Slot> &a, const bitset<N, Slot> &b)
+   {
+      if (!N)
+         return 0;
+      const ttl::size_t i = a.last_slot_index();
+      return bits_count_and(a.data(), b.data(), i) + bits_popcount(a.slot(i) & b.slot(i) & a.last_bits());
    }
 
-   template<const ttl::size_t N>
-   bitset<N> &bitset<N>::operator>>=(ttl::size_t pos)
+   // true if a bit is set in both a and b
+   template<ttl::size_t N, typename Slot>
+   bool intersects(const bitset<N, Slot> &a, const bitset<N, Slot> &b)
    {
-      bitset<N> other = *this >> pos;
-      return *this = other;
+      if (!N)
+         return false;
+      const ttl::size_t i = a.last_slot_index();
+      return bits_intersects(a.data(), b.data(), i) || (a.slot(i) & b.slot(i) & a.last_bits());
    }
 
-   template<const ttl::size_t N>
-   bitset<N> operator&(const bitset<N> &a, const bitset<N> &b)
+   template<ttl::size_t N, typename Slot>
+   bitset<N, Slot> operator&(const bitset<N, Slot> &a, const bitset<N, Slot> &b)
    {
-      return bitset<N>(a) &= b;
+      return bitset<N, Slot>(a) &= b;
    }
 
-   template<const ttl::size_t N>
-   bitset<N> operator|(const bitset<N> &a, const bitset<N> &b)
+   template<ttl::size_t N, typename Slot>
+   bitset<N, Slot> operator|(const bitset<N, Slot> &a, const bitset<N, Slot> &b)
    {
-      return bitset<N>(a) |= b;
+      return bitset<N, Slot>(a) |= b;
    }
 
-   template<const ttl::size_t N>
-   bitset<N> operator^(const bitset<N> &a, const bitset<N> &b)
+   template<ttl::size_t N, typename Slot>
+   bitset<N, Slot> operator^(const bitset<N, Slot> &a, const bitset<N, Slot> &b)
    {
-      return bitset<N>(a) ^= b;
+      return bitset<N, Slot>(a) ^= b;
    }
 
    template<> inline bitset<0>::slot_type *bitset<0>::bits_slot(ttl::size_t) { return bits_; }
-   template<> inline bool bitset<0>::test(ttl::size_t) const { return false; }
    template<> inline bitset<0> &bitset<0>::set() { return *this; }
    template<> inline bitset<0> &bitset<0>::set(ttl::size_t) { return *this; }
    template<> inline bitset<0> &bitset<0>::set(ttl::size_t, bool) { return *this; }
@@ -392,11 +443,13 @@ namespace ttl
    template<> inline bitset<0> bitset<0>::operator~() const { return bitset<0>(); }
    template<> inline bitset<0> bitset<0>::operator<<(ttl::size_t) const { return bitset<0>(); }
    template<> inline bitset<0> bitset<0>::operator>>(ttl::size_t) const { return bitset<0>(); }
+   template<> inline bitset<0> &bitset<0>::operator<<=(ttl::size_t) { return *this; }
+   template<> inline bitset<0> &bitset<0>::operator>>=(ttl::size_t) { return *this; }
 
-   template<const ttl::size_t N> inline bool operator==(const bitset<0> &, const bitset<N> &b) { return b.none(); }
-   template<const ttl::size_t N> inline bool operator==(const bitset<N> &a, const bitset<0> &) { return a.none(); }
-   template<const ttl::size_t N> inline bool operator!=(const bitset<0> &, const bitset<N> &b) { return !b.none(); }
-   template<const ttl::size_t N> inline bool operator!=(const bitset<N> &a, const bitset<0> &) { return !a.none(); }
+   template<ttl::size_t N, typename Slot> inline bool operator==(const bitset<0> &, const bitset<N, Slot> &b) { return b.none(); }
+   template<ttl::size_t N, typename Slot> inline bool operator==(const bitset<N, Slot> &a, const bitset<0> &) { return a.none(); }
+   template<ttl::size_t N, typename Slot> inline bool operator!=(const bitset<0> &, const bitset<N, Slot> &b) { return !b.none(); }
+   template<ttl::size_t N, typename Slot> inline bool operator!=(const bitset<N, Slot> &a, const bitset<0> &) { return !a.none(); }
    template<> inline bool bitset<0>::operator==(const bitset<0> &) const { return true; }
 }
 
@@ -0,0 +1,255 @@
+/////////////////////////////////////////////////// vim: sw=3 ts=8 et
+//
+// Tiny Template Library: Bloom filters, to tell cheaply that a key is
+// surely not in a set
+//
+// bloom_filter<Bits, K> sets K bits of a bitset<Bits> for each key, taken
+// anywhere in it: a query touches up to K cache lines. blocked_bloom_filter
+// takes the K bits in a single block of 512 bits, a cache line: a query is
+// one miss at most, for a slightly higher false positive rate.
+//
+//    static ttl::blocked_bloom_filter<1 << 20, 6, unsigned> seen;
+//    seen.insert(id);
+//    if (seen.might_contain(id))
+//       ... look it up in the map
+//
+// With n keys, the false positives are about (1 - e^(-K n / Bits))^K: for
+// 10 bits a key and K = 7, 0.8%.
+//
+// Hash makes a size_t of a Key, ttl::hash by default. The filters mix its
+// bits again, so a hash which is just the value will do; they take the K
+// bit positions out of the mixed 64 bits by double hashing. The batched
+// might_contain() hashes a group of keys and prefetches their blocks, or
+// the lines of their first two bits, before testing the first: the misses
+// are waited for together.
+//
+// This code is Public Domain
+//
+#ifndef _TINY_TEMPLATE_LIBRARY_BLOOM_FILTER_HPP_
+#define _TINY_TEMPLATE_LIBRARY_BLOOM_FILTER_HPP_ 1
+
+#include <limits.h>
+#include "types.hpp"
+#include "functional.hpp"
+#include "bitset.hpp"
+
+#ifdef __GNUC__
+#define TTL_BLOOM_PREFETCH(p) __builtin_prefetch(p)
+#define TTL_BLOOM_ALIGNED __attribute__((aligned(64)))
+#else
+#define TTL_BLOOM_PREFETCH(p) ((void)0)
+#define TTL_BLOOM_ALIGNED
+#endif
+
+namespace ttl
+{
+   // the 64 bit finalizer of MurmurHash3
+   inline unsigned long long bloom_mix(unsigned long long h)
+   {
+      h ^= h >> 33;
+      h *= 0xff51afd7ed558ccdull;
+      h ^= h >> 33;
+      h *= 0xc4ceb9fe1a85ec53ull;
+      h ^= h >> 33;
+      return h;
+   }
+   // x in [0, n)
+   inline ttl::size_t bloom_reduce(unsigned x, ttl::size_t n)
+   {
+      return (ttl::size_t)((unsigned long long)x * n >> 32);
+   }
+
+   template<ttl::size_t Bits, unsigned K = 7, typename Key = ttl::size_t, class Hash = hash<Key> >
+   class bloom_filter: private Hash
+   {
+   public:
+      typedef Key key_type;
+      typedef Hash hasher;
+
+   private:
+      enum { batch = 16 };
+      bitset<Bits> bits_;
+
+      unsigned long long hash_of(const Key &key) const { return bloom_mix(Hash::operator()(key)); }
+      // the bit i of the key, in [0, Bits)
+      static ttl::size_t bit(unsigned long long h, unsigned i)
+      {
+         const unsigned h1 = (unsigned)h, h2 = (unsigned)(h >> 32) | 1;
+         return bloom_reduce(h1 + i * h2, Bits);
+      }
+      bool test(unsigned long long h) const
+      {
+         for (unsigned i = 0; i < K; ++i)
+            if (!bits_.test(bit(h, i)))
+               return false;
+         return true;
+      }
+
+   public:
+      explicit bloom_filter(const Hash &h = Hash()): Hash(h) {}
+
+      hasher hash_function() const { return *this; }
+      ttl::size_t size() const { return Bits; }
+      // the bits set, for the fill ratio
+      ttl::size_t count() const { return bits_.count(); }
+      void clear() { bits_.reset(); }
+
+      void insert(const Key &key)
+      {
+         const unsigned long long h = hash_of(key);
+         for (unsigned i = 0; i < K; ++i)
+            bits_.set(bit(h, i));
+      }
+      template<class InputIt>
+      void insert(InputIt first, InputIt last)
+      {
+         for (; first != last; ++first)
+            insert(*first);
+      }
+
+      // false if the key was surely not inserted
+      bool might_contain(const Key &key) const { return test(hash_of(key)); }
+      // *out++ = might_contain(key) for each key; the number of true ones
+      template<class InputIt, class OutputIt>
+      ttl::size_t might_contain(InputIt first, InputIt last, OutputIt out) const;
+
+      bloom_filter &operator|=(const bloom_filter &other) { bits_ |= other.bits_; return *this; }
+   };
+
+   template<ttl::size_t Bits, unsigned K, typename Key, class Hash>
+   template<class InputIt, class OutputIt>
+   ttl::size_t bloom_filter<Bits, K, Key, Hash>::might_contain(InputIt first, InputIt last, OutputIt out) const
+   {
+      const ttl::size_t bpw = sizeof(typename bitset<Bits>::slot_type) * CHAR_BIT;
+      unsigned long long h[batch];
+      ttl::size_t n = 0;
+      while (first != last)
+      {
+         unsigned b = 0;
+         for (; b < batch && first != last; ++b, ++first)
+         {
+            h[b] = hash_of(*first);
+            // most keys not in the set miss on the first bits: prefetching
+            // all K lines costs more than it saves
+            TTL_BLOOM_PREFETCH(bits_.data() + bit(h[b], 0) / bpw);
+            TTL_BLOOM_PREFETCH(bits_.data() + bit(h[b], 1) / bpw);
+         }
+         for (unsigned i = 0; i < b; ++i)
+         {
+            const bool maybe = test(h[i]);
+            n += maybe;
+            *out++ = maybe;
+         }
+      }
+      return n;
+   }
+
+   template<ttl::size_t Bits, unsigned K = 7, typename Key = ttl::size_t, class Hash = hash<Key> >
+   class blocked_bloom_filter: private Hash
+   {
+   public:
+      typedef Key key_type;
+      typedef Hash hasher;
+
+   private:
+      enum { block_bits = 512, blocks = (Bits + block_bits - 1) / block_bits, batch = 16 };
+      typedef typename bitset<blocks * block_bits>::slot_type slot_type;
+      static const unsigned BPW = sizeof(slot_type) * CHAR_BIT;
+
+      bitset<blocks * block_bits> bits_ TTL_BLOOM_ALIGNED;
+
+      unsigned long long hash_of(const Key &key) const { return bloom_mix(Hash::operator()(key)); }
+      // the words of the block of the key: the high half of the hash picks
+      // it, the low half the bits in it
+      static ttl::size_t first_slot(unsigned long long h)
+      {
+         return bloom_reduce((unsigned)(h >> 32), blocks) * (block_bits / BPW);
+      }
+      const slot_type *block(unsigned long long h) const { return bits_.data() + first_slot(h); }
+      slot_type *block(unsigned long long h) { return bits_.data() + first_slot(h); }
+      // the bit i in the block, in [0, 512); the step is the low half
+      // multiplied, to be apart from the bits which picked the block
+      static unsigned bit(unsigned long long h, unsigned i)
+      {
+         const unsigned h1 = (unsigned)h, h2 = (unsigned)((h & 0xffffffffu) * 0x9e3779b97f4a7c15ull >> 32) | 1;
+         return (h1 + i * h2) >> (32 - 9);
+      }
+      static bool test(const slot_type *w, unsigned long long h)
+      {
+         for (unsigned i = 0; i < K; ++i)
+         {
+            const unsigned b = bit(h, i);
+            if (!(w[b / BPW] & 1ul << b % BPW))
+               return false;
+         }
+         return true;
+      }
+
+   public:
+      explicit blocked_bloom_filter(const Hash &h = Hash()): Hash(h) {}
+
+      hasher hash_function() const { return *this; }
+      // rounded up to whole blocks
+      ttl::size_t size() const { return blocks * block_bits; }
+      ttl::size_t count() const { return bits_.count(); }
+      void clear() { bits_.reset(); }
+
+      void insert(const Key &key)
+      {
+         const unsigned long long h = hash_of(key);
+         slot_type *w = block(h);
+         for (unsigned i = 0; i < K; ++i)
+         {
+            const unsigned b = bit(h, i);
+            w[b / BPW] |= 1ul << b % BPW;
+         }
+      }
+      template<class InputIt>
+      void insert(InputIt first, InputIt last)
+      {
+         for (; first != last; ++first)
+            insert(*first);
+      }
+
+      bool might_contain(const Key &key) const
+      {
+         const unsigned long long h = hash_of(key);
+         return test(block(h), h);
+      }
+      template<class InputIt, class OutputIt>
+      ttl::size_t might_contain(InputIt first, InputIt last, OutputIt out) const;
+
+      blocked_bloom_filter &operator|=(const blocked_bloom_filter &other) { bits_ |= other.bits_; return *this; }
+   };
+
+   template<ttl::size_t Bits, unsigned K, typename Key, class Hash>
+   template<class InputIt, class OutputIt>
+   ttl::size_t blocked_bloom_filter<Bits, K, Key, Hash>::might_contain(InputIt first, InputIt last, OutputIt out) const
+   {
+      unsigned long long h[batch];
+      const slot_type *w[batch];
+      ttl::size_t n = 0;
+      while (first != last)
+      {
+         unsigned b = 0;
+         for (; b < batch && first != last; ++b, ++first)
+         {
+            h[b] = hash_of(*first);
+            w[b] = block(h[b]);
+            TTL_BLOOM_PREFETCH(w[b]);
+         }
+         for (unsigned i = 0; i < b; ++i)
+         {
+            const bool maybe = test(w[i], h[i]);
+            n += maybe;
+            *out++ = maybe;
+         }
+      }
+      return n;
+   }
+}
+
+#undef TTL_BLOOM_PREFETCH
+#undef TTL_BLOOM_ALIGNED
+
+#endif // _TINY_TEMPLATE_LIBRARY_BLOOM_FILTER_HPP_
@@ -0,0 +1,305 @@
+/////////////////////////////////////////////////// vim: sw=3 ts=8 et
+//
+// Tiny Template Library: an implementation of STL deque
+//
+// The elements are kept in blocks of B elements, and the blocks in a map
+// of block pointers. The elements never move, so the references to them
+// remain valid when elements are added or removed at the ends. The
+// emptied blocks are kept for reuse, until clean() deallocates them.
+//
+// This code is Public Domain
+//
+#ifndef _TINY_TEMPLATE_LIBRARY_DEQUE_HPP_
+#define _TINY_TEMPLATE_LIBRARY_DEQUE_HPP_ 1
+
+#include <new>
+#include <string.h>
+#include "types.hpp"
+#include "allocator.hpp"
+
+namespace ttl
+{
+   template<typename T> void swap(T &, T &);
+   template<class InputIt1, class InputIt2> bool equal(InputIt1, InputIt1, InputIt2, InputIt2);
+
+   template<typename T, const unsigned int B = (sizeof(T) <= 256 ? 4096 / sizeof(T): 16), typename Allocator = allocator>
+   class deque: private Allocator // empty allocators take no space
+   {
+   public:
+      typedef T              value_type;
+      typedef T             *pointer;
+      typedef const T       *const_pointer;
+      typedef T             &reference;
+      typedef const T       &const_reference;
+      typedef ttl::size_t    size_type;
+      typedef ttl::ptrdiff_t difference_type;
+
+      struct const_iterator;
+
+      struct iterator
+      {
+         typedef deque<T,B,Allocator>::value_type value_type;
+         typedef ttl::ptrdiff_t difference_type;
+         typedef T *pointer;
+         typedef T &reference;
+
+         iterator(): map_(0), i_(0) {}
+
+         T &operator*() const { return map_[i_ / B][i_ % B]; }
+         T *operator->() const { return &**this; }
+         T &operator[](difference_type n) const { return *(*this + n); }
+
+         iterator &operator++() { ++i_; return *this; }
+         iterator operator++(int) { iterator t(*this); ++i_; return t; }
+         iterator &operator--() { --i_; return *this; }
+         iterator operator--(int) { iterator t(*this); --i_; return t; }
+         iterator &operator+=(difference_type n) { i_ += n; return *this; }
+         iterator &operator-=(difference_type n) { i_ -= n; return *this; }
+         iterator operator+(difference_type n) const { return iterator(map_, i_ + n); }
+         iterator operator-(difference_type n) const { return iterator(map_, i_ - n); }
+         difference_type operator-(const iterator &o) const { return difference_type(i_ - o.i_); }
+
+         bool operator==(const iterator &o) const { return i_ == o.i_; }
+         bool operator!=(const iterator &o) const { return i_ != o.i_; }
+         bool operator<(const iterator &o) const { return i_ < o.i_; }
+         bool operator>(const iterator &o) const { return i_ > o.i_; }
+         bool operator<=(const iterator &o) const { return i_ <= o.i_; }
+         bool operator>=(const iterator &o) const { return i_ >= o.i_; }
+      private:
+         friend class deque<T,B,Allocator>;
+         friend struct deque<T,B,Allocator>::const_iterator;
+         T **map_;
+         size_type i_; // the index of the element in the map
+         iterator(T **map, size_type i): map_(map), i_(i) {}
+      };
+
+      struct const_iterator
+      {
+         typedef deque<T,B,Allocator>::value_type value_type;
+         typedef ttl::ptrdiff_t difference_type;
+         typedef const T *pointer;
+         typedef const T &reference;
+
+         const_iterator(): map_(0), i_(0) {}
+         const_iterator(const iterator &o): map_(o.map_), i_(o.i_) {}
+
+         const T &operator*() const { return map_[i_ / B][i_ % B]; }
+         const T *operator->() const { return &**this; }
+         const T &operator[](difference_type n) const { return *(*this + n); }
+
+         const_iterator &operator++() { ++i_; return *this; }
+         const_iterator operator++(int) { const_iterator t(*this); ++i_; return t; }
+         const_iterator &operator--() { --i_; return *this; }
+         const_iterator operator--(int) { const_iterator t(*this); --i_; return t; }
+         const_iterator &operator+=(difference_type n) { i_ += n; return *this; }
+         const_iterator &operator-=(difference_type n) { i_ -= n; return *this; }
+         const_iterator operator+(difference_type n) const { return const_iterator(map_, i_ + n); }
+         const_iterator operator-(difference_type n) const { return const_iterator(map_, i_ - n); }
+         difference_type operator-(const const_iterator &o) const { return difference_type(i_ - o.i_); }
+
+         bool operator==(const const_iterator &o) const { return i_ == o.i_; }
+         bool operator!=(const const_iterator &o) const { return i_ != o.i_; }
+         bool operator<(const const_iterator &o) const { return i_ < o.i_; }
+         bool operator>(const const_iterator &o) const { return i_ > o.i_; }
+         bool operator<=(const const_iterator &o) const { return i_ <= o.i_; }
+         bool operator>=(const const_iterator &o) const { return i_ >= o.i_; }
+      private:
+         friend class deque<T,B,Allocator>;
+         T *const *map_;
+         size_type i_;
+         const_iterator(T *const *map, size_type i): map_(map), i_(i) {}
+      };
+
+   private:
+      T **map_;
+      size_type map_size_; // in blocks
+      size_type start_;    // the index of the first element in the map
+      size_type size_;
+      void *spare_;        // the list of the emptied blocks
+
+      T &element(size_type i) const { return map_[i / B][i % B]; }
+      static size_type block_bytes() { return B * sizeof(T) < sizeof(void *) ? sizeof(void *): B * sizeof(T); }
+      T *allocate_block()
+      {
+         if (spare_)
+         {
+            void *b = spare_;
+            spare_ = *static_cast<void **>(b);
+            return static_cast<T *>(b);
+         }
+         return static_cast<T *>(Allocator::allocate(block_bytes()));
+      }
+      void release_block(size_type block)
+      {
+         *reinterpret_cast<void **>(map_[block]) = spare_;
+         spare_ = map_[block];
+         map_[block] = 0;
+      }
+      void grow_map();
+
+   public:
+      deque(): map_(0), map_size_(0), start_(0), size_(0), spare_(0) {}
+      explicit deque(const Allocator &a): Allocator(a), map_(0), map_size_(0), start_(0), size_(0), spare_(0) {}
+      deque(const deque &other);
+      template<typename InputIterator>
+      deque(InputIterator first, InputIterator last): map_(0), map_size_(0), start_(0), size_(0), spare_(0)
+      {
+         for (; first != last; ++first)
+            push_back(*first);
+      }
+      ~deque()
+      {
+         clear();
+         clean();
+         if (map_)
+            Allocator::deallocate(map_, map_size_ * sizeof(T *));
+      }
+
+      Allocator &get_allocator() { return *this; }
+      const Allocator &get_allocator() const { return *this; }
+
+      deque &operator=(const deque &other);
+
+      iterator       begin() { return iterator(map_, start_); }
+      const_iterator begin() const { return const_iterator(map_, start_); }
+      iterator       end() { return iterator(map_, start_ + size_); }
+      const_iterator end() const { return const_iterator(map_, start_ + size_); }
+      const_iterator cbegin() const { return begin(); }
+      const_iterator cend() const { return end(); }
+
+      size_type size() const { return size_; }
+      bool empty() const { return !size_; }
+      size_type max_size() const { return (ttl::size_t)-1 / sizeof(T); }
+
+      reference operator[](size_type n) { return element(start_ + n); }
+      const_reference operator[](size_type n) const { return element(start_ + n); }
+      reference at(size_type n) { return (*this)[n]; }
+      const_reference at(size_type n) const { return (*this)[n]; }
+      reference front() { return element(start_); }
+      const_reference front() const { return element(start_); }
+      reference back() { return element(start_ + size_ - 1); }
+      const_reference back() const { return element(start_ + size_ - 1); }
+
+      void push_back(const value_type &x)
+      {
+         size_type i = start_ + size_;
+         if (i == map_size_ * B)
+            grow_map(), i = start_ + size_;
+         if (!map_[i / B])
+            map_[i / B] = allocate_block();
+         ::new(&element(i)) T(x);
+         ++size_;
+      }
+      void push_front(const value_type &x)
+      {
+         if (!start_)
+            grow_map();
+         size_type i = start_ - 1;
+         if (!map_[i / B])
+            map_[i / B] = allocate_block();
+         ::new(&element(i)) T(x);
+         start_ = i;
+         ++size_;
+      }
+      void pop_back()
+      {
+         size_type i = start_ + --size_;
+         element(i).~T();
+         if (!size_ || !(i % B))
+            release_block(i / B);
+      }
+      void pop_front()
+      {
+         size_type i = start_++;
+         element(i).~T();
+         if (!--size_ || !(start_ % B))
+            release_block(i / B);
+      }
+
+      void clear()
+      {
+         while (size_)
+            pop_back();
+      }
+      // deallocate the blocks kept for reuse
+      void clean()
+      {
+         while (spare_)
+         {
+            void *b = spare_;
+            spare_ = *static_cast<void **>(b);
+            Allocator::deallocate(b, block_bytes());
+         }
+      }
+
+      void swap(deque &other)
+      {
+         ttl::swap(map_, other.map_);
+         ttl::swap(map_size_, other.map_size_);
+         ttl::swap(start_, other.start_);
+         ttl::swap(size_, other.size_);
+         ttl::swap(spare_, other.spare_);
+         ttl::swap(static_cast<Allocator &>(*this), static_cast<Allocator &>(other));
+      }
+   };
+
+   // Make room for a block at both ends of the map: center the used blocks,
+   // in a map twice as large if they take more than a half of it.
+   template<typename T, const unsigned int B, typename Allocator>
+   void deque<T,B,Allocator>::grow_map()
+   {
+      size_type first = start_ / B;
+      size_type used = size_ ? (start_ + size_ - 1) / B + 1 - first: 0;
+      size_type new_size = map_size_;
+      T **map = map_;
+      if (used + 2 > map_size_ / 2)
+      {
+         new_size = map_size_ ? map_size_ * 2: 8;
+         map = static_cast<T **>(Allocator::allocate(new_size * sizeof(T *)));
+      }
+      size_type new_first = (new_size - used) / 2;
+      if (used)
+         memmove(map + new_first, map_ + first, used * sizeof(T *));
+      if (map != map_ && map_)
+         Allocator::deallocate(map_, map_size_ * sizeof(T *));
+      for (size_type b = 0; b < new_first; ++b)
+         map[b] = 0;
+      for (size_type b = new_first + used; b < new_size; ++b)
+         map[b] = 0;
+      start_ = new_first * B + (size_ ? start_ % B: B / 2);
+      map_ = map;
+      map_size_ = new_size;
+   }
+
+   template<typename T, const unsigned int B, typename Allocator>
+   deque<T,B,Allocator>::deque(const deque &other): Allocator(other), map_(0), map_size_(0), start_(0), size_(0), spare_(0)
+   {
+      for (const_iterator i = other.begin(); i != other.end(); ++i)
+         push_back(*i);
+   }
+
+   template<typename T, const unsigned int B, typename Allocator>
+   deque<T,B,Allocator> &deque<T,B,Allocator>::operator=(const deque &other)
+   {
+      if (this != &other)
+      {
+         clear();
+         for (const_iterator i = other.begin(); i != other.end(); ++i)
+            push_back(*i);
+      }
+      return *this;
+   }
+
+   template<typename T, const unsigned int B, typename Allocator>
+   inline bool operator==(const deque<T,B,Allocator> &a, const deque<T,B,Allocator> &b)
+   {
+      return ttl::equal(a.begin(), a.end(), b.begin(), b.end());
+   }
+   template<typename T, const unsigned int B, typename Allocator>
+   inline bool operator!=(const deque<T,B,Allocator> &a, const deque<T,B,Allocator> &b)
+   {
+      return !(a == b);
+   }
+}
+
+#endif // _TINY_TEMPLATE_LIBRARY_DEQUE_HPP_
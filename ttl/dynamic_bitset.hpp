@@ -0,0 +1,359 @@
+/////////////////////////////////////////////////// vim: sw=3 ts=8 et
+//
+// Tiny Template Library: a bitset with its size set at run time
+//
+// dynamic_bitset has the word operations of bitset on a number of bits
+// given at run time, and grows with resize() and push_back(). Up to
+// InlineSlots words are kept in place, so short sets do not allocate.
+// The binary operations take sets of the same size.
+//
+// This code is Public Domain
+//
+#ifndef _TINY_TEMPLATE_LIBRARY_DYNAMIC_BITSET_HPP_
+#define _TINY_TEMPLATE_LIBRARY_DYNAMIC_BITSET_HPP_ 1
+
+#include <limits.h>
+#include "types.hpp"
+#include "allocator.hpp"
+#include "bits.hpp"
+
+namespace ttl
+{
+   template<typename T> void swap(T &, T &);
+
+   template<unsigned InlineSlots = 2, typename Allocator = allocator>
+   class dynamic_bitset: private Allocator // empty allocators take no space
+   {
+   public:
+      typedef unsigned long slot_type;
+      typedef ttl::size_t   size_type;
+
+   private:
+      static const size_type BPW = sizeof(slot_type) * CHAR_BIT;
+
+      // the bits past size() in the last word are kept zero
+      slot_type *slots_;
+      size_type size_, capacity_; // in bits, in words
+      slot_type inline_[InlineSlots ? InlineSlots: 1];
+
+      static size_type slots_for(size_type bits) { return (bits + BPW - 1) / BPW; }
+      slot_type last_bits() const { return size_ % BPW ? (1lu << size_ % BPW) - 1lu: (slot_type)-1; }
+      void trim()
+      {
+         if (size_ % BPW)
+            slots_[size_ / BPW] &= last_bits();
+      }
+      void release()
+      {
+         if (slots_ != inline_)
+            Allocator::deallocate(slots_, capacity_ * sizeof(slot_type));
+      }
+      void reserve_slots(size_type n);
+
+   public:
+      dynamic_bitset(): slots_(inline_), size_(0), capacity_(InlineSlots) {}
+      explicit dynamic_bitset(const Allocator &a): Allocator(a), slots_(inline_), size_(0), capacity_(InlineSlots) {}
+      explicit dynamic_bitset(size_type n, bool value = false):
+         slots_(inline_), size_(0), capacity_(InlineSlots)
+      {
+         resize(n, value);
+      }
+      dynamic_bitset(size_type n, bool value, const Allocator &a):
+         Allocator(a), slots_(inline_), size_(0), capacity_(InlineSlots)
+      {
+         resize(n, value);
+      }
+      dynamic_bitset(const dynamic_bitset &other):
+         Allocator(other), slots_(inline_), size_(0), capacity_(InlineSlots)
+      {
+         operator=(other);
+      }
+      ~dynamic_bitset() { release(); }
+
+      dynamic_bitset &operator=(const dynamic_bitset &other);
+
+      Allocator &get_allocator() { return *this; }
+      const Allocator &get_allocator() const { return *this; }
+
+      struct reference
+      {
+      private:
+         friend class dynamic_bitset;
+         reference(slot_type *bits, slot_type mask): bits_(bits), mask_(mask) {}
+         slot_type *bits_;
+         slot_type mask_;
+      public:
+         reference& operator=(bool v)
+         {
+            *bits_ = (*bits_ & ~mask_) | (-(slot_type)v & mask_);
+            return *this;
+         }
+         reference& operator=(const reference &other) { return operator=(other.operator bool()); }
+         operator bool() const { return (*bits_ & mask_) != 0; }
+         bool operator~() const { return (*bits_ & mask_) == 0; }
+         reference &flip() { *bits_ ^= mask_; return *this; }
+      };
+
+      size_type size() const { return size_; }
+      bool empty() const { return !size_; }
+      // the bits the set holds without allocating
+      size_type capacity() const { return capacity_ * BPW; }
+      static size_type inline_capacity() { return InlineSlots * BPW; }
+      bool is_inline() const { return slots_ == inline_; }
+
+      void reserve(size_type n) { reserve_slots(slots_for(n)); }
+      // the added bits are set to value
+      void resize(size_type n, bool value = false);
+      void push_back(bool value)
+      {
+         if (size_ == capacity_ * BPW)
+            reserve_slots(capacity_ ? capacity_ * 2: 1);
+         if (size_ % BPW == 0)
+            slots_[size_ / BPW] = 0;
+         ++size_;
+         set(size_ - 1, value);
+      }
+      void pop_back()
+      {
+         --size_;
+         trim();
+      }
+      void clear() { size_ = 0; }
+
+      // the words of the set, the bit i being the bit i % (bits of a word)
+      // of the word i / (bits of a word)
+      size_type slots() const { return slots_for(size_); }
+      slot_type slot(size_type s) const { return slots_[s]; }
+      const slot_type *data() const { return slots_; }
+
+      bool operator[](size_type pos) const { return test(pos); }
+      reference operator[](size_type pos) { return reference(slots_ + pos / BPW, 1lu << pos % BPW); }
+      bool test(size_type pos) const
+      {
+         return pos < size_ && (slots_[pos / BPW] & (1lu << pos % BPW));
+      }
+
+      dynamic_bitset &set();
+      dynamic_bitset &set(size_type pos)
+      {
+         slots_[pos / BPW] |= 1lu << pos % BPW;
+         return *this;
+      }
+      dynamic_bitset &set(size_type pos, bool value)
+      {
+         const slot_type mask = 1lu << pos % BPW;
+         slots_[pos / BPW] = (slots_[pos / BPW] & ~mask) | (-(slot_type)value & mask);
+         return *this;
+      }
+      dynamic_bitset &reset()
+      {
+         for (size_type i = 0, n = slots(); i < n; ++i)
+            slots_[i] = 0;
+         return *this;
+      }
+      dynamic_bitset &reset(size_type pos)
+      {
+         slots_[pos / BPW] &= ~(1lu << pos % BPW);
+         return *this;
+      }
+      dynamic_bitset &flip();
+      dynamic_bitset &flip(size_type pos)
+      {
+         slots_[pos / BPW] ^= 1lu << pos % BPW;
+         return *this;
+      }
+
+      bool all() const;
+      bool any() const;
+      bool none() const { return !any(); }
+      size_type count() const { return bits_count(slots_, slots()); } // count set bits
+
+      // the scans of the set bits return size() when there is none
+      size_type find_first() const { return bits_find_next(slots_, size_, 0); }
+      size_type find_next(size_type pos) const { return bits_find_next(slots_, size_, pos + 1); }
+      size_type find_last() const { return bits_find_last(slots_, size_); }
+      // calls f(pos) for each set bit, in order
+      template<class UnaryFunction>
+      UnaryFunction for_each_set(UnaryFunction f) const { return bits_for_each(slots_, size_, f); }
+
+      bool operator==(const dynamic_bitset &other) const;
+      bool operator!=(const dynamic_bitset &other) const { return !operator==(other); }
+
+      dynamic_bitset &operator&=(const dynamic_bitset &other);
+      dynamic_bitset &operator|=(const dynamic_bitset &other);
+      dynamic_bitset &operator^=(const dynamic_bitset &other);
+      dynamic_bitset operator~() const { return dynamic_bitset(*this).flip(); }
+
+      dynamic_bitset operator<<(size_type pos) const { return dynamic_bitset(*this) <<= pos; }
+      dynamic_bitset &operator<<=(size_type pos)
+      {
+         bits_shift_up(slots_, slots(), pos);
+         trim();
+         return *this;
+      }
+      dynamic_bitset operator>>(size_type pos) const { return dynamic_bitset(*this) >>= pos; }
+      dynamic_bitset &operator>>=(size_type pos)
+      {
+         bits_shift_down(slots_, slots(), pos);
+         return *this;
+      }
+
+      void swap(dynamic_bitset &other);
+   };
+
+   template<unsigned InlineSlots, typename Allocator>
+   void dynamic_bitset<InlineSlots,Allocator>::reserve_slots(size_type n)
+   {
+      if (n <= capacity_)
+         return;
+      slot_type *slots = static_cast<slot_type *>(Allocator::allocate(n * sizeof(slot_type)));
+      for (size_type i = 0, m = this->slots(); i < m; ++i)
+         slots[i] = slots_[i];
+      release();
+      slots_ = slots;
+      capacity_ = n;
+   }
+   template<unsigned InlineSlots, typename Allocator>
+   dynamic_bitset<InlineSlots,Allocator> &dynamic_bitset<InlineSlots,Allocator>::operator=(const dynamic_bitset &other)
+   {
+      if (this != &other)
+      {
+         size_ = 0;
+         reserve(other.size_);
+         for (size_type i = 0, n = other.slots(); i < n; ++i)
+            slots_[i] = other.slots_[i];
+         size_ = other.size_;
+      }
+      return *this;
+   }
+   template<unsigned InlineSlots, typename Allocator>
+   void dynamic_bitset<InlineSlots,Allocator>::resize(size_type n, bool value)
+   {
+      if (n > size_)
+      {
+         reserve(n);
+         const slot_type fill = value ? (slot_type)-1: 0;
+         size_type i = size_ / BPW;
+         if (size_ % BPW)
+            slots_[i++] |= fill & ~last_bits();
+         for (const size_type e = slots_for(n); i < e; ++i)
+            slots_[i] = fill;
+      }
+      size_ = n;
+      trim();
+   }
+   template<unsigned InlineSlots, typename Allocator>
+   dynamic_bitset<InlineSlots,Allocator> &dynamic_bitset<InlineSlots,Allocator>::set()
+   {
+      for (size_type i = 0, n = slots(); i < n; ++i)
+         slots_[i] = (slot_type)-1;
+      trim();
+      return *this;
+   }
+   template<unsigned InlineSlots, typename Allocator>
+   dynamic_bitset<InlineSlots,Allocator> &dynamic_bitset<InlineSlots,Allocator>::flip()
+   {
+      bits_not(slots_, slots_, slots());
+      trim();
+      return *this;
+   }
+   template<unsigned InlineSlots, typename Allocator>
+   bool dynamic_bitset<InlineSlots,Allocator>::all() const
+   {
+      if (!size_)
+         return false;
+      const size_type n = slots() - 1;
+      for (size_type i = 0; i < n; ++i)
+         if (slots_[i] != (slot_type)-1)
+            return false;
+      return slots_[n] == last_bits();
+   }
+   template<unsigned InlineSlots, typename Allocator>
+   bool dynamic_bitset<InlineSlots,Allocator>::any() const
+   {
+      for (size_type i = 0, n = slots(); i < n; ++i)
+         if (slots_[i])
+            return true;
+      return false;
+   }
+   template<unsigned InlineSlots, typename Allocator>
+   bool dynamic_bitset<InlineSlots,Allocator>::operator==(const dynamic_bitset &other) const
+   {
+      if (size_ != other.size_)
+         return false;
+      return bits_equal(slots_, other.slots_, slots());
+   }
+   template<unsigned InlineSlots, typename Allocator>
+   dynamic_bitset<InlineSlots,Allocator> &dynamic_bitset<InlineSlots,Allocator>::operator&=(const dynamic_bitset &other)
+   {
+      bits_and(slots_, other.slots_, slots());
+      return *this;
+   }
+   template<unsigned InlineSlots, typename Allocator>
+   dynamic_bitset<InlineSlots,Allocator> &dynamic_bitset<InlineSlots,Allocator>::operator|=(const dynamic_bitset &other)
+   {
+      bits_or(slots_, other.slots_, slots());
+      return *this;
+   }
+   template<unsigned InlineSlots, typename Allocator>
+   dynamic_bitset<InlineSlots,Allocator> &dynamic_bitset<InlineSlots,Allocator>::operator^=(const dynamic_bitset &other)
+   {
+      bits_xor(slots_, other.slots_, slots());
+      return *this;
+   }
+   template<unsigned InlineSlots, typename Allocator>
+   void dynamic_bitset<InlineSlots,Allocator>::swap(dynamic_bitset &other)
+   {
+      if (is_inline() || other.is_inline())
+      {
+         dynamic_bitset t(*this);
+         *this = other;
+         other = t;
+         return;
+      }
+      ttl::swap(slots_, other.slots_);
+      ttl::swap(size_, other.size_);
+      ttl::swap(capacity_, other.capacity_);
+      ttl::swap(get_allocator(), other.get_allocator());
+   }
+
+   // the number of bits set in both a and b, without the temporary of
+   // (a & b).count()
+   template<unsigned InlineSlots, typename Allocator>
+   inline ttl::size_t count_and(const dynamic_bitset<InlineSlots,Allocator> &a, const dynamic_bitset<InlineSlots,Allocator> &b)
+   {
+      return bits_count_and(a.data(), b.data(), a.slots());
+   }
+   // true if a bit is set in both a and b
+   template<unsigned InlineSlots, typename Allocator>
+   inline bool intersects(const dynamic_bitset<InlineSlots,Allocator> &a, const dynamic_bitset<InlineSlots,Allocator> &b)
+   {
+      return bits_intersects(a.data(), b.data(), a.slots());
+   }
+
+   template<unsigned InlineSlots, typename Allocator>
+   dynamic_bitset<InlineSlots,Allocator> operator&(const dynamic_bitset<InlineSlots,Allocator> &a,
+                                                   const dynamic_bitset<InlineSlots,Allocator> &b)
+   {
+      return dynamic_bitset<InlineSlots,Allocator>(a) &= b;
+   }
+   template<unsigned InlineSlots, typename Allocator>
+   dynamic_bitset<InlineSlots,Allocator> operator|(const dynamic_bitset<InlineSlots,Allocator> &a,
+                                                   const dynamic_bitset<InlineSlots,Allocator> &b)
+   {
+      return dynamic_bitset<InlineSlots,Allocator>(a) |= b;
+   }
+   template<unsigned InlineSlots, typename Allocator>
+   dynamic_bitset<InlineSlots,Allocator> operator^(const dynamic_bitset<InlineSlots,Allocator> &a,
+                                                   const dynamic_bitset<InlineSlots,Allocator> &b)
+   {
+      return dynamic_bitset<InlineSlots,Allocator>(a) ^= b;
+   }
+   template<unsigned InlineSlots, typename Allocator>
+   inline void swap(dynamic_bitset<InlineSlots,Allocator> &a, dynamic_bitset<InlineSlots,Allocator> &b)
+   {
+      a.swap(b);
+   }
+}
+
+#endif // _TINY_TEMPLATE_LIBRARY_DYNAMIC_BITSET_HPP_
@@ -9,7 +9,10 @@
 #define _TINY_TEMPLATE_LIBRARY_FIXED_VECTOR_HPP_ 1
 
 #include <new>
+#include <string.h>
 #include "types.hpp"
+#include "type_traits.hpp"
+#include "utility.hpp"
 
 namespace ttl
 {
@@ -34,11 +37,46 @@ namespace ttl
       typedef ttl::ptrdiff_t difference_type;
 
    private:
-      union { char b[sizeof(T)]; } bytes_[N];
+      storage_for<T> bytes_[N];
       T *last_;
       T *elements() const { return (T *)bytes_; }
       T *end_of_elements() const { return (T *)(bytes_ + N); }
 
+      // pointers to elements which can be copied with memcpy
+      template<typename It> struct is_memcpy_iterator: false_type {};
+      template<typename U> struct is_memcpy_iterator<U *>: integral_constant<bool,
+         is_same<typename remove_cv<U>::type, T>::value && is_trivially_copyable<T>::value> {};
+
+      template<typename InputIterator>
+      size_type append_range(InputIterator first, InputIterator last, integral_constant<bool, false>)
+      {
+         T *from = last_;
+         for (; first != last && !full(); ++first)
+            ::new(last_++) T(*first);
+         return last_ - from;
+      }
+      size_type append_range(const T *first, const T *last, integral_constant<bool, true>)
+      {
+         size_type n = last - first;
+         if (n > size_type(end_of_elements() - last_))
+            n = end_of_elements() - last_;
+         memcpy((void *)last_, first, n * sizeof(T));
+         last_ += n;
+         return n;
+      }
+      template<typename InputIterator>
+      size_type append_count(InputIterator first, size_type n, integral_constant<bool, false>)
+      {
+         T *from = last_;
+         for (; n-- && !full(); ++first)
+            ::new(last_++) T(*first);
+         return last_ - from;
+      }
+      size_type append_count(const T *first, size_type n, integral_constant<bool, true>)
+      {
+         return append_range(first, first + n, integral_constant<bool, true>());
+      }
+
    public:
       fixed_vector(): last_(elements()) {}
       explicit fixed_vector(size_type n);
@@ -113,6 +151,31 @@ namespace ttl
             new(last_++) T(x);
       }
 
+      // false if the vector is full
+      bool try_push_back(const value_type &x)
+      {
+         if (full())
+            return false;
+         new(last_++) T(x);
+         return true;
+      }
+
+      // Append as many elements as fit, return the number of the elements
+      // taken from the input. The trivially copyable elements in arrays are
+      // copied with one memcpy.
+      template<typename InputIterator>
+      size_type append(InputIterator first, InputIterator last)
+      {
+         typedef typename is_memcpy_iterator<InputIterator>::type memcpy_type;
+         return append_range(first, last, memcpy_type());
+      }
+      template<typename InputIterator>
+      size_type append_n(InputIterator first, size_type n)
+      {
+         typedef typename is_memcpy_iterator<InputIterator>::type memcpy_type;
+         return append_count(first, n, memcpy_type());
+      }
+
       void pop_back()
       {
          (--last_)->~T();
@@ -125,6 +188,22 @@ namespace ttl
          return erase(pos, pos + 1);
       }
 
+      // Erase by moving the last element in place of the erased one, O(1).
+      // Returns the iterator to the element which took the place.
+      iterator erase_unordered(const_iterator pos)
+      {
+         T *p = const_cast<T *>(pos);
+         ttl::destroy_at(p);
+         if (p != --last_)
+            ttl::relocate(p, last_);
+         return p;
+      }
+
+      // Erase all elements for which pred is true in one pass, keeping the
+      // order of the rest. Returns the number of the erased elements.
+      template<typename Predicate>
+      size_type erase_if(Predicate pred);
+
       void swap(fixed_vector& x);
 
       void clear()
@@ -259,6 +338,26 @@ namespace ttl
       return begin() + dist;
    }
 
+   template<typename T, const unsigned int N>
+   template<typename Predicate>
+   typename fixed_vector<T,N>::size_type fixed_vector<T,N>::erase_if(Predicate pred)
+   {
+      T *o = elements();
+      for (T *i = o; i != last_; ++i)
+         if (pred(*i))
+         {
+            if (!is_trivially_destructible<T>::value)
+               i->~T();
+         }
+         else if (o != i)
+            ttl::relocate(o++, i);
+         else
+            ++o;
+      size_type erased = last_ - o;
+      last_ = o;
+      return erased;
+   }
+
    template<typename T, const unsigned int N>
    typename fixed_vector<T,N>::iterator fixed_vector<T,N>::erase(const_iterator first, const_iterator last)
    {
@@ -7,13 +7,18 @@
 #ifndef _TINY_TEMPLATE_LIBRARY_FORWARD_LIST_HPP_
 #define _TINY_TEMPLATE_LIBRARY_FORWARD_LIST_HPP_ 1
 
+#include <new>
 #include "types.hpp"
+#include "allocator.hpp"
+#include "type_traits.hpp"
 #include "slist_node.hpp"
 
 namespace ttl
 {
-   template<typename T>
-   class forward_list
+   template<typename T> void swap(T &, T &);
+
+   template<typename T, typename Allocator = allocator>
+   class forward_list: private Allocator // empty allocators take no space
    {
    public:
       typedef T value_type;
@@ -32,6 +37,13 @@ namespace ttl
       };
       slist_node head_;
 
+      node *new_node(const T &v) { return ::new(Allocator::allocate(sizeof(node))) node(v); }
+      void delete_node(node *n)
+      {
+         n->~node();
+         Allocator::deallocate(n, sizeof(node));
+      }
+
    public:
       class const_iterator;
 
@@ -47,8 +59,8 @@ namespace ttl
          ~iterator() {}
          iterator &operator++() { head_ = head_->next; return *this; }
          iterator operator++(int) { iterator tmp(head_); head_ = head_->next; return tmp; }
-         reference operator*() const { return static_cast<forward_list<T>::node *>(head_)->value; }
-         pointer operator->() const { return &static_cast<forward_list<T>::node *>(head_)->value; }
+         reference operator*() const { return static_cast<forward_list<T,Allocator>::node *>(head_)->value; }
+         pointer operator->() const { return &static_cast<forward_list<T,Allocator>::node *>(head_)->value; }
 
          bool operator==(const iterator &other) const { return head_ == other.head_; }
          bool operator!=(const iterator &other) const { return head_ != other.head_; }
@@ -57,13 +69,13 @@ namespace ttl
 
       private:
          slist_node *head_;
-         friend class forward_list<T>;
+         friend class forward_list<T,Allocator>;
          iterator(slist_node *head): head_(head) {}
       };
       class const_iterator
       {
       public:
-         typedef forward_list<T>::iterator iterator;
+         typedef forward_list<T,Allocator>::iterator iterator;
          typedef T value_type;
          typedef const T *pointer;
          typedef const T &reference;
@@ -74,21 +86,22 @@ namespace ttl
          ~const_iterator() {}
          const_iterator &operator++() { head_ = head_->next; return *this; }
          const_iterator operator++(int) { const_iterator tmp(head_); head_ = head_->next; return tmp; }
-         reference operator*() const { return static_cast<const forward_list<T>::node *>(head_)->value; }
-         pointer operator->() const { return &static_cast<const forward_list<T>::node *>(head_)->value; }
+         reference operator*() const { return static_cast<const forward_list<T,Allocator>::node *>(head_)->value; }
+         pointer operator->() const { return &static_cast<const forward_list<T,Allocator>::node *>(head_)->value; }
 
          bool operator==(const const_iterator &other) const { return head_ == other.head_; }
          bool operator!=(const const_iterator &other) const { return head_ != other.head_; }
 
       private:
-         friend class forward_list<T>;
-         friend class forward_list<T>::iterator;
+         friend class forward_list<T,Allocator>;
+         friend class forward_list<T,Allocator>::iterator;
          const slist_node *head_;
          const_iterator(const slist_node *head): head_(head) {}
       };
 
       forward_list() { head_.next = 0; }
-      forward_list(const forward_list &other)
+      explicit forward_list(const Allocator &a): Allocator(a) { head_.next = 0; }
+      forward_list(const forward_list &other): Allocator(other)
       {
          head_.next = 0;
          insert_after(cbefore_begin(), other.cbegin(), other.cend());
@@ -113,6 +126,9 @@ namespace ttl
          return *this;
       }
 
+      Allocator &get_allocator() { return *this; }
+      const Allocator &get_allocator() const { return *this; }
+
       iterator before_begin() { return iterator(&head_); }
       iterator begin() { return iterator(head_.next); }
       iterator end() { return iterator(0); }
@@ -144,12 +160,12 @@ namespace ttl
 
       void push_front(const T &value)
       {
-         head_.insert_after(new node(value));
+         head_.insert_after(new_node(value));
       }
 
       void pop_front()
       {
-         delete static_cast<node *>(head_.unlink_next());
+         delete_node(static_cast<node *>(head_.unlink_next()));
       }
 
       void splice_after(const_iterator pos, forward_list &other)
@@ -168,7 +184,7 @@ namespace ttl
 
       iterator insert_after(const_iterator pos, const T &value)
       {
-         return iterator(const_cast<slist_node *>(pos.head_)->insert_after(new node(value)));
+         return iterator(const_cast<slist_node *>(pos.head_)->insert_after(new_node(value)));
       }
       void insert_after(const_iterator pos, size_type n, const T &value);
       template<typename InputIterator>
@@ -177,7 +193,7 @@ namespace ttl
       iterator erase_after(const_iterator pos)
       {
          slist_node *p = const_cast<slist_node *>(pos.head_);
-         delete static_cast<node *>(p->unlink_next());
+         delete_node(static_cast<node *>(p->unlink_next()));
          return iterator(p->next);
       }
       iterator erase_after(const_iterator pos, const_iterator last);
@@ -185,6 +201,7 @@ namespace ttl
       void swap(forward_list &other)
       {
          ttl::swap(head_.next, other.head_.next);
+         ttl::swap(static_cast<Allocator &>(*this), static_cast<Allocator &>(other));
       }
 
       void resize(size_type);
@@ -211,42 +228,44 @@ namespace ttl
 
       void reverse();
    };
-   template<typename T>
-   void forward_list<T>::insert_after(const_iterator pos, size_type n, const T &value)
+   template<typename T, typename Allocator>
+   void forward_list<T,Allocator>::insert_after(const_iterator pos, size_type n, const T &value)
    {
       slist_node *p = const_cast<slist_node *>(pos.head_);
       while (n--)
-         p = p->insert_after(new node(value));
+         p = p->insert_after(new_node(value));
    }
-   template<typename T>
+   template<typename T, typename Allocator>
    template<typename InputIterator>
-   void forward_list<T>::insert_after(const_iterator pos, InputIterator first, InputIterator last)
+   void forward_list<T,Allocator>::insert_after(const_iterator pos, InputIterator first, InputIterator last)
    {
       slist_node *p = const_cast<slist_node *>(pos.head_);
       for ( ; first != last; ++first)
-         p = p->insert_after(new node(*first));
+         p = p->insert_after(new_node(*first));
    }
-   template<typename T>
-   void forward_list<T>::clear()
+   template<typename T, typename Allocator>
+   void forward_list<T,Allocator>::clear()
    {
+      if (is_monotonic_allocator<Allocator>::value && is_trivially_destructible<T>::value)
+         head_.next = 0;
       while (head_.next)
-         delete static_cast<node *>(head_.unlink_next());
+         delete_node(static_cast<node *>(head_.unlink_next()));
    }
-   template<typename T>
-   typename forward_list<T>::iterator forward_list<T>::erase_after(const_iterator pos, const_iterator last)
+   template<typename T, typename Allocator>
+   typename forward_list<T,Allocator>::iterator forward_list<T,Allocator>::erase_after(const_iterator pos, const_iterator last)
    {
       slist_node *p = const_cast<slist_node *>(pos.head_);
       while (p->next != last.head_)
-         delete static_cast<node *>(p->unlink_next());
+         delete_node(static_cast<node *>(p->unlink_next()));
       return iterator(p->next);
    }
-   template<typename T>
-   void forward_list<T>::reverse()
+   template<typename T, typename Allocator>
+   void forward_list<T,Allocator>::reverse()
    {
       head_.reverse();
    }
-   template<typename T>
-   void forward_list<T>::splice_after(const_iterator pos, forward_list &, const_iterator first, const_iterator last)
+   template<typename T, typename Allocator>
+   void forward_list<T,Allocator>::splice_after(const_iterator pos, forward_list &, const_iterator first, const_iterator last)
    {
       slist_node *f = const_cast<slist_node *>(first.head_);
 
@@ -259,13 +278,13 @@ namespace ttl
    template<class InputIt1, class InputIt2>
    bool equal(InputIt1, InputIt1, InputIt2, InputIt2);
 
-   template <typename T>
-   bool operator==(const forward_list<T> &a, const forward_list<T> &b)
+   template<typename T, typename Allocator>
+   bool operator==(const forward_list<T,Allocator> &a, const forward_list<T,Allocator> &b)
    {
       return ttl::equal(a.begin(), a.end(), b.begin(), b.end());
    }
-   template <typename T>
-   bool operator!=(const forward_list<T> &a, const forward_list<T> &b)
+   template<typename T, typename Allocator>
+   bool operator!=(const forward_list<T,Allocator> &a, const forward_list<T,Allocator> &b)
    {
       return !(a == b);
    }
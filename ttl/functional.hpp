@@ -7,6 +7,8 @@
 #ifndef _TINY_TEMPLATE_LIBRARY_FUNCTIONAL_HPP_
 #define _TINY_TEMPLATE_LIBRARY_FUNCTIONAL_HPP_ 1
 
+#include "types.hpp"
+
 namespace ttl
 {
    template<typename T>
@@ -44,6 +46,24 @@ namespace ttl
       typedef bool result_type;
       bool operator()(const T &a, const T &b) const { return a != b; }
    };
+
+   // the value itself for the integers and the enums, as std::hash of the
+   // usual libraries: the users of a hash which need the bits mixed do it
+   template<typename T>
+   struct hash
+   {
+      typedef T argument_type;
+      typedef ttl::size_t result_type;
+      ttl::size_t operator()(const T &v) const { return (ttl::size_t)v; }
+   };
+
+   template<typename T>
+   struct hash<T *>
+   {
+      typedef T *argument_type;
+      typedef ttl::size_t result_type;
+      ttl::size_t operator()(T *p) const { return (ttl::size_t)p; }
+   };
 }
 
 #endif // _TINY_TEMPLATE_LIBRARY_FUNCTIONAL_HPP_
@@ -0,0 +1,209 @@
+/////////////////////////////////////////////////// vim: sw=3 ts=8 et
+//
+// Tiny Template Library: a bitset with summaries of its words, to find
+// a set or a clear bit in O(log64 N)
+//
+// Above the words of the bits are two trees of summary words: a bit of
+// the first is set when the word below it has a set bit, a bit of the
+// second when it has a clear bit. find_first_set() and find_first_clear()
+// go down one of them, a word per level; set() and reset() go up only as
+// far as a word changes between empty and not. bitset<1 << 20> takes 4
+// levels on 64 bit targets, and 3% more memory.
+//
+//    static ttl::hierarchical_bitset<65536> ids;
+//    ttl::size_t id = ids.find_first_clear(); // size() when all are taken
+//    ids.set(id);
+//    ...
+//    ids.reset(id);
+//
+// This code is Public Domain
+//
+#ifndef _TINY_TEMPLATE_LIBRARY_HIERARCHICAL_BITSET_HPP_
+#define _TINY_TEMPLATE_LIBRARY_HIERARCHICAL_BITSET_HPP_ 1
+
+#include <limits.h>
+#include "types.hpp"
+#include "bits.hpp"
+
+namespace ttl
+{
+   // which of Words words below are not empty, and the summaries above it
+   template<ttl::size_t Words>
+   struct hierarchical_bitset_summary
+   {
+      typedef unsigned long slot_type;
+      enum { BPW = sizeof(slot_type) * CHAR_BIT, slots = (Words + BPW - 1) / BPW };
+
+      slot_type w_[slots];
+      hierarchical_bitset_summary<slots> up_;
+
+      void clear()
+      {
+         for (ttl::size_t i = 0; i < slots; ++i)
+            w_[i] = 0;
+         up_.clear();
+      }
+      // the word i below became empty, or not
+      void update(ttl::size_t i, bool on)
+      {
+         slot_type &w = w_[i / BPW];
+         const bool was = w != 0;
+         if (on)
+            w |= 1ul << i % BPW;
+         else
+            w &= ~(1ul << i % BPW);
+         if (was != (w != 0))
+            up_.update(i / BPW, !was);
+      }
+      // the first word below which is not empty, Words when there is none
+      ttl::size_t first() const
+      {
+         const ttl::size_t s = up_.first();
+         return s < slots ? s * BPW + bits_lowest(w_[s]): Words;
+      }
+      // the same, at or after i
+      ttl::size_t next(ttl::size_t i) const
+      {
+         if (i >= Words)
+            return Words;
+         ttl::size_t s = i / BPW;
+         const slot_type w = w_[s] & ((slot_type)-1 << i % BPW);
+         if (w)
+            return s * BPW + bits_lowest(w);
+         s = up_.next(s + 1);
+         return s < slots ? s * BPW + bits_lowest(w_[s]): Words;
+      }
+   };
+
+   // the top: a single word below
+   template<>
+   struct hierarchical_bitset_summary<1>
+   {
+      bool on_;
+
+      void clear() { on_ = false; }
+      void update(ttl::size_t, bool on) { on_ = on; }
+      ttl::size_t first() const { return !on_; }
+      ttl::size_t next(ttl::size_t i) const { return i || !on_; }
+   };
+
+   template<ttl::size_t N>
+   class hierarchical_bitset
+   {
+   public:
+      typedef unsigned long slot_type;
+
+   private:
+      enum { BPW = sizeof(slot_type) * CHAR_BIT, slots = (N + BPW - 1) / BPW };
+
+      slot_type bits_[slots];
+      hierarchical_bitset_summary<slots> set_, clear_; // the words with a set bit, with a clear bit
+
+      static slot_type last_bits()
+      {
+         return N % BPW ? (1ul << N % BPW) - 1: (slot_type)-1;
+      }
+      static slot_type full(ttl::size_t s) { return s == slots - 1 ? last_bits(): (slot_type)-1; }
+      void update(ttl::size_t s)
+      {
+         set_.update(s, bits_[s] != 0);
+         clear_.update(s, bits_[s] != full(s));
+      }
+      void update_all()
+      {
+         set_.clear();
+         clear_.clear();
+         for (ttl::size_t s = 0; s < slots; ++s)
+            update(s);
+      }
+
+   public:
+      hierarchical_bitset() { reset(); }
+
+      ttl::size_t size() const { return N; }
+      slot_type slot(ttl::size_t s) const { return bits_[s]; }
+      const slot_type *data() const { return bits_; }
+
+      bool test(ttl::size_t pos) const
+      {
+         return pos < N && (bits_[pos / BPW] & 1ul << pos % BPW);
+      }
+      bool operator[](ttl::size_t pos) const { return test(pos); }
+
+      bool any() const { return set_.first() < slots; }
+      bool none() const { return !any(); }
+      bool all() const { return clear_.first() == slots; }
+      ttl::size_t count() const { return bits_count(bits_, slots); }
+
+      hierarchical_bitset &set()
+      {
+         for (ttl::size_t s = 0; s < slots; ++s)
+            bits_[s] = full(s);
+         update_all();
+         return *this;
+      }
+      hierarchical_bitset &set(ttl::size_t pos)
+      {
+         slot_type &w = bits_[pos / BPW];
+         const slot_type old = w;
+         w |= 1ul << pos % BPW;
+         if (old != w)
+            update(pos / BPW);
+         return *this;
+      }
+      hierarchical_bitset &set(ttl::size_t pos, bool value) { return value ? set(pos): reset(pos); }
+      hierarchical_bitset &reset()
+      {
+         for (ttl::size_t s = 0; s < slots; ++s)
+            bits_[s] = 0;
+         update_all();
+         return *this;
+      }
+      hierarchical_bitset &reset(ttl::size_t pos)
+      {
+         slot_type &w = bits_[pos / BPW];
+         const slot_type old = w;
+         w &= ~(1ul << pos % BPW);
+         if (old != w)
+            update(pos / BPW);
+         return *this;
+      }
+
+      // the scans return size() when there is no such bit
+      ttl::size_t find_first_set() const
+      {
+         const ttl::size_t s = set_.first();
+         return s < slots ? s * BPW + bits_lowest(bits_[s]): N;
+      }
+      ttl::size_t find_first_clear() const
+      {
+         const ttl::size_t s = clear_.first();
+         return s < slots ? s * BPW + bits_lowest((slot_type)~bits_[s]): N;
+      }
+      // the first set or clear bit after pos
+      ttl::size_t find_next_set(ttl::size_t pos) const
+      {
+         if (++pos >= N)
+            return N;
+         ttl::size_t s = pos / BPW;
+         const slot_type w = bits_[s] & ((slot_type)-1 << pos % BPW);
+         if (w)
+            return s * BPW + bits_lowest(w);
+         s = set_.next(s + 1);
+         return s < slots ? s * BPW + bits_lowest(bits_[s]): N;
+      }
+      ttl::size_t find_next_clear(ttl::size_t pos) const
+      {
+         if (++pos >= N)
+            return N;
+         ttl::size_t s = pos / BPW;
+         const slot_type w = ~bits_[s] & full(s) & ((slot_type)-1 << pos % BPW);
+         if (w)
+            return s * BPW + bits_lowest(w);
+         s = clear_.next(s + 1);
+         return s < slots ? s * BPW + bits_lowest((slot_type)~bits_[s]): N;
+      }
+   };
+}
+
+#endif // _TINY_TEMPLATE_LIBRARY_HIERARCHICAL_BITSET_HPP_
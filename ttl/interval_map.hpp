@@ -0,0 +1,339 @@
+/////////////////////////////////////////////////// vim: sw=3 ts=8 et
+//
+// Tiny Template Library: an interval map
+//
+// Maps half-open intervals [lo, hi) to values. The intervals are kept in
+// a left-leaning red-black tree ordered by lo, then by hi, and every node
+// keeps the greatest hi of its subtree. That allows to skip the subtrees
+// which cannot contain an overlapping interval, so that the intervals
+// overlapping a given one are visited in O(log N + k) (k*log N at worst).
+//
+// The rebalancing is that of rbtree_base, with an augmentation which
+// recomputes the subtree maximum of the nodes it moves.
+//
+// This code is Public Domain
+//
+#ifndef _TINY_TEMPLATE_LIBRARY_INTERVAL_MAP_HPP_
+#define _TINY_TEMPLATE_LIBRARY_INTERVAL_MAP_HPP_ 1
+
+#include "types.hpp"
+#include "functional.hpp"
+#include "utility.hpp"
+#include "rbtree.hpp"
+
+namespace ttl
+{
+   template<typename K, typename T, typename Compare = less<K>, typename Allocator = allocator>
+   class interval_map: public rbtree_base, private Allocator // unique intervals to values
+   {
+   public:
+      typedef K bound_type;
+      typedef pair<K, K> key_type; // [first, second)
+      typedef T mapped_type;
+      typedef pair<const key_type, T> value_type;
+      typedef ttl::size_t size_type;
+      typedef Compare bound_compare;
+
+      struct node: rbnode
+      {
+         value_type data;
+         K max; // the greatest upper bound in the subtree
+         node(const value_type &d): data(d), max(d.first.second) {}
+      };
+
+      struct const_iterator;
+
+      struct iterator
+      {
+      public:
+         typedef interval_map<K,T,Compare,Allocator>::value_type value_type;
+         typedef ttl::ptrdiff_t difference_type;
+         typedef value_type *pointer;
+         typedef value_type &reference;
+
+         value_type &operator*() const { return ptr_->data; }
+         value_type *operator->() const { return &ptr_->data; }
+         iterator &operator++()
+         {
+            ptr_ = static_cast<node *>(rbtree_base::next_node(ptr_));
+            return *this;
+         }
+         iterator operator++(int)
+         {
+            iterator tmp(*this);
+            ptr_ = static_cast<node *>(rbtree_base::next_node(ptr_));
+            return tmp;
+         }
+
+         bool operator==(const iterator &other) const { return ptr_ == other.ptr_; }
+         bool operator!=(const iterator &other) const { return ptr_ != other.ptr_; }
+      private:
+         node *ptr_;
+         friend class interval_map<K,T,Compare,Allocator>;
+         friend struct interval_map<K,T,Compare,Allocator>::const_iterator;
+         iterator(node *ptr): ptr_(ptr) {}
+      };
+      struct const_iterator
+      {
+      public:
+         typedef interval_map<K,T,Compare,Allocator>::value_type value_type;
+         typedef ttl::ptrdiff_t difference_type;
+         typedef const value_type *pointer;
+         typedef const value_type &reference;
+
+         const value_type &operator*() const { return ptr_->data; }
+         const value_type *operator->() const { return &ptr_->data; }
+         const_iterator &operator++()
+         {
+            ptr_ = static_cast<const node *>(rbtree_base::next_node(ptr_));
+            return *this;
+         }
+         const_iterator operator++(int)
+         {
+            const_iterator tmp(*this);
+            ptr_ = static_cast<const node *>(rbtree_base::next_node(ptr_));
+            return tmp;
+         }
+
+         bool operator==(const const_iterator &other) const { return ptr_ == other.ptr_; }
+         bool operator!=(const const_iterator &other) const { return ptr_ != other.ptr_; }
+
+         const_iterator(const iterator &other): ptr_(other.ptr_) {}
+      private:
+         const node *ptr_;
+         friend class interval_map<K,T,Compare,Allocator>;
+         const_iterator(const node *ptr): ptr_(ptr) {}
+      };
+
+      interval_map() {}
+      explicit interval_map(const Allocator &a): Allocator(a) {}
+      ~interval_map() { clear(); }
+
+      Allocator &get_allocator() { return *this; }
+      const Allocator &get_allocator() const { return *this; }
+
+      iterator begin()
+      {
+         return root_() ? iterator(static_cast<node *>(min_node(root_()))): end();
+      }
+      const_iterator begin() const
+      {
+         return root_() ? const_iterator(static_cast<const node *>(min_node(root_()))): end();
+      }
+      iterator end() { return iterator(static_cast<node *>(&header_)); }
+      const_iterator end() const { return const_iterator(static_cast<const node *>(&header_)); }
+
+      bool empty() const { return !root_(); }
+
+      pair<iterator,bool> insert(const value_type &value);
+      pair<iterator,bool> insert(const K &lo, const K &hi, const T &value)
+      {
+         return insert(value_type(key_type(lo, hi), value));
+      }
+
+      size_type erase(const K &lo, const K &hi)
+      {
+         node *n = remove(key_type(lo, hi));
+         if (n)
+            delete_node(n);
+         return !!n;
+      }
+      void erase(iterator pos)
+      {
+         delete_node(remove(pos->first));
+      }
+
+      void clear()
+      {
+         node *root = static_cast<node *>(root_());
+         *root_edge() = 0;
+         if (!(is_monotonic_allocator<Allocator>::value && is_trivially_destructible<value_type>::value))
+            postorder_destroy(root);
+      }
+
+      iterator find(const K &lo, const K &hi)
+      {
+         return iterator(const_cast<node *>(find_node(key_type(lo, hi))));
+      }
+      const_iterator find(const K &lo, const K &hi) const
+      {
+         return const_iterator(find_node(key_type(lo, hi)));
+      }
+
+      // true if any interval in the map overlaps [lo, hi), O(log N)
+      bool overlaps(const K &lo, const K &hi) const;
+
+      // call f(value_type &) for every interval overlapping [lo, hi), in order
+      template<class Visitor>
+      Visitor find_overlapping(const K &lo, const K &hi, Visitor f)
+      {
+         visit_overlapping(static_cast<node *>(root_()), lo, hi, f);
+         return f;
+      }
+      template<class Visitor>
+      Visitor find_overlapping(const K &lo, const K &hi, Visitor f) const
+      {
+         visit_overlapping(static_cast<const node *>(root_()), lo, hi, f);
+         return f;
+      }
+
+      node *get_root() { return static_cast<node *>(root_()); }
+      const node *get_root() const { return static_cast<const node *>(root_()); }
+
+   private:
+      Compare is_less_;
+
+      bool key_less(const key_type &a, const key_type &b) const
+      {
+         TTL_RBTREE_COUNT(comparisons);
+         return is_less_(a.first, b.first) ||
+            (!is_less_(b.first, a.first) && is_less_(a.second, b.second));
+      }
+      const node *find_node(const key_type &key) const;
+      node *remove(const key_type &key);
+      void postorder_destroy(node *n);
+      void delete_node(node *n)
+      {
+         n->~node();
+         Allocator::deallocate(n, sizeof(node));
+      }
+
+      template<class Node, class Visitor>
+      void visit_overlapping(Node *n, const K &lo, const K &hi, Visitor &f) const;
+
+      // the subtree maximum, for the rebalancing of rbtree_base
+      struct max_augment
+      {
+         const Compare *is_less;
+         void update(rbnode *n) const
+         {
+            node *x = static_cast<node *>(n);
+            x->max = x->data.first.second;
+            if (x->left && (*is_less)(x->max, static_cast<const node *>(x->left)->max))
+               x->max = static_cast<const node *>(x->left)->max;
+            if (x->right && (*is_less)(x->max, static_cast<const node *>(x->right)->max))
+               x->max = static_cast<const node *>(x->right)->max;
+         }
+      };
+      // the key of remove() against those of the nodes
+      struct key_probe
+      {
+         const interval_map *map;
+         const key_type *key;
+         bool less(const rbnode *n) const { return map->key_less(*key, static_cast<const node *>(n)->data.first); }
+         bool equal(const rbnode *n) const { return *key == static_cast<const node *>(n)->data.first; }
+      };
+      max_augment augment() const
+      {
+         const max_augment aug = { &is_less_ };
+         return aug;
+      }
+   };
+
+   template<typename K, typename T, typename Compare, typename Allocator>
+   void interval_map<K,T,Compare,Allocator>::postorder_destroy(node *n)
+   {
+      if (!n)
+         return;
+
+      if (n->left)
+         postorder_destroy(static_cast<node *>(n->left));
+      if (n->right)
+         postorder_destroy(static_cast<node *>(n->right));
+      delete_node(n);
+   }
+
+   template<typename K, typename T, typename Compare, typename Allocator>
+   const typename interval_map<K,T,Compare,Allocator>::node *
+   interval_map<K,T,Compare,Allocator>::find_node(const key_type &key) const
+   {
+      TTL_RBTREE_COUNT(lookups);
+      const rbnode *n = root_();
+      while (n)
+      {
+         const key_type &nkey = static_cast<const node *>(n)->data.first;
+         if (key_less(key, nkey))
+            n = n->left;
+         else if (key == nkey)
+            break;
+         else
+            n = n->right;
+      }
+      return static_cast<const node *>(n ? n: &header_);
+   }
+
+   template<typename K, typename T, typename Compare, typename Allocator>
+   pair<typename interval_map<K,T,Compare,Allocator>::iterator, bool>
+   interval_map<K,T,Compare,Allocator>::insert(const value_type &value)
+   {
+      TTL_RBTREE_COUNT(lookups);
+      const key_type &key = value.first;
+      rbnode *parent = &header_;
+      rbnode **edge = root_edge();
+      while (*edge)
+      {
+         node *n = static_cast<node *>(*edge);
+         if (key == n->data.first)
+            return pair<iterator,bool>(iterator(n), false);
+         // the new interval is going to be in the subtree of n
+         if (is_less_(n->max, key.second))
+            n->max = key.second;
+         parent = n;
+         edge = key_less(key, n->data.first) ? &n->left: &n->right;
+      }
+      node *newnode = ::new(Allocator::allocate(sizeof(node))) node(value);
+      TTL_RBTREE_COUNT(allocations);
+      newnode->parent = parent;
+      *edge = newnode;
+      insert_rebalance(edge, parent, augment());
+      return pair<iterator,bool>(iterator(newnode), true);
+   }
+
+   template<typename K, typename T, typename Compare, typename Allocator>
+   typename interval_map<K,T,Compare,Allocator>::node *
+   interval_map<K,T,Compare,Allocator>::remove(const key_type &key)
+   {
+      // the removed interval could have been the greatest in all the
+      // subtrees above it: remove_node updates them on the way up
+      const key_probe probe = { this, &key };
+      return static_cast<node *>(remove_node(probe, augment()));
+   }
+
+   template<typename K, typename T, typename Compare, typename Allocator>
+   bool interval_map<K,T,Compare,Allocator>::overlaps(const K &lo, const K &hi) const
+   {
+      const rbnode *n = root_();
+      while (n)
+      {
+         const node *x = static_cast<const node *>(n);
+         if (is_less_(x->data.first.first, hi) && is_less_(lo, x->data.first.second))
+            return true;
+         if (x->left && is_less_(lo, static_cast<const node *>(x->left)->max))
+            n = x->left;
+         else
+            n = x->right;
+      }
+      return false;
+   }
+
+   template<typename K, typename T, typename Compare, typename Allocator>
+   template<class Node, class Visitor>
+   void interval_map<K,T,Compare,Allocator>::visit_overlapping(Node *n, const K &lo, const K &hi, Visitor &f) const
+   {
+      while (n)
+      {
+         // nothing in the subtree ends after lo
+         if (!is_less_(lo, n->max))
+            return;
+         if (n->left)
+            visit_overlapping(static_cast<Node *>(n->left), lo, hi, f);
+         // n and everything to the right of it start at or after hi
+         if (!is_less_(n->data.first.first, hi))
+            return;
+         if (is_less_(lo, n->data.first.second))
+            f(n->data);
+         n = static_cast<Node *>(n->right);
+      }
+   }
+}
+#endif // _TINY_TEMPLATE_LIBRARY_INTERVAL_MAP_HPP_
@@ -14,14 +14,15 @@
 
 #include <new>
 #include "types.hpp"
+#include "allocator.hpp"
 #include "slist_node.hpp"
 
 namespace ttl
 {
    template<typename T> void swap(T &, T &);
 
-   template<typename T>
-   class lazy_queue
+   template<typename T, typename Allocator = allocator>
+   class lazy_queue: private Allocator // empty allocators take no space
    {
    public:
       typedef T value_type;
@@ -44,7 +45,7 @@ namespace ttl
 
       node *get_node(const T &v)
       {
-         node *n = static_cast<node *>(dead_.next ? dead_.unlink_next(): ::operator new(sizeof(node)));
+         node *n = static_cast<node *>(dead_.next ? dead_.unlink_next(): Allocator::allocate(sizeof(node)));
          ::new(&n->value) T(v);
          return n;
       }
@@ -69,8 +70,8 @@ namespace ttl
          ~iterator() {}
          iterator &operator++() { head_ = head_->next; return *this; }
          iterator operator++(int) { iterator tmp(head_); head_ = head_->next; return tmp; }
-         reference operator*() const { return static_cast<lazy_queue<T>::node *>(head_)->value; }
-         pointer operator->() const { return &static_cast<lazy_queue<T>::node *>(head_)->value; }
+         reference operator*() const { return static_cast<lazy_queue<T,Allocator>::node *>(head_)->value; }
+         pointer operator->() const { return &static_cast<lazy_queue<T,Allocator>::node *>(head_)->value; }
 
          bool operator==(const iterator &other) const { return head_ == other.head_; }
          bool operator!=(const iterator &other) const { return head_ != other.head_; }
@@ -79,13 +80,13 @@ namespace ttl
 
       private:
          slist_node *head_;
-         friend class lazy_queue<T>;
+         friend class lazy_queue<T,Allocator>;
          iterator(slist_node *head): head_(head) {}
       };
       class const_iterator
       {
       public:
-         typedef lazy_queue<T>::iterator iterator;
+         typedef lazy_queue<T,Allocator>::iterator iterator;
          typedef T value_type;
          typedef const T *pointer;
          typedef const T &reference;
@@ -96,15 +97,15 @@ namespace ttl
          ~const_iterator() {}
          const_iterator &operator++() { head_ = head_->next; return *this; }
          const_iterator operator++(int) { const_iterator tmp(head_); head_ = head_->next; return tmp; }
-         reference operator*() const { return static_cast<const lazy_queue<T>::node *>(head_)->value; }
-         pointer operator->() const { return &static_cast<const lazy_queue<T>::node *>(head_)->value; }
+         reference operator*() const { return static_cast<const lazy_queue<T,Allocator>::node *>(head_)->value; }
+         pointer operator->() const { return &static_cast<const lazy_queue<T,Allocator>::node *>(head_)->value; }
 
          bool operator==(const const_iterator &other) const { return head_ == other.head_; }
          bool operator!=(const const_iterator &other) const { return head_ != other.head_; }
 
       private:
-         friend class lazy_queue<T>;
-         friend class lazy_queue<T>::iterator;
+         friend class lazy_queue<T,Allocator>;
+         friend class lazy_queue<T,Allocator>::iterator;
          const slist_node *head_;
          const_iterator(const slist_node *head): head_(head) {}
       };
@@ -115,7 +116,13 @@ namespace ttl
          tail_ = &head_;
          dead_.next = 0;
       }
-      lazy_queue(const lazy_queue &other)
+      explicit lazy_queue(const Allocator &a): Allocator(a)
+      {
+         head_.next = 0;
+         tail_ = &head_;
+         dead_.next = 0;
+      }
+      lazy_queue(const lazy_queue &other): Allocator(other)
       {
          head_.next = 0;
          tail_ = &head_;
@@ -132,14 +139,18 @@ namespace ttl
       ~lazy_queue()
       {
          while (head_.next)
-            delete static_cast<node *>(head_.unlink_next());
+         {
+            node *n = static_cast<node *>(head_.unlink_next());
+            n->~node();
+            Allocator::deallocate(n, sizeof(node));
+         }
          cleanup();
       }
 
       void cleanup()
       {
          while (dead_.next)
-            ::delete(static_cast<node *>(dead_.unlink_next()));
+            Allocator::deallocate(dead_.unlink_next(), sizeof(node)); // values destroyed by put_node
       }
 
       lazy_queue &operator=(const lazy_queue &other)
@@ -149,6 +160,9 @@ namespace ttl
          return *this;
       }
 
+      Allocator &get_allocator() { return *this; }
+      const Allocator &get_allocator() const { return *this; }
+
       iterator before_begin() { return iterator(&head_); }
       iterator begin() { return iterator(head_.next); }
       iterator end() { return iterator(0); }
@@ -207,6 +221,8 @@ namespace ttl
       {
          ttl::swap(head_.next, other.head_.next);
          ttl::swap(tail_, other.tail_);
+         ttl::swap(dead_.next, other.dead_.next);
+         ttl::swap(static_cast<Allocator &>(*this), static_cast<Allocator &>(other));
       }
 
       void clear();
@@ -224,8 +240,8 @@ namespace ttl
          }
       }
    };
-   template<typename T>
-   void lazy_queue<T>::insert_after(const_iterator pos, size_type n, const T &value)
+   template<typename T, typename Allocator>
+   void lazy_queue<T,Allocator>::insert_after(const_iterator pos, size_type n, const T &value)
    {
       slist_node *pn = const_cast<slist_node *>(pos.head_);
       slist_node *p = pn;
@@ -234,9 +250,9 @@ namespace ttl
       if (pn == tail_)
          tail_ = p;
    }
-   template<typename T>
+   template<typename T, typename Allocator>
    template<typename InputIterator>
-   void lazy_queue<T>::insert_after(const_iterator pos, InputIterator first, InputIterator last)
+   void lazy_queue<T,Allocator>::insert_after(const_iterator pos, InputIterator first, InputIterator last)
    {
       slist_node *pn = const_cast<slist_node *>(pos.head_);
       slist_node *p = pn;
@@ -245,8 +261,8 @@ namespace ttl
       if (pn == tail_)
          tail_ = p;
    }
-   template<typename T>
-   typename lazy_queue<T>::iterator lazy_queue<T>::erase_after(const_iterator pos)
+   template<typename T, typename Allocator>
+   typename lazy_queue<T,Allocator>::iterator lazy_queue<T,Allocator>::erase_after(const_iterator pos)
    {
       slist_node *pn = const_cast<slist_node *>(pos.head_);
       slist_node *p = pn->unlink_next();
@@ -255,8 +271,8 @@ namespace ttl
       put_node(static_cast<node *>(p));
       return iterator(pn->next);
    }
-   template<typename T>
-   typename lazy_queue<T>::iterator lazy_queue<T>::erase_after(const_iterator pos, const_iterator last)
+   template<typename T, typename Allocator>
+   typename lazy_queue<T,Allocator>::iterator lazy_queue<T,Allocator>::erase_after(const_iterator pos, const_iterator last)
    {
       slist_node *p = const_cast<slist_node *>(pos.head_);
       while (p->next != last.head_)
@@ -265,8 +281,8 @@ namespace ttl
          tail_ = p;
       return iterator(p->next);
    }
-   template<typename T>
-   void lazy_queue<T>::clear()
+   template<typename T, typename Allocator>
+   void lazy_queue<T,Allocator>::clear()
    {
       while (head_.next)
          put_node(static_cast<node *>(head_.unlink_next()));
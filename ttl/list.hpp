@@ -8,10 +8,16 @@
 #ifndef _TINY_TEMPLATE_LIBRARY_LIST_HPP_
 #define _TINY_TEMPLATE_LIBRARY_LIST_HPP_ 1
 
+#include <assert.h>
+#include <new>
 #include "types.hpp"
+#include "allocator.hpp"
+#include "type_traits.hpp"
 
 namespace ttl
 {
+   template<typename T> void swap(T &, T &);
+
    struct list_node
    {
       list_node *prev, *next;
@@ -33,8 +39,11 @@ namespace ttl
          prev->next = next;
       }
 
+      // moves [first, last) before this node
       void splice(list_node *first, list_node *last)
       {
+         if (first == last)
+            return;
          last->prev->next = this;
          first->prev->next = last;
          this->prev->next = first;
@@ -108,8 +117,8 @@ namespace ttl
       }
 #endif
    };
-   template<typename T>
-   class list
+   template<typename T, typename Allocator = allocator>
+   class list: private Allocator // empty allocators take no space
    {
    public:
       typedef T value_type;
@@ -129,6 +138,20 @@ namespace ttl
       };
       list_node head_;
 
+      node *new_node() { return ::new(Allocator::allocate(sizeof(node))) node(); }
+      node *new_node(const T &v) { return ::new(Allocator::allocate(sizeof(node))) node(v); }
+      void delete_node(node *n)
+      {
+         n->~node();
+         Allocator::deallocate(n, sizeof(node));
+      }
+      // the nodes of other may be freed by this list
+      void check_allocator(const list &other) const
+      {
+         assert(allocators_equal(get_allocator(), other.get_allocator()));
+         (void)other;
+      }
+
    public:
       class const_iterator;
 
@@ -146,8 +169,8 @@ namespace ttl
          iterator operator++(int) { iterator tmp(head_); head_ = head_->next; return tmp; }
          iterator &operator--() { head_ = head_->prev; return *this; }
          iterator operator--(int) { iterator tmp(head_); head_ = head_->prev; return tmp; }
-         reference operator*() const { return static_cast<list<T>::node *>(head_)->value; }
-         pointer operator->() const { return &static_cast<list<T>::node *>(head_)->value; }
+         reference operator*() const { return static_cast<list<T,Allocator>::node *>(head_)->value; }
+         pointer operator->() const { return &static_cast<list<T,Allocator>::node *>(head_)->value; }
 
          bool operator==(const iterator &other) const { return head_ == other.head_; }
          bool operator!=(const iterator &other) const { return head_ != other.head_; }
@@ -156,13 +179,13 @@ namespace ttl
 
       private:
          list_node *head_;
-         friend class list<T>;
+         friend class list<T,Allocator>;
          iterator(list_node *head): head_(head) {}
       };
       class const_iterator
       {
       public:
-         typedef list<T>::iterator iterator;
+         typedef list<T,Allocator>::iterator iterator;
          typedef T value_type;
          typedef const T *pointer;
          typedef const T &reference;
@@ -175,21 +198,22 @@ namespace ttl
          const_iterator operator++(int) { const_iterator tmp(head_); head_ = head_->next; return tmp; }
          const_iterator &operator--() { head_ = head_->prev; return *this; }
          const_iterator operator--(int) { const_iterator tmp(head_); head_ = head_->prev; return tmp; }
-         reference operator*() const { return static_cast<const list<T>::node *>(head_)->value; }
-         pointer operator->() const { return &static_cast<const list<T>::node *>(head_)->value; }
+         reference operator*() const { return static_cast<const list<T,Allocator>::node *>(head_)->value; }
+         pointer operator->() const { return &static_cast<const list<T,Allocator>::node *>(head_)->value; }
 
          bool operator==(const const_iterator &other) const { return head_ == other.head_; }
          bool operator!=(const const_iterator &other) const { return head_ != other.head_; }
 
       private:
-         friend class list<T>;
-         friend class list<T>::iterator;
+         friend class list<T,Allocator>;
+         friend class list<T,Allocator>::iterator;
          const list_node *head_;
          const_iterator(const list_node *head): head_(head) {}
       };
 
       list() { head_.init(); }
-      list(const list &other)
+      explicit list(const Allocator &a): Allocator(a) { head_.init(); }
+      list(const list &other): Allocator(other)
       {
          head_.init();
          insert(cbegin(), other.cbegin(), other.cend());
@@ -214,6 +238,9 @@ namespace ttl
          return *this;
       }
 
+      Allocator &get_allocator() { return *this; }
+      const Allocator &get_allocator() const { return *this; }
+
       iterator begin() { return iterator(head_.next); }
       iterator end() { return iterator(&head_); }
       const_iterator begin() const { return const_iterator(head_.next); }
@@ -251,42 +278,47 @@ namespace ttl
 
       void push_front(const T &value)
       {
-         head_.next->insert_before(new node(value));
+         head_.next->insert_before(new_node(value));
       }
 
       void push_back(const T &value)
       {
-         head_.insert_before(new node(value));
+         head_.insert_before(new_node(value));
       }
 
       void pop_front()
       {
          node *p = static_cast<node *>(head_.next);
          p->unlink();
-         delete p;
+         delete_node(p);
       }
 
       void pop_back()
       {
          node *p = static_cast<node *>(head_.prev);
          p->unlink();
-         delete p;
+         delete_node(p);
       }
 
+      // The nodes move from other as they are: the allocators of the two
+      // lists must be equal, as for merge()
       void splice(const_iterator pos, list &other)
       {
+         check_allocator(other);
          list_node *p = const_cast<list_node *>(pos.head_);
          p->splice(other.head_.next, &other.head_);
       }
-      void splice(const_iterator pos, list &, const_iterator it)
+      void splice(const_iterator pos, list &other, const_iterator it)
       {
+         check_allocator(other);
          list_node *p = const_cast<list_node *>(pos.head_);
          list_node *o = const_cast<list_node *>(it.head_);
          if (o != p)
             p->splice(o, o->next);
       }
-      void splice(const_iterator pos, list &, const_iterator first, const_iterator last)
+      void splice(const_iterator pos, list &other, const_iterator first, const_iterator last)
       {
+         check_allocator(other);
          list_node *p = const_cast<list_node *>(pos.head_);
          p->splice(const_cast<list_node *>(first.head_), const_cast<list_node *>(last.head_));
       }
@@ -294,7 +326,7 @@ namespace ttl
       iterator insert(const_iterator pos, const T &value)
       {
          list_node *p = const_cast<list_node *>(pos.head_);
-         return iterator(p->insert_before(new node(value)));
+         return iterator(p->insert_before(new_node(value)));
       }
       void insert(const_iterator pos, size_type n, const T &value);
       template<typename InputIterator>
@@ -305,7 +337,7 @@ namespace ttl
          list_node *p = const_cast<list_node *>(pos.head_);
          list_node *next = p->next;
          p->unlink();
-         delete static_cast<node *>(p);
+         delete_node(static_cast<node *>(p));
          return iterator(next);
       }
       iterator erase(const_iterator pos, const_iterator last);
@@ -313,6 +345,7 @@ namespace ttl
       void swap(list &other)
       {
          list_node::swap(&head_, &other.head_);
+         ttl::swap(static_cast<Allocator &>(*this), static_cast<Allocator &>(other));
       }
 
       void resize(size_type);
@@ -342,23 +375,23 @@ namespace ttl
          head_.reverse();
       }
    };
-   template<typename T>
-   void list<T>::insert(const_iterator pos, size_type n, const T &value)
+   template<typename T, typename Allocator>
+   void list<T,Allocator>::insert(const_iterator pos, size_type n, const T &value)
    {
       list_node *p = const_cast<list_node *>(pos.head_);
       while (n--)
-         p->insert_before(new node(value));
+         p->insert_before(new_node(value));
    }
-   template<typename T>
+   template<typename T, typename Allocator>
    template<typename InputIterator>
-   void list<T>::insert(const_iterator pos, InputIterator first, InputIterator last)
+   void list<T,Allocator>::insert(const_iterator pos, InputIterator first, InputIterator last)
    {
       list_node *p = const_cast<list_node *>(pos.head_);
       for ( ; first != last; ++first)
-         p->insert_before(new node(*first));
+         p->insert_before(new_node(*first));
    }
-   template<typename T>
-   void list<T>::resize(size_type newsize)
+   template<typename T, typename Allocator>
+   void list<T,Allocator>::resize(size_type newsize)
    {
       size_type siz = 0;
       list_node *p;
@@ -369,15 +402,15 @@ namespace ttl
             {
                list_node *e = head_.prev;
                e->unlink();
-               delete static_cast<node *>(e);
+               delete_node(static_cast<node *>(e));
             }
             return;
          }
       while (siz++ < newsize)
-         head_.insert_before(new node);
+         head_.insert_before(new_node());
    }
-   template<typename T>
-   void list<T>::resize(size_type newsize, const T &value)
+   template<typename T, typename Allocator>
+   void list<T,Allocator>::resize(size_type newsize, const T &value)
    {
       size_type siz = 0;
       list_node *p;
@@ -388,87 +421,90 @@ namespace ttl
             {
                list_node *e = head_.prev;
                e->unlink();
-               delete static_cast<node *>(e);
+               delete_node(static_cast<node *>(e));
             }
             return;
          }
       while (siz++ < newsize)
-         head_.insert_before(new node(value));
+         head_.insert_before(new_node(value));
    }
-   template<typename T>
-   void list<T>::clear()
+   template<typename T, typename Allocator>
+   void list<T,Allocator>::clear()
    {
-      while (head_.next != &head_)
-      {
-         node *p = static_cast<node *>(head_.next);
-         head_.next = head_.next->next;
-         delete p;
-      }
+      if (!(is_monotonic_allocator<Allocator>::value && is_trivially_destructible<T>::value))
+         while (head_.next != &head_)
+         {
+            node *p = static_cast<node *>(head_.next);
+            head_.next = head_.next->next;
+            delete_node(p);
+         }
+      head_.init();
    }
-   template<typename T>
-   typename list<T>::iterator list<T>::erase(const_iterator pos, const_iterator last)
+   template<typename T, typename Allocator>
+   typename list<T,Allocator>::iterator list<T,Allocator>::erase(const_iterator pos, const_iterator last)
    {
       list_node *p = const_cast<list_node *>(pos.head_);
       while (p->next != last.head_)
       {
          node *next = static_cast<node *>(p->next);
          p->unlink();
-         delete static_cast<node *>(p);
+         delete_node(static_cast<node *>(p));
          p = next;
       }
       return iterator(p->next);
    }
-   template<typename T>
-   void list<T>::remove(const T &value)
+   template<typename T, typename Allocator>
+   void list<T,Allocator>::remove(const T &value)
    {
       for (list_node *p = head_.next, *n = p->next; p != &head_; p = n, n = n->next)
          if (static_cast<const node *>(p)->value == value)
          {
             p->unlink();
-            delete static_cast<node *>(p);
+            delete_node(static_cast<node *>(p));
          }
    }
-   template<typename T>
+   template<typename T, typename Allocator>
    template<typename Predicate>
-   void list<T>::remove_if(Predicate pred)
+   void list<T,Allocator>::remove_if(Predicate pred)
    {
       for (list_node *p = head_.next, *n = p->next; p != &head_; p = n, n = n->next)
          if (pred(static_cast<const node *>(p)->value))
          {
             p->unlink();
-            delete static_cast<node *>(p);
+            delete_node(static_cast<node *>(p));
          }
    }
-   template<typename T>
-   void list<T>::unique()
+   template<typename T, typename Allocator>
+   void list<T,Allocator>::unique()
    {
       list_node *prev = head_.next;
       for (list_node *p = prev->next, *n = p->next; p != &head_; p = n, n = n->next)
          if (static_cast<const node *>(p)->value == static_cast<const node *>(prev)->value)
          {
             p->unlink();
-            delete static_cast<node *>(p);
+            delete_node(static_cast<node *>(p));
          }
          else
             prev = p;
    }
-   template<typename T>
+   template<typename T, typename Allocator>
    template<typename BinaryPredicate>
-   void list<T>::unique(BinaryPredicate pred)
+   void list<T,Allocator>::unique(BinaryPredicate pred)
    {
       list_node *prev = head_.next;
       for (list_node *p = prev->next, *n = p->next; p != &head_; p = n, n = n->next)
          if (pred(static_cast<const node *>(p)->value, static_cast<const node *>(prev)->value))
          {
             p->unlink();
-            delete static_cast<node *>(p);
+            delete_node(static_cast<node *>(p));
          }
          else
             prev = p;
    }
-   template<typename T>
-   void list<T>::merge(list &other) // merge sorted lists
+   template<typename T, typename Allocator>
+   void list<T,Allocator>::merge(list &other) // merge sorted lists
    {
+      check_allocator(other);
       list_node *o = other.head_.next;
       for (list_node *i = head_.next; o != &other.head_ && i != &head_;)
       {
@@ -486,10 +522,11 @@ namespace ttl
       if (o != &other.head_)
          head_.splice(other.head_.next, &other.head_);
    }
-   template<typename T>
+   template<typename T, typename Allocator>
    template<typename Compare>
-   void list<T>::merge(list &other, Compare cmp)
+   void list<T,Allocator>::merge(list &other, Compare cmp)
    {
+      check_allocator(other);
       list_node *o = other.head_.next;
       for (list_node *i = head_.next; o != &other.head_ && i != &head_;)
       {
@@ -511,13 +548,13 @@ namespace ttl
    template<class InputIt1, class InputIt2>
    bool equal(InputIt1, InputIt1, InputIt2, InputIt2);
 
-   template <typename T>
-   bool operator==(const list<T> &a, const list<T> &b)
+   template<typename T, typename Allocator>
+   bool operator==(const list<T,Allocator> &a, const list<T,Allocator> &b)
    {
       return ttl::equal(a.begin(), a.end(), b.begin(), b.end());
    }
-   template <typename T>
-   bool operator!=(const list<T> &a, const list<T> &b)
+   template<typename T, typename Allocator>
+   bool operator!=(const list<T,Allocator> &a, const list<T,Allocator> &b)
    {
       return !(a == b);
    }
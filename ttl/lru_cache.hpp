@@ -0,0 +1,257 @@
+/////////////////////////////////////////////////// vim: sw=3 ts=8 et
+//
+// Tiny Template Library: a least-recently-used cache
+//
+// Keeps at most Capacity key-value pairs. Every node is at the same time
+// a node of a red-black tree (for the lookup by key) and of a double
+// linked list in the order of use, so an entry costs one allocation and
+// a hit costs one descent of the tree. When full, inserting a new key
+// evicts the least recently used entry, after passing it to Evict.
+//
+// The nodes are allocated through Allocator or, with Preallocated, kept
+// in the cache object itself, which then never allocates.
+//
+// This code is Public Domain
+//
+#ifndef _TINY_TEMPLATE_LIBRARY_LRU_CACHE_HPP_
+#define _TINY_TEMPLATE_LIBRARY_LRU_CACHE_HPP_ 1
+
+#include <new>
+#include "types.hpp"
+#include "functional.hpp"
+#include "utility.hpp"
+#include "allocator.hpp"
+#include "type_traits.hpp"
+#include "list.hpp"
+#include "rbtree.hpp"
+
+namespace ttl
+{
+   // The default eviction callback of lru_cache: nothing
+   struct lru_no_evict
+   {
+      template<typename Pair> void operator()(Pair &) const {}
+   };
+
+   // Node storage of lru_cache: the allocator...
+   template<typename Node, unsigned int N, bool Preallocated, typename Allocator>
+   struct lru_storage: private Allocator
+   {
+      lru_storage() {}
+      explicit lru_storage(const Allocator &a): Allocator(a) {}
+      Allocator &get_allocator() { return *this; }
+      const Allocator &get_allocator() const { return *this; }
+      void *allocate() { return Allocator::allocate(sizeof(Node)); }
+      void deallocate(Node *n) { Allocator::deallocate(n, sizeof(Node)); }
+   };
+
+   // ... or N nodes in place, with a list of the freed ones
+   template<typename Node, unsigned int N, typename Allocator>
+   struct lru_storage<Node, N, true, Allocator>: private Allocator
+   {
+      lru_storage(): used_(0), free_(0) {}
+      explicit lru_storage(const Allocator &a): Allocator(a), used_(0), free_(0) {}
+      Allocator &get_allocator() { return *this; }
+      const Allocator &get_allocator() const { return *this; }
+      void *allocate()
+      {
+         if (free_)
+         {
+            void *p = free_;
+            free_ = *static_cast<void **>(p);
+            return p;
+         }
+         return nodes_[used_++].bytes;
+      }
+      void deallocate(Node *n)
+      {
+         *reinterpret_cast<void **>(n) = free_;
+         free_ = n;
+      }
+   private:
+      storage_for<Node> nodes_[N];
+      unsigned int used_;
+      void *free_;
+   };
+
+   template<typename K, typename V, unsigned int Capacity,
+            typename Compare = less<K>,
+            typename Evict = lru_no_evict,
+            bool Preallocated = false,
+            typename Allocator = allocator>
+   class lru_cache
+   {
+   public:
+      typedef K key_type;
+      typedef V mapped_type;
+      typedef pair<const K, V> value_type;
+      typedef ttl::size_t size_type;
+
+   private:
+      // put() evicts before it inserts: there must be room for one entry
+#if __cplusplus >= 201103L
+      static_assert(Capacity > 0, "lru_cache: Capacity must be at least 1");
+#else
+      typedef char capacity_must_be_at_least_1[Capacity > 0 ? 1: -1];
+#endif
+
+      struct entry: list_node
+      {
+         value_type value;
+         entry(const value_type &v): value(v) {}
+      };
+      struct key_of
+      {
+         const K &operator()(const entry &e) const { return e.value.first; }
+      };
+      typedef rbtree<K, entry, key_of, Compare> tree_base;
+      typedef typename tree_base::node node;
+
+      // the tree does not own the nodes
+      struct tree_type: tree_base
+      {
+         void release() { *this->root_edge() = 0; }
+         template<class Storage>
+         void release(Storage &storage)
+         {
+            destroy(static_cast<node *>(this->root_()), storage);
+            *this->root_edge() = 0;
+         }
+         template<class Storage>
+         static void destroy(node *n, Storage &storage)
+         {
+            while (n)
+            {
+               node *right = static_cast<node *>(n->right);
+               destroy(static_cast<node *>(n->left), storage);
+               n->~node();
+               storage.deallocate(n);
+               n = right;
+            }
+         }
+      };
+
+      tree_type tree_;
+      list_node used_; // from the least to the most recently used
+      size_type size_;
+      Evict evict_;
+      lru_storage<node, Capacity, Preallocated, Allocator> storage_;
+
+      lru_cache(const lru_cache &);
+      lru_cache &operator=(const lru_cache &);
+
+      static entry *entry_of(list_node *l) { return static_cast<entry *>(l); }
+      void touch(node *n)
+      {
+         n->data.unlink();
+         used_.insert_before(&n->data);
+      }
+      void remove(node *n)
+      {
+         n->data.unlink();
+         --size_;
+         n->~node();
+         storage_.deallocate(n);
+      }
+
+   public:
+      explicit lru_cache(const Evict &evict = Evict()): size_(0), evict_(evict)
+      {
+         used_.init();
+      }
+      explicit lru_cache(const Allocator &a, const Evict &evict = Evict()):
+         size_(0), evict_(evict), storage_(a)
+      {
+         used_.init();
+      }
+      ~lru_cache() { clear(); }
+
+      Allocator &get_allocator() { return storage_.get_allocator(); }
+      const Allocator &get_allocator() const { return storage_.get_allocator(); }
+
+      size_type size() const { return size_; }
+      bool empty() const { return !size_; }
+      bool full() const { return size_ == Capacity; }
+      static size_type capacity() { return Capacity; }
+
+      // the value of the key, made the most recently used, or null
+      mapped_type *get(const K &key)
+      {
+         node *n = tree_.find(key);
+         if (n == tree_.end())
+            return 0;
+         touch(n);
+         return &n->data.value.second;
+      }
+      // the value of the key without changing the order of use, or null
+      const mapped_type *peek(const K &key) const
+      {
+         const node *n = tree_.find(key);
+         return n == tree_.end() ? 0: &n->data.value.second;
+      }
+      bool contains(const K &key) const { return tree_.find(key) != tree_.end(); }
+
+      // inserts or assigns the value, makes it the most recently used;
+      // true if the key was not in the cache
+      pair<mapped_type *, bool> put(const K &key, const V &value);
+
+      bool erase(const K &key)
+      {
+         node *n = tree_.remove(key);
+         if (!n)
+            return false;
+         remove(n);
+         return true;
+      }
+
+      // the entry to be evicted next, or null
+      const value_type *lru() const
+      {
+         return empty() ? 0: &entry_of(used_.next)->value;
+      }
+      const value_type *mru() const
+      {
+         return empty() ? 0: &entry_of(used_.prev)->value;
+      }
+
+      void clear()
+      {
+         // the memory of an arena is reclaimed all at once
+         if (!Preallocated && is_monotonic_allocator<Allocator>::value &&
+             is_trivially_destructible<value_type>::value)
+            tree_.release();
+         else
+            tree_.release(storage_);
+         used_.init();
+         size_ = 0;
+      }
+   };
+
+   template<typename K, typename V, unsigned int Capacity, typename Compare, typename Evict, bool Preallocated, typename Allocator>
+   pair<V *, bool> lru_cache<K,V,Capacity,Compare,Evict,Preallocated,Allocator>::put(const K &key, const V &value)
+   {
+      rbnode *parent;
+      rbnode **edge = tree_.find_edge(key, &parent);
+      if (*edge)
+      {
+         node *n = static_cast<node *>(*edge);
+         n->data.value.second = value;
+         touch(n);
+         return pair<V *, bool>(&n->data.value.second, false);
+      }
+      if (size_ == Capacity)
+      {
+         entry *victim = entry_of(used_.next);
+         evict_(victim->value);
+         remove(tree_.remove(victim->value.first));
+         edge = tree_.find_edge(key, &parent); // the tree has changed
+      }
+      node *n = new(storage_.allocate()) node(entry(value_type(key, value)));
+      tree_.link(edge, parent, n);
+      used_.insert_before(&n->data);
+      ++size_;
+      return pair<V *, bool>(&n->data.value.second, true);
+   }
+}
+
+#endif // _TINY_TEMPLATE_LIBRARY_LRU_CACHE_HPP_
@@ -14,7 +14,7 @@
 
 namespace ttl
 {
-   template<typename KT, typename T, typename Compare = less<KT> >
+   template<typename KT, typename T, typename Compare = less<KT>, typename Allocator = allocator>
    class map // unique keys to values
    {
    public:
@@ -42,7 +42,7 @@ namespace ttl
       };
 
    private:
-      typedef rbtree<KT, pair<const KT, T>, select_first< pair<const KT,T> >, Compare> tree_type;
+      typedef rbtree<KT, pair<const KT, T>, select_first< pair<const KT,T> >, Compare, Allocator> tree_type;
       typedef typename tree_type::node node_type;
 
       tree_type rbtree_;
@@ -52,9 +52,9 @@ namespace ttl
 
       struct iterator
       {
-         typedef typename map<KT,T,Compare>::node_type node_type;
+         typedef typename map<KT,T,Compare,Allocator>::node_type node_type;
       public:
-         typedef map<KT,T,Compare>::value_type value_type;
+         typedef map<KT,T,Compare,Allocator>::value_type value_type;
          typedef ttl::ptrdiff_t difference_type;
          typedef value_type *pointer;
          typedef value_type *reference;
@@ -86,16 +86,16 @@ namespace ttl
          bool operator!=(const const_iterator &other) const { return other != *this; }
       private:
          node_type *ptr_;
-         friend class map<KT,T,Compare>;
-         friend class map<KT,T,Compare>::const_iterator;
+         friend class map<KT,T,Compare,Allocator>;
+         friend class map<KT,T,Compare,Allocator>::const_iterator;
          iterator(node_type *ptr): ptr_(ptr) {}
          static node_type *prev(const node_type *);
       };
       struct const_iterator
       {
-         typedef typename map<KT,T,Compare>::iterator::node_type node_type;
+         typedef typename map<KT,T,Compare,Allocator>::iterator::node_type node_type;
       public:
-         typedef map<KT,T,Compare>::value_type value_type;
+         typedef map<KT,T,Compare,Allocator>::value_type value_type;
          typedef ttl::ptrdiff_t difference_type;
          typedef value_type *pointer;
          typedef value_type *reference;
@@ -133,7 +133,7 @@ namespace ttl
          const_iterator(const iterator &other): ptr_(other.ptr_) {}
       private:
          const node_type *ptr_;
-         friend class map<KT,T,Compare>;
+         friend class map<KT,T,Compare,Allocator>;
          const_iterator(const node_type *ptr): ptr_(ptr) {}
       };
 
@@ -167,9 +167,10 @@ namespace ttl
       }
 
       explicit map() {}
+      explicit map(const Allocator &a): rbtree_(a) {}
       ~map() {}
 
-      map(const map &other)
+      map(const map &other): rbtree_(other.get_allocator())
       {
          rbtree_.assign(other.rbtree_);
       }
@@ -195,17 +196,49 @@ namespace ttl
 
       template<class InputIt> void insert(InputIt first, InputIt last);
 
+      //
+      // Insert-if-absent operations: the tree is descended only once, and the
+      // mapped value is constructed only if the key is not in the map yet.
+      //
+      pair<iterator,bool> try_emplace(const KT &key)
+      {
+         rbnode *parent;
+         rbnode **edge = rbtree_.find_edge(key, &parent);
+         if (*edge)
+            return pair<iterator,bool>(iterator(static_cast<node_type *>(*edge)), false);
+         return pair<iterator,bool>(iterator(rbtree_.attach(edge, parent, value_type(key, T()))), true);
+      }
+      pair<iterator,bool> try_emplace(const KT &key, const T &value)
+      {
+         rbnode *parent;
+         rbnode **edge = rbtree_.find_edge(key, &parent);
+         if (*edge)
+            return pair<iterator,bool>(iterator(static_cast<node_type *>(*edge)), false);
+         return pair<iterator,bool>(iterator(rbtree_.attach(edge, parent, value_type(key, value))), true);
+      }
+      pair<iterator,bool> insert_or_assign(const KT &key, const T &value)
+      {
+         rbnode *parent;
+         rbnode **edge = rbtree_.find_edge(key, &parent);
+         if (*edge)
+         {
+            static_cast<node_type *>(*edge)->data.second = value;
+            return pair<iterator,bool>(iterator(static_cast<node_type *>(*edge)), false);
+         }
+         return pair<iterator,bool>(iterator(rbtree_.attach(edge, parent, value_type(key, value))), true);
+      }
+
       T &operator[](const KT &key)
       {
-         node_type *n = rbtree_.find(key);
-         if (n == rbtree_.end())
-            n = rbtree_.insert_unique(value_type(key, typename value_type::second_type())).first;
-         return n->data.second;
+         return try_emplace(key).first->second;
       }
 
       T &at(const KT &key) { return rbtree_.find(key)->data.second; }
       const T &at(const KT &key) const { return rbtree_.find(key)->data.second; }
 
+      Allocator &get_allocator() { return rbtree_.get_allocator(); }
+      const Allocator &get_allocator() const { return rbtree_.get_allocator(); }
+
       void clear()
       {
          rbtree_.clear();
@@ -215,13 +248,18 @@ namespace ttl
       bool empty() const { return !rbtree_.get_root(); }
       size_type max_size() const { return (size_type)-1 / sizeof(node_type); }
 
+      // operation counters (with TTL_RBTREE_STATS) and shape of the tree
+      void stats(rbtree_stats &s) const { rbtree_.stats(s); }
+      void reset_stats() { rbtree_.reset_stats(); }
+
       iterator erase(const_iterator pos);
       iterator erase(const_iterator first, const_iterator last);
 
       size_type erase(const KT &key)
       {
          node_type *n = rbtree_.remove(key);
-         delete n;
+         if (n)
+            rbtree_.delete_node(n);
          return !!n;
       }
 
@@ -246,19 +284,32 @@ namespace ttl
 
       pair<iterator, iterator> equal_range(const KT &key);
       pair<const_iterator, const_iterator> equal_range(const KT &key) const;
+
+      // The keys in [lo, hi): see rbtree::count_range for the complexity
+      size_type count_range(const KT &lo, const KT &hi) const { return rbtree_.count_range(lo, hi); }
+      iterator_range<iterator> range(const KT &lo, const KT &hi)
+      {
+         iterator first = lower_bound(lo);
+         return iterator_range<iterator>(first, Compare()(lo, hi) ? lower_bound(hi): first);
+      }
+      iterator_range<const_iterator> range(const KT &lo, const KT &hi) const
+      {
+         const_iterator first = lower_bound(lo);
+         return iterator_range<const_iterator>(first, Compare()(lo, hi) ? lower_bound(hi): first);
+      }
    };
 
-   template<typename KT, typename T, typename Compare>
+   template<typename KT, typename T, typename Compare, typename Allocator>
    template<class InputIt>
-   void map<KT,T,Compare>::insert(InputIt first, InputIt last)
+   void map<KT,T,Compare,Allocator>::insert(InputIt first, InputIt last)
    {
       for (; first != last; ++first)
          rbtree_.insert_unique(value_type(first->first, first->second));
    }
 
-   template<typename KT, typename T, typename Compare>
-   typename map<KT,T,Compare>::iterator::node_type *
-   map<KT,T,Compare>::iterator::prev(const node_type *n)
+   template<typename KT, typename T, typename Compare, typename Allocator>
+   typename map<KT,T,Compare,Allocator>::iterator::node_type *
+   map<KT,T,Compare,Allocator>::iterator::prev(const node_type *n)
    {
       // check if it is the sentinel/header
       if (!n->parent)
@@ -270,16 +321,16 @@ namespace ttl
       return const_cast<node_type *>(n);
    }
 
-   template<typename KT, typename T, typename Compare>
-   typename map<KT,T,Compare>::iterator map<KT,T,Compare>::upper_bound(const KT &key)
+   template<typename KT, typename T, typename Compare, typename Allocator>
+   typename map<KT,T,Compare,Allocator>::iterator map<KT,T,Compare,Allocator>::upper_bound(const KT &key)
    {
       node_type *lo = rbtree_.lower_bound(key);
       if (lo == rbtree_.end())
          return end();
       return iterator(static_cast<node_type *>(rbtree_base::next_node(lo)));
    }
-   template<typename KT, typename T, typename Compare>
-   typename map<KT,T,Compare>::const_iterator map<KT,T,Compare>::upper_bound(const KT &key) const
+   template<typename KT, typename T, typename Compare, typename Allocator>
+   typename map<KT,T,Compare,Allocator>::const_iterator map<KT,T,Compare,Allocator>::upper_bound(const KT &key) const
    {
       const node_type *lo = rbtree_.lower_bound(key);
       if (lo == rbtree_.end())
@@ -287,9 +338,9 @@ namespace ttl
       return const_iterator(static_cast<const node_type *>(rbtree_base::next_node(lo)));
    }
 
-   template<typename KT, typename T, typename Compare>
-   pair<typename map<KT,T,Compare>::iterator, typename map<KT,T,Compare>::iterator>
-   map<KT,T,Compare>::equal_range(const KT &key)
+   template<typename KT, typename T, typename Compare, typename Allocator>
+   pair<typename map<KT,T,Compare,Allocator>::iterator, typename map<KT,T,Compare,Allocator>::iterator>
+   map<KT,T,Compare,Allocator>::equal_range(const KT &key)
    {
       node_type *lo = rbtree_.lower_bound(key);
       node_type *up = lo;
@@ -297,9 +348,9 @@ namespace ttl
          up = static_cast<node_type *>(rbtree_base::next_node(lo));
       return pair<iterator, iterator>(iterator(lo), iterator(up));
    }
-   template<typename KT, typename T, typename Compare>
-   pair<typename map<KT,T,Compare>::const_iterator, typename map<KT,T,Compare>::const_iterator>
-   map<KT,T,Compare>::equal_range(const KT &key) const
+   template<typename KT, typename T, typename Compare, typename Allocator>
+   pair<typename map<KT,T,Compare,Allocator>::const_iterator, typename map<KT,T,Compare,Allocator>::const_iterator>
+   map<KT,T,Compare,Allocator>::equal_range(const KT &key) const
    {
       const node_type *lo = rbtree_.lower_bound(key);
       const node_type *up = lo;
@@ -311,13 +362,13 @@ namespace ttl
    template<class InputIt1, class InputIt2>
    bool equal(InputIt1, InputIt1, InputIt2);
 
-   template <typename KT, typename T, typename Compare>
-   bool operator==(const map<KT,T,Compare> &a, const map<KT,T,Compare> &b)
+   template<typename KT, typename T, typename Compare, typename Allocator>
+   bool operator==(const map<KT,T,Compare,Allocator> &a, const map<KT,T,Compare,Allocator> &b)
    {
       return ttl::equal(a.begin(), a.end(), b.begin(), b.end());
    }
-   template <typename KT, typename T, typename Compare>
-   bool operator!=(const map<KT,T,Compare> &a, const map<KT,T,Compare> &b)
+   template<typename KT, typename T, typename Compare, typename Allocator>
+   bool operator!=(const map<KT,T,Compare,Allocator> &a, const map<KT,T,Compare,Allocator> &b)
    {
       return !(a == b);
    }
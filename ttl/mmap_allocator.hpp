@@ -0,0 +1,78 @@
+/////////////////////////////////////////////////// vim: sw=3 ts=8 et
+//
+// Tiny Template Library: an allocator of large blocks in anonymous memory
+// mappings (POSIX)
+//
+// The blocks of Threshold bytes and more are mapped with mmap, and, with
+// HugePages, advised to be backed by transparent huge pages. On Linux they
+// are grown with mremap, which moves the pages instead of copying their
+// contents. The smaller blocks come from the global operator new.
+//
+// This code is Public Domain
+//
+#ifndef _TINY_TEMPLATE_LIBRARY_MMAP_ALLOCATOR_HPP_
+#define _TINY_TEMPLATE_LIBRARY_MMAP_ALLOCATOR_HPP_ 1
+
+#include <new>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "types.hpp"
+
+namespace ttl
+{
+   template<ttl::size_t Threshold = 1024 * 1024, bool HugePages = false>
+   struct mmap_allocator
+   {
+      void *allocate(ttl::size_t bytes)
+      {
+         if (bytes < Threshold)
+            return ::operator new(bytes);
+         void *p = mmap(0, round(bytes), PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+         if (p == MAP_FAILED)
+            abort();
+         advise(p, bytes);
+         return p;
+      }
+      void deallocate(void *p, ttl::size_t bytes)
+      {
+         if (bytes < Threshold)
+            ::operator delete(p);
+         else
+            munmap(p, round(bytes));
+      }
+      void *reallocate(void *p, ttl::size_t bytes, ttl::size_t new_bytes)
+      {
+#ifdef MREMAP_MAYMOVE
+         if (bytes < Threshold || new_bytes < Threshold)
+            return 0;
+         void *n = mremap(p, round(bytes), round(new_bytes), MREMAP_MAYMOVE);
+         if (n == MAP_FAILED)
+            return 0;
+         advise(n, new_bytes);
+         return n;
+#else
+         (void)p, (void)bytes, (void)new_bytes;
+         return 0;
+#endif
+      }
+
+      static ttl::size_t round(ttl::size_t bytes)
+      {
+         const ttl::size_t page = sysconf(_SC_PAGESIZE);
+         return (bytes + page - 1) & ~(page - 1);
+      }
+   private:
+      static void advise(void *p, ttl::size_t bytes)
+      {
+#ifdef MADV_HUGEPAGE
+         if (HugePages)
+            madvise(p, round(bytes), MADV_HUGEPAGE);
+#else
+         (void)p, (void)bytes;
+#endif
+      }
+   };
+}
+
+#endif // _TINY_TEMPLATE_LIBRARY_MMAP_ALLOCATOR_HPP_
@@ -9,6 +9,11 @@
 #ifndef _TINY_TEMPLATE_LIBRARY_RBTREE_HPP_
 #define _TINY_TEMPLATE_LIBRARY_RBTREE_HPP_ 1
 
+#include <new>
+#include "types.hpp"
+#include "allocator.hpp"
+#include "type_traits.hpp"
+
 namespace ttl
 {
    template<typename T1, typename T2> struct pair;
@@ -17,10 +22,56 @@ namespace ttl
    {
       rbnode *parent, *left, *right;
       bool color;
+#ifdef TTL_RBTREE_SUBTREE_SIZE
+      ttl::size_t size; // nodes in the subtree, kept by the rebalancing
+#endif
       static const bool RED = true;
       static const bool BLACK = false;
    };
 
+   //
+   // Operation counters of a tree. Collected only if TTL_RBTREE_STATS is
+   // defined, otherwise the counting compiles to nothing and the counters
+   // are reported as zeros.
+   //
+   struct rbtree_counters
+   {
+      unsigned long lookups;     // descents by a key
+      unsigned long comparisons; // key comparisons made by the descents
+      unsigned long rotations;
+      unsigned long flips;       // color flips
+      unsigned long move_lefts;
+      unsigned long move_rights;
+      unsigned long allocations; // nodes allocated by the tree
+   };
+
+   // The counters and the shape of a tree, see rbtree_base::stats()
+   struct rbtree_stats: rbtree_counters
+   {
+      static const unsigned MAX_DEPTH = 64;
+      ttl::size_t nodes;
+      ttl::size_t height;
+      ttl::size_t black_height;
+      ttl::size_t depth[MAX_DEPTH]; // nodes at every depth, the last one counts all deeper
+   };
+
+   //
+   // The augmentation of the nodes of a tree, such as the greatest bound in
+   // the subtree of interval_map: the rebalancing calls update(n) on every
+   // node whose subtree changed, below before above, to compute what n
+   // keeps from its own data and from its children. This one keeps nothing.
+   //
+   struct rbtree_no_augment
+   {
+      void update(rbnode *) const {}
+   };
+
+#ifdef TTL_RBTREE_STATS
+#define TTL_RBTREE_COUNT(counter) (++counters_.counter)
+#else
+#define TTL_RBTREE_COUNT(counter) ((void)0)
+#endif
+
    //
    // Left-leaning red-black tree
    //
@@ -37,14 +88,19 @@ namespace ttl
       rbtree_base &operator=(const rbtree_base &);
    protected:
       rbnode header_;
+#ifdef TTL_RBTREE_STATS
+      mutable rbtree_counters counters_;
+#endif
       rbnode **root_edge() const { return const_cast<rbnode **>(&header_.parent); }
       rbnode *root_() { return header_.parent; }
       const rbnode *root_() const { return header_.parent; }
+      static void shape(const rbnode *n, ttl::size_t depth, rbtree_stats &s);
    public:
       rbtree_base()
       {
          header_.parent = header_.left = header_.right = 0;
          header_.color = rbnode::RED;
+         reset_stats();
       }
       ~rbtree_base() {}
 
@@ -52,23 +108,75 @@ namespace ttl
       static rbnode *max_node(const rbnode *n);
       static rbnode *next_node(const rbnode *n);
       static rbnode *prev_node(const rbnode *n);
-      static rbnode *rotate_left(rbnode *a);
-      static rbnode *rotate_right(rbnode *b);
-      static void flip_colors(rbnode *n);
+      void flip_colors(rbnode *n);
       static bool is_red(rbnode *n);
-      static rbnode *fixup(rbnode *root);
-
       rbnode **edge(rbnode *h) const;
-      void insert_rebalance(rbnode **root, rbnode *parent);
 
-      static rbnode *move_left(rbnode *pivot);
-      static rbnode *move_right(rbnode *pivot);
+      // The rebalancing, with an augmentation of the nodes or without
+      template<class Augment> rbnode *rotate_left(rbnode *a, const Augment &aug);
+      template<class Augment> rbnode *rotate_right(rbnode *b, const Augment &aug);
+      template<class Augment> rbnode *fixup(rbnode *root, const Augment &aug);
+      template<class Augment> void insert_rebalance(rbnode **root, rbnode *parent, const Augment &aug);
+      template<class Augment> rbnode *move_left(rbnode *pivot, const Augment &aug);
+      template<class Augment> rbnode *move_right(rbnode *pivot, const Augment &aug);
+      template<class Augment> rbnode *delete_min(rbnode **root, const Augment &aug);
+      // unlinks the node probe finds and returns it, 0 if there is none;
+      // probe.less(n) and probe.equal(n) compare its key with that of n
+      template<class Probe, class Augment> rbnode *remove_node(const Probe &probe, const Augment &aug);
+
+      rbnode *rotate_left(rbnode *a) { return rotate_left(a, rbtree_no_augment()); }
+      rbnode *rotate_right(rbnode *b) { return rotate_right(b, rbtree_no_augment()); }
+      rbnode *fixup(rbnode *root) { return fixup(root, rbtree_no_augment()); }
+      void insert_rebalance(rbnode **root, rbnode *parent) { insert_rebalance(root, parent, rbtree_no_augment()); }
+      rbnode *move_left(rbnode *pivot) { return move_left(pivot, rbtree_no_augment()); }
+      rbnode *move_right(rbnode *pivot) { return move_right(pivot, rbtree_no_augment()); }
+      rbnode *delete_min(rbnode **root) { return delete_min(root, rbtree_no_augment()); }
+
+      // Subtree size augmentation, enabled by TTL_RBTREE_SUBTREE_SIZE.
+      // Without it these compile to nothing.
+#ifdef TTL_RBTREE_SUBTREE_SIZE
+      static ttl::size_t subtree_size(const rbnode *n) { return n ? n->size: 0; }
+#endif
+      static void update_size(rbnode *n)
+      {
+#ifdef TTL_RBTREE_SUBTREE_SIZE
+         n->size = 1 + subtree_size(n->left) + subtree_size(n->right);
+#else
+         (void)n;
+#endif
+      }
+      template<class Augment>
+      static void update(rbnode *n, const Augment &aug)
+      {
+         update_size(n);
+         aug.update(n);
+      }
+      void grow_path(rbnode *parent)
+      {
+#ifdef TTL_RBTREE_SUBTREE_SIZE
+         for (; parent != &header_; parent = parent->parent)
+            ++parent->size;
+#else
+         (void)parent;
+#endif
+      }
 
-      rbnode *delete_min(rbnode **root);
+      // Walks the tree to report its shape, O(N)
+      void stats(rbtree_stats &) const;
+      void reset_stats()
+      {
+#ifdef TTL_RBTREE_STATS
+         counters_.lookups = counters_.comparisons = 0;
+         counters_.rotations = counters_.flips = 0;
+         counters_.move_lefts = counters_.move_rights = 0;
+         counters_.allocations = 0;
+#endif
+      }
    };
 
    inline void rbtree_base::flip_colors(rbnode *n)
    {
+      TTL_RBTREE_COUNT(flips);
       n->color = !n->color;
       n->left->color = !n->left->color;
       n->right->color = !n->right->color;
@@ -88,51 +196,10 @@ namespace ttl
       return &h->parent->right;
    }
 
-#ifndef RBTREE_INLINEABLE
-#define RBTREE_INLINEABLE inline
-#define RBTREE_INCLUDE_INLINEABLE 1
-#endif
-
-#if (RBTREE_INCLUDE_INLINEABLE == 1)
-
-   RBTREE_INLINEABLE rbnode *rbtree_base::min_node(const rbnode *n)
-   {
-      while (n && n->left)
-         n = n->left;
-      return const_cast<rbnode *>(n);
-   }
-
-   RBTREE_INLINEABLE rbnode *rbtree_base::max_node(const rbnode *n)
-   {
-      while (n && n->right)
-         n = n->right;
-      return const_cast<rbnode *>(n);
-   }
-
-   RBTREE_INLINEABLE rbnode *rbtree_base::next_node(const rbnode *n)
-   {
-      if  (n->right)
-         return min_node(n->right);
-      if (n == n->parent->left)
-         return n->parent;
-      while (n == n->parent->right)
-         n = n->parent;
-      return n->parent;
-   }
-
-   RBTREE_INLINEABLE rbnode *rbtree_base::prev_node(const rbnode *n)
-   {
-      if (n->left)
-         return max_node(n->left);
-      if (n == n->parent->right)
-         return n->parent;
-      while (n == n->parent->left)
-         n = n->parent;
-      return n->parent;
-   }
-
-   RBTREE_INLINEABLE rbnode *rbtree_base::rotate_left(rbnode *a)
+   template<class Augment>
+   inline rbnode *rbtree_base::rotate_left(rbnode *a, const Augment &aug)
    {
+      TTL_RBTREE_COUNT(rotations);
       rbnode *b = a->right;
       a->right = b->left;
       if (a->right)
@@ -142,11 +209,19 @@ namespace ttl
       a->color = rbnode::RED;
       b->parent = a->parent;
       a->parent = b;
+#ifdef TTL_RBTREE_SUBTREE_SIZE
+      b->size = a->size;
+      update_size(a);
+#endif
+      aug.update(a);
+      aug.update(b);
       return b;
    }
 
-   RBTREE_INLINEABLE rbnode *rbtree_base::rotate_right(rbnode *b)
+   template<class Augment>
+   inline rbnode *rbtree_base::rotate_right(rbnode *b, const Augment &aug)
    {
+      TTL_RBTREE_COUNT(rotations);
       rbnode *a = b->left;
       b->left = a->right;
       if (b->left)
@@ -156,63 +231,80 @@ namespace ttl
       b->color = rbnode::RED;
       a->parent = b->parent;
       b->parent = a;
+#ifdef TTL_RBTREE_SUBTREE_SIZE
+      a->size = b->size;
+      update_size(b);
+#endif
+      aug.update(b);
+      aug.update(a);
       return a;
    }
 
-   RBTREE_INLINEABLE rbnode *rbtree_base::fixup(rbnode *root)
+   template<class Augment>
+   inline rbnode *rbtree_base::fixup(rbnode *root, const Augment &aug)
    {
       if (is_red(root->right) && !is_red(root->left))
-         root = rotate_left(root);
+         root = rotate_left(root, aug);
       if (is_red(root->left) && is_red(root->left->left))
-         root = rotate_right(root);
+         root = rotate_right(root, aug);
       if (is_red(root->left) && is_red(root->right))
          flip_colors(root);
       return root;
    }
 
-   RBTREE_INLINEABLE void rbtree_base::insert_rebalance(rbnode **root, rbnode *parent)
+   // the path above the new node has been updated by the descent which
+   // found its place
+   template<class Augment>
+   inline void rbtree_base::insert_rebalance(rbnode **root, rbnode *parent, const Augment &aug)
    {
       (*root)->color = rbnode::RED;
       (*root)->left = (*root)->right = 0;
+      update(*root, aug);
+      grow_path(parent);
       while (parent != &header_ && (is_red(parent->left) || is_red(parent->right)))
       {
          root = edge(parent);
          parent = parent->parent;
-         *root = fixup(*root);
+         *root = fixup(*root, aug);
       }
       root_()->color = rbnode::BLACK;
    }
 
-   RBTREE_INLINEABLE rbnode *rbtree_base::move_left(rbnode *pivot)
+   template<class Augment>
+   inline rbnode *rbtree_base::move_left(rbnode *pivot, const Augment &aug)
    {
+      TTL_RBTREE_COUNT(move_lefts);
       flip_colors(pivot);
       if (is_red(pivot->right->left))
       {
-         pivot->right = rotate_right(pivot->right);
-         pivot = rotate_left(pivot);
+         pivot->right = rotate_right(pivot->right, aug);
+         pivot = rotate_left(pivot, aug);
          flip_colors(pivot);
       }
       return pivot;
    }
 
-   RBTREE_INLINEABLE rbnode *rbtree_base::move_right(rbnode *pivot)
+   template<class Augment>
+   inline rbnode *rbtree_base::move_right(rbnode *pivot, const Augment &aug)
    {
+      TTL_RBTREE_COUNT(move_rights);
       flip_colors(pivot);
       if (is_red(pivot->left->left))
       {
-         pivot = rotate_right(pivot);
+         pivot = rotate_right(pivot, aug);
          flip_colors(pivot);
       }
       return pivot;
    }
 
-   RBTREE_INLINEABLE rbnode *rbtree_base::delete_min(rbnode **root)
+   template<class Augment>
+   inline rbnode *rbtree_base::delete_min(rbnode **root, const Augment &aug)
    {
       rbnode **pivot = root;
       while ((*pivot)->left)
       {
          if (!is_red((*pivot)->left) && !is_red((*pivot)->left->left))
-            *pivot = move_left(*pivot);
+            *pivot = move_left(*pivot, aug);
          pivot = &(*pivot)->left;
       }
       rbnode *deleted = *pivot;
@@ -222,14 +314,156 @@ namespace ttl
       {
          pivot = edge(parent);
          parent = parent->parent;
-         *pivot = fixup(*pivot);
+         update(*pivot, aug);
+         *pivot = fixup(*pivot, aug);
       }
       return deleted;
    }
+
+   template<class Probe, class Augment>
+   inline rbnode *rbtree_base::remove_node(const Probe &probe, const Augment &aug)
+   {
+      TTL_RBTREE_COUNT(lookups);
+      rbnode **root = root_edge(), *parent = &header_, *deleted = 0;
+      while (*root)
+      {
+         parent = (*root)->parent;
+         bool isless = probe.less(*root);
+         if (isless)
+         {
+            if ((*root)->left && !is_red((*root)->left) && !is_red((*root)->left->left))
+               *root = move_left(*root, aug);
+            root = &(*root)->left;
+         }
+         else
+         {
+            if (is_red((*root)->left))
+            {
+               *root = rotate_right(*root, aug);
+               isless = probe.less(*root);
+            }
+            if (!isless && probe.equal(*root) && !(*root)->right)
+            {
+               deleted = *root;
+               *root = 0;
+               break;
+            }
+            if ((*root)->right && !is_red((*root)->right) && !is_red((*root)->right->left))
+            {
+               *root = move_right(*root, aug);
+               isless = probe.less(*root);
+            }
+            if (probe.equal(*root))
+            {
+               rbnode *orphan = delete_min(&(*root)->right, aug);
+               orphan->color = (*root)->color;
+               orphan->parent = (*root)->parent;
+               orphan->right = (*root)->right;
+               if (orphan->right)
+                  orphan->right->parent = orphan;
+               orphan->left = (*root)->left;
+               if (orphan->left)
+                  orphan->left->parent = orphan;
+               deleted = *root;
+               *root = orphan;
+               parent = *root;
+               break;
+            }
+            else
+               root = &(*root)->right;
+         }
+      }
+      // the subtrees above lost the node
+      while (parent != &header_)
+      {
+         root = edge(parent);
+         parent = parent->parent;
+         update(*root, aug);
+         *root = fixup(*root, aug);
+      }
+      if (root_())
+         root_()->color = rbnode::BLACK;
+      return deleted;
+   }
+
+#ifndef RBTREE_INLINEABLE
+#define RBTREE_INLINEABLE inline
+#define RBTREE_INCLUDE_INLINEABLE 1
+#endif
+
+#if (RBTREE_INCLUDE_INLINEABLE == 1)
+
+   RBTREE_INLINEABLE rbnode *rbtree_base::min_node(const rbnode *n)
+   {
+      while (n && n->left)
+         n = n->left;
+      return const_cast<rbnode *>(n);
+   }
+
+   RBTREE_INLINEABLE rbnode *rbtree_base::max_node(const rbnode *n)
+   {
+      while (n && n->right)
+         n = n->right;
+      return const_cast<rbnode *>(n);
+   }
+
+   RBTREE_INLINEABLE rbnode *rbtree_base::next_node(const rbnode *n)
+   {
+      if  (n->right)
+         return min_node(n->right);
+      if (n == n->parent->left)
+         return n->parent;
+      while (n == n->parent->right)
+         n = n->parent;
+      return n->parent;
+   }
+
+   RBTREE_INLINEABLE rbnode *rbtree_base::prev_node(const rbnode *n)
+   {
+      if (n->left)
+         return max_node(n->left);
+      if (n == n->parent->right)
+         return n->parent;
+      while (n == n->parent->left)
+         n = n->parent;
+      return n->parent;
+   }
+
+   RBTREE_INLINEABLE void rbtree_base::shape(const rbnode *n, ttl::size_t depth, rbtree_stats &s)
+   {
+      for (; n; n = n->right, ++depth)
+      {
+         ++s.nodes;
+         ++s.depth[depth < rbtree_stats::MAX_DEPTH ? depth: rbtree_stats::MAX_DEPTH - 1];
+         if (s.height < depth + 1)
+            s.height = depth + 1;
+         if (n->left)
+            shape(n->left, depth + 1, s);
+      }
+   }
+
+   RBTREE_INLINEABLE void rbtree_base::stats(rbtree_stats &s) const
+   {
+#ifdef TTL_RBTREE_STATS
+      static_cast<rbtree_counters &>(s) = counters_;
+#else
+      s.lookups = s.comparisons = 0;
+      s.rotations = s.flips = 0;
+      s.move_lefts = s.move_rights = 0;
+      s.allocations = 0;
+#endif
+      s.nodes = s.height = s.black_height = 0;
+      for (unsigned i = 0; i < rbtree_stats::MAX_DEPTH; ++i)
+         s.depth[i] = 0;
+      shape(root_(), 0, s);
+      // all paths have the same number of black nodes: take the leftmost
+      for (const rbnode *n = root_(); n; n = n->left)
+         s.black_height += n->color == rbnode::BLACK;
+   }
 #endif //  RBTREE_MERGE(RBTREE_INLINEABLE) == 1
 
-   template <class K, class KV, class KeyOfValue, class Compare>
-   class rbtree: public rbtree_base
+   template <class K, class KV, class KeyOfValue, class Compare, class Allocator = allocator>
+   class rbtree: public rbtree_base, private Allocator // empty allocators take no space
    {
    public:
       typedef KeyOfValue keyof_type;
@@ -241,13 +475,37 @@ namespace ttl
       };
 
       rbtree() {}
+      explicit rbtree(const Allocator &a): Allocator(a) {}
       ~rbtree() { clear(); }
 
+      Allocator &get_allocator() { return *this; }
+      const Allocator &get_allocator() const { return *this; }
+
+      // the nodes of attach and insert_*, to be disposed of after remove
+      node *new_node(const KV &data)
+      {
+         return ::new(Allocator::allocate(sizeof(node))) node(data);
+      }
+      void delete_node(node *n)
+      {
+         n->~node();
+         Allocator::deallocate(n, sizeof(node));
+      }
+
       void assign(const rbtree &);
 
       node *insert_equal(const KV &data);
       pair<node *, bool> insert_unique(const KV &data);
 
+      // Single descent primitives for the insert-if-absent operations:
+      // find_edge returns the edge pointing to the node with the key, or the
+      // (null) edge where a node with the key must be attached to the parent.
+      rbnode **find_edge(const K &key, rbnode **parent);
+      node *attach(rbnode **edge, rbnode *parent, const KV &data);
+      // attach a node allocated by the caller, who must also dispose of it
+      // (after remove, or by emptying the tree before the destruction)
+      node *link(rbnode **edge, rbnode *parent, node *n);
+
       node *remove(const K &key);
 
       node *get_root() { return static_cast<node *>(root_()); }
@@ -286,18 +544,47 @@ namespace ttl
 
       size_t count(const K &k) const;
 
+      // Number of keys in [lo, hi): O(log N) with TTL_RBTREE_SUBTREE_SIZE,
+      // otherwise a walk of the range which only compares node pointers.
+      size_t count_range(const K &lo, const K &hi) const;
+#ifdef TTL_RBTREE_SUBTREE_SIZE
+      // number of keys less than the key, O(log N)
+      size_t rank(const K &key) const;
+#endif
+
       void clear();
 
    protected:
       KeyOfValue keyof_;
       Compare is_less_;
 
+      bool key_less(const K &a, const K &b) const
+      {
+         TTL_RBTREE_COUNT(comparisons);
+         return is_less_(a, b);
+      }
+      bool key_equal(const K &a, const K &b) const
+      {
+         TTL_RBTREE_COUNT(comparisons);
+         return a == b;
+      }
+
+      // the key of remove() against those of the nodes
+      struct key_probe
+      {
+         const rbtree *tree;
+         const K *key;
+         const K &key_of(const rbnode *n) const { return tree->keyof_(static_cast<const node *>(n)->data); }
+         bool less(const rbnode *n) const { return tree->key_less(*key, key_of(n)); }
+         bool equal(const rbnode *n) const { return tree->key_equal(*key, key_of(n)); }
+      };
+
       void postorder_destroy(node *n);
       rbnode *preorder_copy(const node *n);
    };
 
-   template <class K, class KV, class KeyOfValue, class Compare>
-   void rbtree<K,KV,KeyOfValue,Compare>::postorder_destroy(node *n)
+   template <class K, class KV, class KeyOfValue, class Compare, class Allocator>
+   void rbtree<K,KV,KeyOfValue,Compare,Allocator>::postorder_destroy(node *n)
    {
       if (!n)
          return;
@@ -306,15 +593,16 @@ namespace ttl
          postorder_destroy(static_cast<node *>(n->left));
       if (n->right)
          postorder_destroy(static_cast<node *>(n->right));
-      delete n;
+      delete_node(n);
    }
 
-   template <class K, class KV, class KeyOfValue, class Compare>
-   rbnode *rbtree<K,KV,KeyOfValue,Compare>::preorder_copy(const node *n)
+   template <class K, class KV, class KeyOfValue, class Compare, class Allocator>
+   rbnode *rbtree<K,KV,KeyOfValue,Compare,Allocator>::preorder_copy(const node *n)
    {
       if (!n)
          return 0;
-      node *nc = new node(n->data);
+      node *nc = new_node(n->data);
+      TTL_RBTREE_COUNT(allocations);
       nc->color = n->color;
       if (n->left)
          nc->left = preorder_copy(static_cast<const node *>(n->left)),
@@ -326,11 +614,12 @@ namespace ttl
          nc->right->parent = nc;
       else
          nc->right = 0;
+      update_size(nc);
       return nc;
    }
 
-   template <class K, class KV, class KeyOfValue, class Compare>
-   void rbtree<K,KV,KeyOfValue,Compare>::assign(const rbtree &other)
+   template <class K, class KV, class KeyOfValue, class Compare, class Allocator>
+   void rbtree<K,KV,KeyOfValue,Compare,Allocator>::assign(const rbtree &other)
    {
       if (root_())
          clear();
@@ -339,27 +628,30 @@ namespace ttl
          (*root_edge() = preorder_copy(otherroot))->parent = &header_;
    }
 
-   template <class K, class KV, class KeyOfValue, class Compare>
-   void rbtree<K,KV,KeyOfValue,Compare>::clear()
+   template <class K, class KV, class KeyOfValue, class Compare, class Allocator>
+   void rbtree<K,KV,KeyOfValue,Compare,Allocator>::clear()
    {
       node *root = static_cast<node *>(root_());
       *root_edge() = 0;
-      postorder_destroy(root);
+      // the memory of an arena is reclaimed all at once
+      if (!(is_monotonic_allocator<Allocator>::value && is_trivially_destructible<KV>::value))
+         postorder_destroy(root);
    }
 
-   template <class K, class KV, class KeyOfValue, class Compare>
-   size_t rbtree<K,KV,KeyOfValue,Compare>::count(const K &key) const
+   template <class K, class KV, class KeyOfValue, class Compare, class Allocator>
+   size_t rbtree<K,KV,KeyOfValue,Compare,Allocator>::count(const K &key) const
    {
+      TTL_RBTREE_COUNT(lookups);
       const rbnode *n = root_();
       size_t c = 0;
       while (n)
       {
          const K &nkey = keyof_(static_cast<const node *>(n)->data);
-         if (is_less_(nkey, key))
+         if (key_less(nkey, key))
             n = n->right;
          else
          {
-            if (nkey == key)
+            if (key_equal(nkey, key))
                ++c;
             n = n->left;
          }
@@ -367,17 +659,54 @@ namespace ttl
       return c;
    }
 
-   template <class K, class KV, class KeyOfValue, class Compare>
-   const typename rbtree<K,KV,KeyOfValue,Compare>::node *
-   rbtree<K,KV,KeyOfValue,Compare>::find(const K &key) const
+   template <class K, class KV, class KeyOfValue, class Compare, class Allocator>
+   size_t rbtree<K,KV,KeyOfValue,Compare,Allocator>::count_range(const K &lo, const K &hi) const
+   {
+      if (!key_less(lo, hi))
+         return 0;
+#ifdef TTL_RBTREE_SUBTREE_SIZE
+      return rank(hi) - rank(lo);
+#else
+      size_t c = 0;
+      for (const rbnode *n = lower_bound(lo), *last = lower_bound(hi); n != last; n = next_node(n))
+         ++c;
+      return c;
+#endif
+   }
+
+#ifdef TTL_RBTREE_SUBTREE_SIZE
+   template <class K, class KV, class KeyOfValue, class Compare, class Allocator>
+   size_t rbtree<K,KV,KeyOfValue,Compare,Allocator>::rank(const K &key) const
+   {
+      TTL_RBTREE_COUNT(lookups);
+      const rbnode *n = root_();
+      size_t r = 0;
+      while (n)
+      {
+         if (key_less(keyof_(static_cast<const node *>(n)->data), key))
+         {
+            r += subtree_size(n->left) + 1;
+            n = n->right;
+         }
+         else
+            n = n->left;
+      }
+      return r;
+   }
+#endif
+
+   template <class K, class KV, class KeyOfValue, class Compare, class Allocator>
+   const typename rbtree<K,KV,KeyOfValue,Compare,Allocator>::node *
+   rbtree<K,KV,KeyOfValue,Compare,Allocator>::find(const K &key) const
    {
+      TTL_RBTREE_COUNT(lookups);
       const rbnode *n = root_();
       while (n)
       {
          const K &nkey = keyof_(static_cast<const node *>(n)->data);
-         if (is_less_(key, nkey))
+         if (key_less(key, nkey))
             n = n->left;
-         else if (key == nkey)
+         else if (key_equal(key, nkey))
             break;
          else
             n = n->right;
@@ -385,14 +714,15 @@ namespace ttl
       return static_cast<const node *>(n ? n: &header_);
    }
 
-   template <class K, class KV, class KeyOfValue, class Compare>
-   const typename rbtree<K,KV,KeyOfValue,Compare>::node *
-   rbtree<K,KV,KeyOfValue,Compare>::lower_bound(const K &key) const
+   template <class K, class KV, class KeyOfValue, class Compare, class Allocator>
+   const typename rbtree<K,KV,KeyOfValue,Compare,Allocator>::node *
+   rbtree<K,KV,KeyOfValue,Compare,Allocator>::lower_bound(const K &key) const
    {
+      TTL_RBTREE_COUNT(lookups);
       const rbnode *n = root_(), *prev = &header_;
       while (n)
       {
-         if (is_less_(keyof_(static_cast<const node *>(n)->data), key))
+         if (key_less(keyof_(static_cast<const node *>(n)->data), key))
             n = n->right;
          else
             prev = n, n = n->left;
@@ -401,14 +731,15 @@ namespace ttl
       return static_cast<const node *>(prev);
    }
 
-   template <class K, class KV, class KeyOfValue, class Compare>
-   const typename rbtree<K,KV,KeyOfValue,Compare>::node *
-   rbtree<K,KV,KeyOfValue,Compare>::upper_bound(const K &key) const
+   template <class K, class KV, class KeyOfValue, class Compare, class Allocator>
+   const typename rbtree<K,KV,KeyOfValue,Compare,Allocator>::node *
+   rbtree<K,KV,KeyOfValue,Compare,Allocator>::upper_bound(const K &key) const
    {
+      TTL_RBTREE_COUNT(lookups);
       const rbnode *n = root_(), *prev = &header_;
       while (n)
       {
-         if (is_less_(key, keyof_(static_cast<const node *>(n)->data)))
+         if (key_less(key, keyof_(static_cast<const node *>(n)->data)))
             prev = n, n = n->left;
          else
             n = n->right;
@@ -416,114 +747,78 @@ namespace ttl
       return static_cast<const node *>(prev);
    }
 
-   template <class K, class KV, class KeyOfValue, class Compare>
-   typename rbtree<K,KV,KeyOfValue,Compare>::node *
-   rbtree<K,KV,KeyOfValue,Compare>::insert_equal(const KV &data)
+   template <class K, class KV, class KeyOfValue, class Compare, class Allocator>
+   rbnode **rbtree<K,KV,KeyOfValue,Compare,Allocator>::find_edge(const K &key, rbnode **parent)
    {
-      rbnode *parent = &header_;
+      TTL_RBTREE_COUNT(lookups);
       rbnode **edge = root_edge();
-      for (const K &key = keyof_(data); *edge;)
+      *parent = &header_;
+      while (*edge)
       {
-         parent = *edge;
-         if (is_less_(key, keyof_(static_cast<const node *>(*edge)->data)))
-            edge = &(*edge)->left;
+         const K &ekey = keyof_(static_cast<const node *>(*edge)->data);
+         if (key_less(key, ekey))
+            *parent = *edge, edge = &(*edge)->left;
+         else if (key_equal(key, ekey))
+            break;
          else
-            edge = &(*edge)->right;
+            *parent = *edge, edge = &(*edge)->right;
       }
-      node *newnode = new node(data);
-      newnode->parent = parent;
-      *edge = newnode;
+      return edge;
+   }
+
+   template <class K, class KV, class KeyOfValue, class Compare, class Allocator>
+   typename rbtree<K,KV,KeyOfValue,Compare,Allocator>::node *
+   rbtree<K,KV,KeyOfValue,Compare,Allocator>::attach(rbnode **edge, rbnode *parent, const KV &data)
+   {
+      TTL_RBTREE_COUNT(allocations);
+      return link(edge, parent, new_node(data));
+   }
+
+   template <class K, class KV, class KeyOfValue, class Compare, class Allocator>
+   typename rbtree<K,KV,KeyOfValue,Compare,Allocator>::node *
+   rbtree<K,KV,KeyOfValue,Compare,Allocator>::link(rbnode **edge, rbnode *parent, node *n)
+   {
+      n->parent = parent;
+      *edge = n;
       insert_rebalance(edge, parent);
-      return newnode;
+      return n;
    }
 
-   template <class K, class KV, class KeyOfValue, class Compare>
-   ttl::pair<typename rbtree<K,KV,KeyOfValue,Compare>::node *, bool>
-   rbtree<K,KV,KeyOfValue,Compare>::insert_unique(const KV &data)
+   template <class K, class KV, class KeyOfValue, class Compare, class Allocator>
+   typename rbtree<K,KV,KeyOfValue,Compare,Allocator>::node *
+   rbtree<K,KV,KeyOfValue,Compare,Allocator>::insert_equal(const KV &data)
    {
+      TTL_RBTREE_COUNT(lookups);
       rbnode *parent = &header_;
       rbnode **edge = root_edge();
       for (const K &key = keyof_(data); *edge;)
       {
-         const K &ekey = keyof_(static_cast<const node *>(*edge)->data);
-         if (is_less_(key, ekey))
-            parent = *edge, edge = &(*edge)->left;
-         else if (key == ekey)
-            return pair<node *, bool>(static_cast<node *>(*edge), false);
+         parent = *edge;
+         if (key_less(key, keyof_(static_cast<const node *>(*edge)->data)))
+            edge = &(*edge)->left;
          else
-            parent = *edge, edge = &(*edge)->right;
+            edge = &(*edge)->right;
       }
-      node *newnode = new node(data);
-      newnode->parent = parent;
-      *edge = newnode;
-      insert_rebalance(edge, parent);
-      return pair<node *, bool>(static_cast<node *>(newnode), true);
+      return attach(edge, parent, data);
    }
 
-   template <class K, class KV, class KeyOfValue, class Compare>
-   typename rbtree<K,KV,KeyOfValue,Compare>::node *
-   rbtree<K,KV,KeyOfValue,Compare>::remove(const K &key)
+   template <class K, class KV, class KeyOfValue, class Compare, class Allocator>
+   ttl::pair<typename rbtree<K,KV,KeyOfValue,Compare,Allocator>::node *, bool>
+   rbtree<K,KV,KeyOfValue,Compare,Allocator>::insert_unique(const KV &data)
    {
-      rbnode **root = root_edge(), *parent = &header_, *deleted = 0;
-      while (*root)
-      {
-         parent = (*root)->parent;
-         bool isless = is_less_(key, keyof_(static_cast<const node *>(*root)->data));
-         if (isless)
-         {
-            if ((*root)->left && !is_red((*root)->left) && !is_red((*root)->left->left))
-               *root = move_left(*root);
-            root = &(*root)->left;
-         }
-         else
-         {
-            if (is_red((*root)->left))
-            {
-               *root = rotate_right(*root);
-               isless = is_less_(key, keyof_(static_cast<const node *>(*root)->data));
-            }
-            if (!isless &&
-                key == keyof_(static_cast<const node *>(*root)->data) &&
-                !(*root)->right)
-            {
-               deleted = *root;
-               *root = 0;
-               break;
-            }
-            if ((*root)->right && !is_red((*root)->right) && !is_red((*root)->right->left))
-            {
-               *root = move_right(*root);
-               isless = is_less_(key, keyof_(static_cast<const node *>(*root)->data));
-            }
-            if (key == keyof_(static_cast<const node *>(*root)->data))
-            {
-               rbnode *orphan = delete_min(&(*root)->right);
-               orphan->color = (*root)->color;
-               orphan->parent = (*root)->parent;
-               orphan->right = (*root)->right;
-               if (orphan->right)
-                  orphan->right->parent = orphan;
-               orphan->left = (*root)->left;
-               if (orphan->left)
-                  orphan->left->parent = orphan;
-               deleted = *root;
-               *root = orphan;
-               parent = *root;
-               break;
-            }
-            else
-               root = &(*root)->right;
-         }
-      }
-      while (parent != &header_)
-      {
-         root = edge(parent);
-         parent = parent->parent;
-         *root = fixup(*root);
-      }
-      if (root_())
-         root_()->color = rbnode::BLACK;
-      return static_cast<node *>(deleted);
+      rbnode *parent;
+      rbnode **edge = find_edge(keyof_(data), &parent);
+      if (*edge)
+         return pair<node *, bool>(static_cast<node *>(*edge), false);
+      return pair<node *, bool>(attach(edge, parent, data), true);
+   }
+
+   template <class K, class KV, class KeyOfValue, class Compare, class Allocator>
+   typename rbtree<K,KV,KeyOfValue,Compare,Allocator>::node *
+   rbtree<K,KV,KeyOfValue,Compare,Allocator>::remove(const K &key)
+   {
+      const key_probe probe = { this, &key };
+      return static_cast<node *>(remove_node(probe, rbtree_no_augment()));
    }
 }
 
@@ -0,0 +1,898 @@
+/////////////////////////////////////////////////// vim: sw=3 ts=8 et
+//
+// Tiny Template Library: a compressed set of 32 bit values, after the
+// roaring bitmaps
+//
+// The values are split by their high 16 bits into chunks of 65536, kept
+// in a sorted_vector_map. A chunk holds its low 16 bits in one of three
+// forms, the smallest for its contents:
+//
+//    array  the sorted values, 2 bytes each, up to 4096 of them
+//    dense  a bitset<65536>, 8 KiB
+//    runs   the runs of consecutive values, as first and last, 4 bytes each
+//
+// insert() and erase() keep the arrays and the dense chunks, turning one
+// into the other at 4096 values, and turn the runs they change into
+// either. The set operations and deserialize() pick the smallest form for
+// the chunks they make; optimize() does so for all of them, runs included.
+//
+//    ttl::roaring_bitmap<> a, b;
+//    a.insert(7);
+//    b.insert(7);
+//    b.insert(100000);
+//    a |= b;
+//    for (ttl::roaring_bitmap<>::const_iterator i = a.begin(); i != a.end(); ++i)
+//       use(*i);
+//
+// serialize() writes a flat buffer, in the byte order of the host:
+//
+//    chunks    u32
+//    per chunk key u16, kind u16 (0 array, 1 dense, 2 runs), n u32, then n
+//              u16 of the values, of the runs as first and last pairs, or
+//              of the bitset words
+//
+// This code is Public Domain
+//
+#ifndef _TINY_TEMPLATE_LIBRARY_ROARING_BITMAP_HPP_
+#define _TINY_TEMPLATE_LIBRARY_ROARING_BITMAP_HPP_ 1
+
+#include <new>
+#include <string.h>
+#include <limits.h>
+#include "types.hpp"
+#include "allocator.hpp"
+#include "functional.hpp"
+#include "utility.hpp"
+#include "algorithm.hpp"
+#include "vector.hpp"
+#include "sorted_vector_map.hpp"
+#include "bitset.hpp"
+
+namespace ttl
+{
+   template<typename Allocator = allocator>
+   class roaring_bitmap
+   {
+   public:
+      typedef unsigned    value_type;
+      typedef ttl::size_t size_type;
+
+   private:
+      typedef unsigned short low_type;
+      typedef bitset<65536> dense_type;
+      typedef dense_type::slot_type slot_type;
+      typedef vector<low_type, Allocator> values_type;
+      enum { array_max = 4096, dense_bytes = sizeof(dense_type) };
+      static const unsigned BPW = sizeof(slot_type) * CHAR_BIT;
+
+      // the values of one chunk, by their low 16 bits
+      struct chunk
+      {
+         enum kind_type { array, dense, runs };
+
+         kind_type kind_;
+         size_type count_;
+         values_type values_; // the array, or the runs as first, last pairs
+         dense_type *dense_; // set for the dense chunks only
+
+         explicit chunk(const Allocator &a): kind_(array), count_(0), values_(a), dense_(0) {}
+         chunk(const chunk &other): kind_(other.kind_), count_(other.count_), values_(other.values_), dense_(0)
+         {
+            if (other.dense_)
+               dense_ = new_dense(*other.dense_);
+         }
+         ~chunk() { delete_dense(); }
+         chunk &operator=(const chunk &other)
+         {
+            if (this == &other)
+               return *this;
+            values_ = other.values_;
+            if (!other.dense_)
+               delete_dense();
+            else if (dense_)
+               *dense_ = *other.dense_;
+            else
+               dense_ = new_dense(*other.dense_);
+            kind_ = other.kind_;
+            count_ = other.count_;
+            return *this;
+         }
+
+         dense_type *new_dense(const dense_type &d = dense_type())
+         {
+            return ::new(values_.get_allocator().allocate(sizeof(dense_type))) dense_type(d);
+         }
+         void delete_dense()
+         {
+            if (!dense_)
+               return;
+            dense_->~dense_type();
+            values_.get_allocator().deallocate(dense_, sizeof(dense_type));
+            dense_ = 0;
+         }
+         void replace_values(values_type &v)
+         {
+            values_.swap(v);
+            v.clear();
+         }
+         void release_values()
+         {
+            values_type none(values_.get_allocator());
+            replace_values(none);
+         }
+
+         size_type runs_size() const { return values_.size() / 2; }
+         low_type first(size_type r) const { return values_[2 * r]; }
+         low_type last(size_type r) const { return values_[2 * r + 1]; }
+         // the number of runs starting at or before v
+         size_type runs_before(low_type v) const
+         {
+            size_type lo = 0, hi = runs_size();
+            while (lo < hi)
+            {
+               const size_type mid = lo + (hi - lo) / 2;
+               if (first(mid) <= v)
+                  lo = mid + 1;
+               else
+                  hi = mid;
+            }
+            return lo;
+         }
+         const low_type *array_find(low_type v) const
+         {
+            return ttl::lower_bound(values_.begin(), values_.end(), v);
+         }
+
+         bool contains(low_type v) const
+         {
+            switch (kind_)
+            {
+            case array:
+            {
+               const low_type *p = array_find(v);
+               return p != values_.end() && *p == v;
+            }
+            case dense:
+               return dense_->test(v);
+            default:
+               const size_type r = runs_before(v);
+               return r && v <= last(r - 1);
+            }
+         }
+         bool insert(low_type v);
+         bool erase(low_type v);
+
+         // the functions for for_each_set, appending to a vector of values
+         // or of runs
+         struct push_value
+         {
+            values_type *v;
+            void operator()(ttl::size_t i) { v->push_back((low_type)i); }
+         };
+         struct push_run
+         {
+            values_type *v;
+            void operator()(ttl::size_t i)
+            {
+               if (v->empty() || (ttl::size_t)v->back() + 1 != i)
+               {
+                  v->push_back((low_type)i);
+                  v->push_back((low_type)i);
+               }
+               else
+                  v->back() = (low_type)i;
+            }
+         };
+
+         static void set_range(dense_type &d, unsigned first, unsigned last);
+         static void reset_range(dense_type &d, unsigned first, unsigned last);
+         // sets the values of the chunk in d
+         void set_into(dense_type &d) const;
+         size_type run_count() const;
+
+         void to_array();
+         void to_dense();
+         void to_runs();
+         // the smallest of the three forms
+         void optimize();
+
+         void unite(const chunk &other);
+         void intersect(const chunk &other);
+         void subtract(const chunk &other);
+      };
+
+      typedef sorted_vector_map<low_type, chunk, ttl::less<low_type>, Allocator> directory;
+      directory chunks_;
+
+      typename directory::iterator find_or_add(low_type high)
+      {
+         typename directory::iterator i = chunks_.find(high);
+         if (i == chunks_.end())
+            i = chunks_.insert(typename directory::value_type(high, chunk(chunks_.get_allocator()))).first;
+         return i;
+      }
+
+      template<class UnaryFunction>
+      struct offset
+      {
+         UnaryFunction *f;
+         value_type high;
+         void operator()(ttl::size_t i) { (*f)(high | (value_type)i); }
+      };
+
+   public:
+      class const_iterator
+      {
+      public:
+         typedef roaring_bitmap::value_type value_type;
+         typedef ttl::ptrdiff_t difference_type;
+
+         value_type operator*() const { return (value_type)c_->first << 16 | low_; }
+         const_iterator &operator++();
+         const_iterator operator++(int) { const_iterator t(*this); ++*this; return t; }
+         bool operator==(const const_iterator &o) const { return c_ == o.c_ && index_ == o.index_ && low_ == o.low_; }
+         bool operator!=(const const_iterator &o) const { return !operator==(o); }
+      private:
+         friend class roaring_bitmap;
+         typename directory::const_iterator c_, end_;
+         size_type index_; // in the array or the runs
+         value_type low_;
+         const_iterator(typename directory::const_iterator c, typename directory::const_iterator end):
+            c_(c), end_(end), index_(0), low_(0)
+         {
+            first();
+         }
+         void first();
+      };
+      typedef const_iterator iterator;
+
+      roaring_bitmap() {}
+      explicit roaring_bitmap(const Allocator &a): chunks_(a) {}
+
+      Allocator &get_allocator() { return chunks_.get_allocator(); }
+      const Allocator &get_allocator() const { return chunks_.get_allocator(); }
+
+      const_iterator begin() const { return const_iterator(chunks_.begin(), chunks_.end()); }
+      const_iterator end() const { return const_iterator(chunks_.end(), chunks_.end()); }
+
+      bool empty() const { return chunks_.empty(); }
+      // the number of values in the set
+      size_type cardinality() const
+      {
+         size_type n = 0;
+         for (typename directory::const_iterator i = chunks_.begin(); i != chunks_.end(); ++i)
+            n += i->second.count_;
+         return n;
+      }
+      // the number of chunks of 65536 values with any value in the set
+      size_type chunks() const { return chunks_.size(); }
+      void clear() { chunks_.clear(); }
+
+      bool contains(value_type v) const
+      {
+         typename directory::const_iterator i = chunks_.find((low_type)(v >> 16));
+         return i != chunks_.end() && i->second.contains((low_type)v);
+      }
+      // true if v was not in the set
+      bool insert(value_type v) { return find_or_add((low_type)(v >> 16))->second.insert((low_type)v); }
+      template<class InputIt>
+      void insert(InputIt first, InputIt last)
+      {
+         for (; first != last; ++first)
+            insert(*first);
+      }
+      size_type erase(value_type v)
+      {
+         typename directory::iterator i = chunks_.find((low_type)(v >> 16));
+         if (i == chunks_.end() || !i->second.erase((low_type)v))
+            return 0;
+         if (!i->second.count_)
+            chunks_.erase(i);
+         return 1;
+      }
+
+      // puts every chunk in its smallest form
+      void optimize()
+      {
+         for (typename directory::iterator i = chunks_.begin(); i != chunks_.end(); ++i)
+            i->second.optimize();
+      }
+
+      // calls f(v) for each value, in order
+      template<class UnaryFunction>
+      UnaryFunction for_each(UnaryFunction f) const;
+
+      roaring_bitmap &operator|=(const roaring_bitmap &other);
+      roaring_bitmap &operator&=(const roaring_bitmap &other);
+      roaring_bitmap &operator-=(const roaring_bitmap &other);
+
+      bool operator==(const roaring_bitmap &other) const;
+      bool operator!=(const roaring_bitmap &other) const { return !operator==(other); }
+
+      // the bytes serialize() writes
+      size_type serialized_bytes() const;
+      void serialize(void *buffer) const;
+      // false, with the set empty, if the buffer is not a serialized set
+      bool deserialize(const void *buffer, size_type bytes);
+
+      void swap(roaring_bitmap &other) { chunks_.swap(other.chunks_); }
+   };
+
+   template<typename Allocator>
+   bool roaring_bitmap<Allocator>::chunk::insert(low_type v)
+   {
+      switch (kind_)
+      {
+      case array:
+      {
+         const low_type *p = array_find(v);
+         if (p != values_.end() && *p == v)
+            return false;
+         if (count_ < array_max)
+         {
+            // vector grows by the inserted values only
+            if (values_.size() == values_.capacity())
+            {
+               const size_type offset = p - values_.begin(), n = values_.size() * 2;
+               values_.reserve(n < 4 ? 4: n < array_max ? n: (size_type)array_max);
+               p = values_.begin() + offset;
+            }
+            values_.insert(p, v);
+            ++count_;
+            return true;
+         }
+         to_dense();
+         break;
+      }
+      case dense:
+         break;
+      default:
+         if (contains(v))
+            return false;
+         if (count_ < array_max)
+            to_array();
+         else
+            to_dense();
+         return insert(v);
+      }
+      if (dense_->test(v))
+         return false;
+      dense_->set(v);
+      ++count_;
+      return true;
+   }
+   template<typename Allocator>
+   bool roaring_bitmap<Allocator>::chunk::erase(low_type v)
+   {
+      switch (kind_)
+      {
+      case array:
+      {
+         const low_type *p = array_find(v);
+         if (p == values_.end() || *p != v)
+            return false;
+         values_.erase(p);
+         --count_;
+         return true;
+      }
+      case dense:
+         if (!dense_->test(v))
+            return false;
+         dense_->reset(v);
+         if (--count_ <= array_max)
+            to_array();
+         return true;
+      default:
+         if (!contains(v))
+            return false;
+         if (count_ <= array_max)
+            to_array();
+         else
+            to_dense();
+         return erase(v);
+      }
+   }
+
+   template<typename Allocator>
+   void roaring_bitmap<Allocator>::chunk::set_range(dense_type &d, unsigned first, unsigned last)
+   {
+      slot_type *w = d.data();
+      const unsigned fw = first / BPW, lw = last / BPW;
+      const slot_type fm = (slot_type)-1 << first % BPW, lm = (slot_type)-1 >> (BPW - 1 - last % BPW);
+      if (fw == lw)
+         w[fw] |= fm & lm;
+      else
+      {
+         w[fw] |= fm;
+         for (unsigned i = fw + 1; i < lw; ++i)
+            w[i] = (slot_type)-1;
+         w[lw] |= lm;
+      }
+   }
+   template<typename Allocator>
+   void roaring_bitmap<Allocator>::chunk::reset_range(dense_type &d, unsigned first, unsigned last)
+   {
+      slot_type *w = d.data();
+      const unsigned fw = first / BPW, lw = last / BPW;
+      const slot_type fm = (slot_type)-1 << first % BPW, lm = (slot_type)-1 >> (BPW - 1 - last % BPW);
+      if (fw == lw)
+         w[fw] &= ~(fm & lm);
+      else
+      {
+         w[fw] &= ~fm;
+         for (unsigned i = fw + 1; i < lw; ++i)
+            w[i] = 0;
+         w[lw] &= ~lm;
+      }
+   }
+   template<typename Allocator>
+   void roaring_bitmap<Allocator>::chunk::set_into(dense_type &d) const
+   {
+      switch (kind_)
+      {
+      case array:
+         for (const low_type *i = values_.begin(); i != values_.end(); ++i)
+            d.set(*i);
+         break;
+      case dense:
+         d |= *dense_;
+         break;
+      default:
+         for (size_type r = 0; r < runs_size(); ++r)
+            set_range(d, first(r), last(r));
+      }
+   }
+   template<typename Allocator>
+   typename roaring_bitmap<Allocator>::size_type roaring_bitmap<Allocator>::chunk::run_count() const
+   {
+      switch (kind_)
+      {
+      case array:
+      {
+         size_type n = !values_.empty();
+         for (size_type i = 1; i < values_.size(); ++i)
+            n += values_[i] != values_[i - 1] + 1;
+         return n;
+      }
+      case dense:
+      {
+         // the bits set after a clear one start the runs
+         size_type n = 0;
+         slot_type carry = 0;
+         const slot_type *w = dense_->data();
+         for (unsigned i = 0; i <= dense_->last_slot_index(); ++i)
+         {
+            n += bits_popcount((slot_type)(w[i] & ~(w[i] << 1 | carry)));
+            carry = w[i] >> (BPW - 1);
+         }
+         return n;
+      }
+      default:
+         return runs_size();
+      }
+   }
+
+   template<typename Allocator>
+   void roaring_bitmap<Allocator>::chunk::to_array()
+   {
+      if (kind_ == array)
+         return;
+      values_type a(values_.get_allocator());
+      a.reserve(count_);
+      if (kind_ == dense)
+      {
+         push_value f = { &a };
+         dense_->for_each_set(f);
+         delete_dense();
+      }
+      else
+         for (size_type r = 0; r < runs_size(); ++r)
+            for (unsigned v = first(r); v <= last(r); ++v)
+               a.push_back((low_type)v);
+      replace_values(a);
+      kind_ = array;
+   }
+   template<typename Allocator>
+   void roaring_bitmap<Allocator>::chunk::to_dense()
+   {
+      if (kind_ == dense)
+         return;
+      dense_ = new_dense();
+      set_into(*dense_);
+      release_values();
+      kind_ = dense;
+   }
+   template<typename Allocator>
+   void roaring_bitmap<Allocator>::chunk::to_runs()
+   {
+      if (kind_ == runs)
+         return;
+      values_type a(values_.get_allocator());
+      a.reserve(run_count() * 2);
+      push_run f = { &a };
+      if (kind_ == dense)
+      {
+         dense_->for_each_set(f);
+         delete_dense();
+      }
+      else
+         for (const low_type *i = values_.begin(); i != values_.end(); ++i)
+            f(*i);
+      replace_values(a);
+      kind_ = runs;
+   }
+   template<typename Allocator>
+   void roaring_bitmap<Allocator>::chunk::optimize()
+   {
+      if (!count_)
+         return;
+      const size_type array_bytes = count_ <= array_max ? count_ * 2: (size_type)-1;
+      const size_type runs_bytes = run_count() * 4;
+      if (runs_bytes < array_bytes && runs_bytes < dense_bytes)
+         to_runs();
+      else if (array_bytes <= dense_bytes)
+         to_array();
+      else
+         to_dense();
+   }
+
+   template<typename Allocator>
+   void roaring_bitmap<Allocator>::chunk::unite(const chunk &other)
+   {
+      if (kind_ == array && other.kind_ == array)
+      {
+         values_type a(values_.get_allocator());
+         a.reserve(values_.size() + other.values_.size());
+         const low_type *i = values_.begin(), *j = other.values_.begin();
+         while (i != values_.end() && j != other.values_.end())
+            if (*i < *j)
+               a.push_back(*i++);
+            else if (*j < *i)
+               a.push_back(*j++);
+            else
+            {
+               a.push_back(*i++);
+               ++j;
+            }
+         for (; i != values_.end(); ++i)
+            a.push_back(*i);
+         for (; j != other.values_.end(); ++j)
+            a.push_back(*j);
+         replace_values(a);
+         count_ = values_.size();
+      }
+      else
+      {
+         to_dense();
+         other.set_into(*dense_);
+         count_ = dense_->count();
+      }
+      optimize();
+   }
+   template<typename Allocator>
+   void roaring_bitmap<Allocator>::chunk::intersect(const chunk &other)
+   {
+      if (kind_ == array || other.kind_ == array)
+      {
+         // the values of the array found in the other chunk
+         const chunk &a = kind_ == array ? *this: other, &b = kind_ == array ? other: *this;
+         values_type r(values_.get_allocator());
+         r.reserve(a.values_.size());
+         for (const low_type *i = a.values_.begin(); i != a.values_.end(); ++i)
+            if (b.contains(*i))
+               r.push_back(*i);
+         delete_dense();
+         replace_values(r);
+         kind_ = array;
+         count_ = values_.size();
+      }
+      else
+      {
+         to_dense();
+         if (other.kind_ == dense)
+            *dense_ &= *other.dense_;
+         else
+         {
+            dense_type d;
+            other.set_into(d);
+            *dense_ &= d;
+         }
+         count_ = dense_->count();
+      }
+      optimize();
+   }
+   template<typename Allocator>
+   void roaring_bitmap<Allocator>::chunk::subtract(const chunk &other)
+   {
+      if (kind_ == array)
+      {
+         values_type r(values_.get_allocator());
+         r.reserve(values_.size());
+         for (const low_type *i = values_.begin(); i != values_.end(); ++i)
+            if (!other.contains(*i))
+               r.push_back(*i);
+         replace_values(r);
+         count_ = values_.size();
+      }
+      else
+      {
+         to_dense();
+         if (other.kind_ == array)
+            for (const low_type *i = other.values_.begin(); i != other.values_.end(); ++i)
+               dense_->reset(*i);
+         else if (other.kind_ == runs)
+            for (size_type r = 0; r < other.runs_size(); ++r)
+               reset_range(*dense_, other.first(r), other.last(r));
+         else
+            *dense_ &= ~*other.dense_;
+         count_ = dense_->count();
+      }
+      optimize();
+   }
+
+   template<typename Allocator>
+   void roaring_bitmap<Allocator>::const_iterator::first()
+   {
+      index_ = 0;
+      low_ = 0;
+      if (c_ == end_)
+         return;
+      const chunk &k = c_->second;
+      low_ = k.kind_ == chunk::dense ? (value_type)k.dense_->find_first(): k.values_[0];
+   }
+   template<typename Allocator>
+   typename roaring_bitmap<Allocator>::const_iterator &roaring_bitmap<Allocator>::const_iterator::operator++()
+   {
+      const chunk &k = c_->second;
+      switch (k.kind_)
+      {
+      case chunk::array:
+         if (++index_ < k.values_.size())
+         {
+            low_ = k.values_[index_];
+            return *this;
+         }
+         break;
+      case chunk::dense:
+         low_ = (value_type)k.dense_->find_next(low_);
+         if (low_ < k.dense_->size())
+            return *this;
+         break;
+      default:
+         if (low_ < k.last(index_))
+         {
+            ++low_;
+            return *this;
+         }
+         if (++index_ < k.runs_size())
+         {
+            low_ = k.first(index_);
+            return *this;
+         }
+      }
+      ++c_;
+      first();
+      return *this;
+   }
+
+   template<typename Allocator>
+   template<class UnaryFunction>
+   UnaryFunction roaring_bitmap<Allocator>::for_each(UnaryFunction f) const
+   {
+      for (typename directory::const_iterator c = chunks_.begin(); c != chunks_.end(); ++c)
+      {
+         const value_type high = (value_type)c->first << 16;
+         const chunk &k = c->second;
+         if (k.kind_ == chunk::array)
+            for (const low_type *i = k.values_.begin(); i != k.values_.end(); ++i)
+               f(high | *i);
+         else if (k.kind_ == chunk::dense)
+         {
+            offset<UnaryFunction> o = { &f, high };
+            k.dense_->for_each_set(o);
+         }
+         else
+            for (size_type r = 0; r < k.runs_size(); ++r)
+               for (value_type v = k.first(r); v <= k.last(r); ++v)
+                  f(high | v);
+      }
+      return f;
+   }
+
+   template<typename Allocator>
+   roaring_bitmap<Allocator> &roaring_bitmap<Allocator>::operator|=(const roaring_bitmap &other)
+   {
+      if (this == &other)
+         return *this;
+      for (typename directory::const_iterator j = other.chunks_.begin(); j != other.chunks_.end(); ++j)
+      {
+         typename directory::iterator i = chunks_.find(j->first);
+         if (i == chunks_.end())
+            chunks_.insert(*j);
+         else
+            i->second.unite(j->second);
+      }
+      return *this;
+   }
+   template<typename Allocator>
+   roaring_bitmap<Allocator> &roaring_bitmap<Allocator>::operator&=(const roaring_bitmap &other)
+   {
+      if (this == &other)
+         return *this;
+      for (typename directory::iterator i = chunks_.begin(); i != chunks_.end();)
+      {
+         typename directory::const_iterator j = other.chunks_.find(i->first);
+         if (j != other.chunks_.end())
+         {
+            i->second.intersect(j->second);
+            if (i->second.count_)
+            {
+               ++i;
+               continue;
+            }
+         }
+         i = chunks_.erase(i);
+      }
+      return *this;
+   }
+   template<typename Allocator>
+   roaring_bitmap<Allocator> &roaring_bitmap<Allocator>::operator-=(const roaring_bitmap &other)
+   {
+      if (this == &other)
+      {
+         clear();
+         return *this;
+      }
+      for (typename directory::const_iterator j = other.chunks_.begin(); j != other.chunks_.end(); ++j)
+      {
+         typename directory::iterator i = chunks_.find(j->first);
+         if (i == chunks_.end())
+            continue;
+         i->second.subtract(j->second);
+         if (!i->second.count_)
+            chunks_.erase(i);
+      }
+      return *this;
+   }
+
+   template<typename Allocator>
+   bool roaring_bitmap<Allocator>::operator==(const roaring_bitmap &other) const
+   {
+      if (chunks_.size() != other.chunks_.size() || cardinality() != other.cardinality())
+         return false;
+      for (const_iterator i = begin(), j = other.begin(); i != end(); ++i, ++j)
+         if (*i != *j)
+            return false;
+      return true;
+   }
+
+   template<typename Allocator>
+   typename roaring_bitmap<Allocator>::size_type roaring_bitmap<Allocator>::serialized_bytes() const
+   {
+      size_type n = 4;
+      for (typename directory::const_iterator i = chunks_.begin(); i != chunks_.end(); ++i)
+         n += 8 + (i->second.kind_ == chunk::dense ? (size_type)dense_bytes: i->second.values_.size() * 2);
+      return n;
+   }
+   template<typename Allocator>
+   void roaring_bitmap<Allocator>::serialize(void *buffer) const
+   {
+      unsigned char *p = static_cast<unsigned char *>(buffer);
+      const unsigned n = (unsigned)chunks_.size();
+      memcpy(p, &n, 4);
+      p += 4;
+      for (typename directory::const_iterator i = chunks_.begin(); i != chunks_.end(); ++i)
+      {
+         const chunk &k = i->second;
+         const low_type key = i->first, kind = (low_type)k.kind_;
+         const void *data = k.kind_ == chunk::dense ? (const void *)k.dense_->data(): (const void *)k.values_.data();
+         const unsigned bytes = k.kind_ == chunk::dense ? (unsigned)dense_bytes: (unsigned)k.values_.size() * 2;
+         const unsigned words = bytes / 2;
+         memcpy(p, &key, 2);
+         memcpy(p + 2, &kind, 2);
+         memcpy(p + 4, &words, 4);
+         memcpy(p + 8, data, bytes);
+         p += 8 + bytes;
+      }
+   }
+   template<typename Allocator>
+   bool roaring_bitmap<Allocator>::deserialize(const void *buffer, size_type bytes)
+   {
+      clear();
+      const unsigned char *p = static_cast<const unsigned char *>(buffer), *end = p + bytes;
+      unsigned n;
+      if (bytes < 4)
+         return false;
+      memcpy(&n, p, 4);
+      p += 4;
+      long previous = -1;
+      for (; n; --n)
+      {
+         low_type key, kind;
+         unsigned words;
+         if (end - p < 8)
+            break;
+         memcpy(&key, p, 2);
+         memcpy(&kind, p + 2, 2);
+         memcpy(&words, p + 4, 4);
+         p += 8;
+         if ((long)key <= previous || kind > chunk::runs || (size_type)(end - p) / 2 < words || !words)
+            break;
+         previous = key;
+         chunk &k = find_or_add(key)->second;
+         k.kind_ = (typename chunk::kind_type)kind;
+         if (k.kind_ == chunk::dense)
+         {
+            if (words * 2 != (unsigned)dense_bytes)
+               break;
+            k.dense_ = k.new_dense();
+            memcpy(k.dense_->data(), p, dense_bytes);
+            k.count_ = k.dense_->count();
+         }
+         else
+         {
+            k.values_.resize(words);
+            memcpy(k.values_.data(), p, words * 2);
+            k.count_ = 0;
+            if (k.kind_ == chunk::array)
+            {
+               if (words > array_max)
+                  break;
+               unsigned i = 1;
+               while (i < words && k.values_[i - 1] < k.values_[i])
+                  ++i;
+               k.count_ = i == words ? words: 0;
+            }
+            else
+            {
+               if (words % 2)
+                  break;
+               size_type runs = 0;
+               for (size_type r = 0; r < k.runs_size(); ++r, ++runs)
+               {
+                  if (k.first(r) > k.last(r) || (r && k.first(r) <= k.last(r - 1)))
+                     break;
+                  k.count_ += k.last(r) - k.first(r) + 1u;
+               }
+               if (runs != k.runs_size())
+                  k.count_ = 0;
+            }
+         }
+         p += words * 2;
+         if (!k.count_)
+            break;
+      }
+      if (n || p != end)
+      {
+         clear();
+         return false;
+      }
+      return true;
+   }
+
+   template<typename Allocator>
+   roaring_bitmap<Allocator> operator|(const roaring_bitmap<Allocator> &a, const roaring_bitmap<Allocator> &b)
+   {
+      roaring_bitmap<Allocator> r(a);
+      return r |= b;
+   }
+   template<typename Allocator>
+   roaring_bitmap<Allocator> operator&(const roaring_bitmap<Allocator> &a, const roaring_bitmap<Allocator> &b)
+   {
+      roaring_bitmap<Allocator> r(a);
+      return r &= b;
+   }
+   template<typename Allocator>
+   roaring_bitmap<Allocator> operator-(const roaring_bitmap<Allocator> &a, const roaring_bitmap<Allocator> &b)
+   {
+      roaring_bitmap<Allocator> r(a);
+      return r -= b;
+   }
+   template<typename Allocator>
+   inline void swap(roaring_bitmap<Allocator> &a, roaring_bitmap<Allocator> &b)
+   {
+      a.swap(b);
+   }
+}
+
+#endif // _TINY_TEMPLATE_LIBRARY_ROARING_BITMAP_HPP_
@@ -14,7 +14,7 @@
 
 namespace ttl
 {
-   template<typename KT, typename Compare = less<KT> >
+   template<typename KT, typename Compare = less<KT>, typename Allocator = allocator>
    class set // unique keys to values
    {
    public:
@@ -30,7 +30,7 @@ namespace ttl
       typedef const value_type *const_pointer;
 
    private:
-      typedef rbtree<KT,KT,select_same<KT>,Compare> tree_type;
+      typedef rbtree<KT,KT,select_same<KT>,Compare,Allocator> tree_type;
       typedef typename tree_type::node node_type;
 
       tree_type rbtree_;
@@ -40,9 +40,9 @@ namespace ttl
 
       struct iterator
       {
-         typedef typename set<KT,Compare>::node_type node_type;
+         typedef typename set<KT,Compare,Allocator>::node_type node_type;
       public:
-         typedef set<KT,Compare>::value_type value_type;
+         typedef set<KT,Compare,Allocator>::value_type value_type;
          typedef ttl::ptrdiff_t difference_type;
          typedef value_type *pointer;
          typedef value_type *reference;
@@ -74,16 +74,16 @@ namespace ttl
          bool operator!=(const const_iterator &other) const { return other != *this; }
       private:
          node_type *ptr_;
-         friend class set<KT,Compare>;
-         friend class set<KT,Compare>::const_iterator;
+         friend class set<KT,Compare,Allocator>;
+         friend class set<KT,Compare,Allocator>::const_iterator;
          iterator(node_type *ptr): ptr_(ptr) {}
          static node_type *prev(const node_type *);
       };
       struct const_iterator
       {
-         typedef typename set<KT,Compare>::iterator::node_type node_type;
+         typedef typename set<KT,Compare,Allocator>::iterator::node_type node_type;
       public:
-         typedef set<KT,Compare>::value_type value_type;
+         typedef set<KT,Compare,Allocator>::value_type value_type;
          typedef ttl::ptrdiff_t difference_type;
          typedef value_type *pointer;
          typedef value_type *reference;
@@ -121,7 +121,7 @@ namespace ttl
          const_iterator(const iterator &other): ptr_(other.ptr_) {}
       private:
          const node_type *ptr_;
-         friend class set<KT,Compare>;
+         friend class set<KT,Compare,Allocator>;
          const_iterator(const node_type *ptr): ptr_(ptr) {}
       };
 
@@ -155,9 +155,10 @@ namespace ttl
       }
 
       explicit set() {}
+      explicit set(const Allocator &a): rbtree_(a) {}
       ~set() {}
 
-      set(const set &other)
+      set(const set &other): rbtree_(other.get_allocator())
       {
          rbtree_.assign(other.rbtree_);
       }
@@ -183,6 +184,9 @@ namespace ttl
 
       template<class InputIt> void insert(InputIt first, InputIt last);
 
+      Allocator &get_allocator() { return rbtree_.get_allocator(); }
+      const Allocator &get_allocator() const { return rbtree_.get_allocator(); }
+
       void clear()
       {
          rbtree_.clear();
@@ -192,13 +196,18 @@ namespace ttl
       bool empty() const { return !rbtree_.get_root(); }
       size_type max_size() const { return (size_type)-1 / sizeof(node_type); }
 
+      // operation counters (with TTL_RBTREE_STATS) and shape of the tree
+      void stats(rbtree_stats &s) const { rbtree_.stats(s); }
+      void reset_stats() { rbtree_.reset_stats(); }
+
       iterator erase(const_iterator pos);
       iterator erase(const_iterator first, const_iterator last);
 
       size_type erase(const KT &key)
       {
          node_type *n = rbtree_.remove(key);
-         delete n;
+         if (n)
+            rbtree_.delete_node(n);
          return !!n;
       }
 
@@ -223,19 +232,32 @@ namespace ttl
 
       pair<iterator, iterator> equal_range(const KT &key);
       pair<const_iterator, const_iterator> equal_range(const KT &key) const;
+
+      // The keys in [lo, hi): see rbtree::count_range for the complexity
+      size_type count_range(const KT &lo, const KT &hi) const { return rbtree_.count_range(lo, hi); }
+      iterator_range<iterator> range(const KT &lo, const KT &hi)
+      {
+         iterator first = lower_bound(lo);
+         return iterator_range<iterator>(first, Compare()(lo, hi) ? lower_bound(hi): first);
+      }
+      iterator_range<const_iterator> range(const KT &lo, const KT &hi) const
+      {
+         const_iterator first = lower_bound(lo);
+         return iterator_range<const_iterator>(first, Compare()(lo, hi) ? lower_bound(hi): first);
+      }
    };
 
-   template<typename KT, typename Compare>
+   template<typename KT, typename Compare, typename Allocator>
    template<class InputIt>
-   void set<KT,Compare>::insert(InputIt first, InputIt last)
+   void set<KT,Compare,Allocator>::insert(InputIt first, InputIt last)
    {
       for (; first != last; ++first)
          rbtree_.insert_unique(*first);
    }
 
-   template<typename KT, typename Compare>
-   typename set<KT,Compare>::iterator::node_type *
-   set<KT,Compare>::iterator::prev(const node_type *n)
+   template<typename KT, typename Compare, typename Allocator>
+   typename set<KT,Compare,Allocator>::iterator::node_type *
+   set<KT,Compare,Allocator>::iterator::prev(const node_type *n)
    {
       // check if it is the sentinel/header
       if (!n->parent)
@@ -247,16 +269,16 @@ namespace ttl
       return const_cast<node_type *>(n);
    }
 
-   template<typename KT, typename Compare>
-   typename set<KT,Compare>::iterator set<KT,Compare>::upper_bound(const KT &key)
+   template<typename KT, typename Compare, typename Allocator>
+   typename set<KT,Compare,Allocator>::iterator set<KT,Compare,Allocator>::upper_bound(const KT &key)
    {
       node_type *lo = rbtree_.lower_bound(key);
       if (lo == rbtree_.end())
          return end();
       return iterator(static_cast<node_type *>(rbtree_base::next_node(lo)));
    }
-   template<typename KT, typename Compare>
-   typename set<KT,Compare>::const_iterator set<KT,Compare>::upper_bound(const KT &key) const
+   template<typename KT, typename Compare, typename Allocator>
+   typename set<KT,Compare,Allocator>::const_iterator set<KT,Compare,Allocator>::upper_bound(const KT &key) const
    {
       const node_type *lo = rbtree_.lower_bound(key);
       if (lo == rbtree_.end())
@@ -264,9 +286,9 @@ namespace ttl
       return const_iterator(static_cast<const node_type *>(rbtree_base::next_node(lo)));
    }
 
-   template<typename KT, typename Compare>
-   pair<typename set<KT,Compare>::iterator, typename set<KT,Compare>::iterator>
-   set<KT,Compare>::equal_range(const KT &key)
+   template<typename KT, typename Compare, typename Allocator>
+   pair<typename set<KT,Compare,Allocator>::iterator, typename set<KT,Compare,Allocator>::iterator>
+   set<KT,Compare,Allocator>::equal_range(const KT &key)
    {
       node_type *lo = rbtree_.lower_bound(key);
       node_type *up = lo;
@@ -274,9 +296,9 @@ namespace ttl
          up = static_cast<node_type *>(rbtree_base::next_node(lo));
       return pair<iterator, iterator>(iterator(lo), iterator(up));
    }
-   template<typename KT, typename Compare>
-   pair<typename set<KT,Compare>::const_iterator, typename set<KT,Compare>::const_iterator>
-   set<KT,Compare>::equal_range(const KT &key) const
+   template<typename KT, typename Compare, typename Allocator>
+   pair<typename set<KT,Compare,Allocator>::const_iterator, typename set<KT,Compare,Allocator>::const_iterator>
+   set<KT,Compare,Allocator>::equal_range(const KT &key) const
    {
       const node_type *lo = rbtree_.lower_bound(key);
       const node_type *up = lo;
@@ -288,13 +310,13 @@ namespace ttl
    template<class InputIt1, class InputIt2>
    bool equal(InputIt1, InputIt1, InputIt2, InputIt2);
 
-   template <typename T>
-   bool operator==(const set<T> &a, const set<T> &b)
+   template<typename KT, typename Compare, typename Allocator>
+   bool operator==(const set<KT,Compare,Allocator> &a, const set<KT,Compare,Allocator> &b)
    {
       return ttl::equal(a.begin(), a.end(), b.begin(), b.end());
    }
-   template <typename T>
-   bool operator!=(const set<T> &a, const set<T> &b)
+   template<typename KT, typename Compare, typename Allocator>
+   bool operator!=(const set<KT,Compare,Allocator> &a, const set<KT,Compare,Allocator> &b)
    {
       return !(a == b);
    }
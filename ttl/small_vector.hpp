@@ -0,0 +1,363 @@
+/////////////////////////////////////////////////// vim: sw=3 ts=8 et
+//
+// Tiny Template Library: an implementation of STL vector which keeps up
+// to N elements in place and moves them to the heap when it grows beyond
+// that. Unlike fixed_vector it never drops elements, unlike vector it does
+// not allocate while small. The heap storage grows geometrically.
+//
+// This code is Public Domain
+//
+#ifndef _TINY_TEMPLATE_LIBRARY_SMALL_VECTOR_HPP_
+#define _TINY_TEMPLATE_LIBRARY_SMALL_VECTOR_HPP_ 1
+
+#include <new>
+#include "types.hpp"
+#include "type_traits.hpp"
+#include "allocator.hpp"
+
+namespace ttl
+{
+   template<class InputIt1, class InputIt2> bool equal(InputIt1, InputIt1, InputIt2, InputIt2);
+
+   template<typename T, const unsigned int N, typename Allocator = allocator>
+   class small_vector: private Allocator // empty allocators take no space
+   {
+   public:
+      typedef T              value_type;
+      typedef T             *pointer;
+      typedef const T       *const_pointer;
+      typedef T             &reference;
+      typedef const T       &const_reference;
+      typedef T             *iterator;
+      typedef const T       *const_iterator;
+      typedef ttl::size_t    size_type;
+      typedef ttl::ptrdiff_t difference_type;
+
+   private:
+      T *elements_, *last_, *end_of_elements_;
+      storage_for<T> bytes_[N];
+
+      T *inline_elements() const { return (T *)bytes_; }
+
+      // value constructors (VCs) used to pass new elements to the insertion
+      // routine, insert_values
+      struct vc_args { };
+      struct vc_counter_args: vc_args
+      {
+         const value_type &x;
+         vc_counter_args(const value_type &_x): x(_x) {}
+      };
+      void vc_counter(T *p, vc_args &args) const
+      {
+         ::new(p) T(static_cast<vc_counter_args &>(args).x);
+      }
+      template<typename InputIterator>
+      struct vc_iterator_args: vc_args
+      {
+         InputIterator first;
+         vc_iterator_args(const InputIterator &i): first(i) {}
+      };
+      template<typename InputIterator>
+      void vc_iterator(T *p, vc_args &args) const
+      {
+         InputIterator &i = static_cast<vc_iterator_args<InputIterator> &>(args).first;
+         ::new(p) T(*i);
+         ++i;
+      }
+      iterator insert_values(const_iterator pos, difference_type n, void (ttl::small_vector<T,N,Allocator>::*)(T *, vc_args &) const, vc_args &);
+
+      size_type grown_capacity(size_type n) const
+      {
+         size_type c = capacity() * 2;
+         return c < size() + n ? size() + n: c;
+      }
+      T *allocate_elements(size_type n)
+      {
+         return static_cast<T *>(Allocator::allocate(n * sizeof(T)));
+      }
+      void release()
+      {
+         if (elements_ != inline_elements())
+            Allocator::deallocate(elements_, capacity() * sizeof(T));
+      }
+
+   public:
+      small_vector(): elements_(inline_elements()), last_(elements_), end_of_elements_(elements_ + N) {}
+      explicit small_vector(const Allocator &a):
+         Allocator(a), elements_(inline_elements()), last_(elements_), end_of_elements_(elements_ + N) {}
+      explicit small_vector(size_type n);
+      explicit small_vector(size_type n, const value_type &);
+      small_vector(const small_vector &other);
+      template<typename RandomAccessIterator>
+      small_vector(RandomAccessIterator first, RandomAccessIterator last);
+
+      ~small_vector()
+      {
+         clear();
+         release();
+      }
+
+      small_vector& operator=(const small_vector &other);
+
+      Allocator &get_allocator() { return *this; }
+      const Allocator &get_allocator() const { return *this; }
+
+      void assign(size_type n, const value_type &value);
+      template<typename InputIterator>
+      void assign(InputIterator first, InputIterator last)
+      {
+         clear();
+         for (; first != last; ++first)
+            push_back(*first);
+      }
+
+      iterator       begin() { return elements_; }
+      const_iterator begin() const { return elements_; }
+      iterator       end() { return last_; }
+      const_iterator end() const { return last_; }
+      const_iterator cbegin() const { return elements_; }
+      const_iterator cend() const { return last_; }
+
+      size_type size() const { return last_ - elements_; }
+      bool empty() const { return size() == 0; }
+      size_type max_size() const { return (ttl::size_t)-1 / sizeof(T); }
+      size_type capacity() const { return end_of_elements_ - elements_; }
+      static size_type inline_capacity() { return N; }
+      // true while the elements are in the inline storage
+      bool is_inline() const { return elements_ == inline_elements(); }
+
+      void resize(size_type new_size);
+
+      void resize(size_type new_size, const value_type &x)
+      {
+         if (new_size < size())
+            resize(new_size);
+         else
+            insert(end(), new_size - size(), x);
+      }
+
+      void reserve(size_type n);
+
+      reference operator[](size_type n) { return *(elements_ + n); }
+      const_reference operator[](size_type n) const { return *(elements_ + n); }
+      reference at(size_type n) { return (*this)[n]; }
+      const_reference at(size_type n) const { return (*this)[n]; }
+      reference front() { return *begin(); }
+      const_reference front() const { return *begin(); }
+      reference back() { return *(end() - 1); }
+      const_reference back() const { return *(end() - 1); }
+      pointer data() { return pointer(elements_); }
+      const_pointer data() const { return const_pointer(elements_); }
+
+      iterator insert(const_iterator pos, size_type n, const value_type &x)
+      {
+         vc_counter_args args(x);
+         return insert_values(pos, n, &ttl::small_vector<T,N,Allocator>::vc_counter, args);
+      }
+
+      iterator insert(const_iterator pos, const value_type &x)
+      {
+         vc_counter_args args(x);
+         return insert_values(pos, 1, &ttl::small_vector<T,N,Allocator>::vc_counter, args);
+      }
+
+      template<typename InputIterator>
+      iterator insert(const_iterator pos, InputIterator first, InputIterator last)
+      {
+         vc_iterator_args<InputIterator> args(first);
+         return insert_values(pos, last - first, &ttl::small_vector<T,N,Allocator>::template vc_iterator<InputIterator>, args);
+      }
+
+      void push_back(const value_type &x)
+      {
+         if (last_ < end_of_elements_)
+            new(last_++) T(x);
+         else
+            insert(end(), (size_type)1, x);
+      }
+
+      void pop_back()
+      {
+         (--last_)->~T();
+      }
+
+      iterator erase(const_iterator first, const_iterator last);
+
+      iterator erase(const_iterator pos)
+      {
+         return erase(pos, pos + 1);
+      }
+
+      void swap(small_vector& x)
+      {
+         small_vector tmp(*this);
+         *this = x;
+         x = tmp;
+      }
+
+      void clear()
+      {
+         while (last_ > elements_)
+            (--last_)->~T();
+      }
+   };
+
+   template<typename T, const unsigned int N, typename Allocator>
+   small_vector<T,N,Allocator>::small_vector(size_type n):
+      elements_(inline_elements()), last_(elements_), end_of_elements_(elements_ + N)
+   {
+      reserve(n);
+      while (n--)
+         ::new(last_++) T();
+   }
+   template<typename T, const unsigned int N, typename Allocator>
+   small_vector<T,N,Allocator>::small_vector(size_type n, const value_type &value):
+      elements_(inline_elements()), last_(elements_), end_of_elements_(elements_ + N)
+   {
+      reserve(n);
+      while (n--)
+         ::new(last_++) T(value);
+   }
+   template<typename T, const unsigned int N, typename Allocator>
+   small_vector<T,N,Allocator>::small_vector(const small_vector &other):
+      Allocator(other), elements_(inline_elements()), last_(elements_), end_of_elements_(elements_ + N)
+   {
+      reserve(other.size());
+      for (const_iterator i = other.cbegin(); i != other.cend(); ++i)
+         ::new(last_++) T(*i);
+   }
+   template<typename T, const unsigned int N, typename Allocator>
+   template<typename RandomAccessIterator>
+   small_vector<T,N,Allocator>::small_vector(RandomAccessIterator first, RandomAccessIterator last):
+      elements_(inline_elements()), last_(elements_), end_of_elements_(elements_ + N)
+   {
+      reserve(last - first);
+      for (; first != last; ++first)
+         ::new(last_++) T(*first);
+   }
+   template<typename T, const unsigned int N, typename Allocator>
+   small_vector<T,N,Allocator> &small_vector<T,N,Allocator>::operator=(const small_vector &other)
+   {
+      if (this == &other)
+         return *this;
+      clear();
+      reserve(other.size());
+      for (const_iterator i = other.cbegin(); i != other.cend(); ++i)
+         ::new(last_++) T(*i);
+      return *this;
+   }
+   template<typename T, const unsigned int N, typename Allocator>
+   void small_vector<T,N,Allocator>::assign(size_type n, const value_type &value)
+   {
+      clear();
+      reserve(n);
+      while (n--)
+         ::new(last_++) T(value);
+   }
+   template<typename T, const unsigned int N, typename Allocator>
+   void small_vector<T,N,Allocator>::resize(size_type new_size)
+   {
+      if (new_size < size())
+         for (T *pos = elements_ + new_size; last_ > pos;)
+            (--last_)->~T();
+      else
+         insert(end(), new_size - size(), value_type());
+   }
+   template<typename T, const unsigned int N, typename Allocator>
+   void small_vector<T,N,Allocator>::reserve(size_type n)
+   {
+      if (n <= capacity())
+         return;
+      T *newelements = allocate_elements(n);
+      T *o = newelements, *i = elements_;
+      for (; i != last_; ++i)
+         ::new(o++) T(*i);
+      for (; i > elements_; )
+         (--i)->~T();
+      release();
+      elements_ = newelements;
+      end_of_elements_ = elements_ + n;
+      last_ = o;
+   }
+
+   template<typename T, const unsigned int N, typename Allocator>
+   typename small_vector<T,N,Allocator>::iterator small_vector<T,N,Allocator>::insert_values(const_iterator pos,
+                                                                         difference_type n,
+                                                                         void (ttl::small_vector<T,N,Allocator>::* vc)(T *, vc_args &) const,
+                                                                         vc_args &args)
+   {
+      difference_type dist = pos - cbegin();
+      if (n > 0)
+      {
+         T *o;
+         const T *i;
+         if (end_of_elements_ - last_ < n)
+         {
+            size_type newcapacity = grown_capacity(n);
+            T *newelements = o = allocate_elements(newcapacity);
+            for (i = elements_; i != pos; ++i)
+               ::new(o++) T(*i);
+            while (n-- > 0)
+               (this->*vc)(o++, args);
+            for (; i != last_; ++i)
+               ::new(o++) T(*i);
+            for (; i > elements_; )
+               (--i)->~T();
+            release();
+            elements_ = newelements;
+            end_of_elements_ = elements_ + newcapacity;
+            last_ = o;
+         }
+         else
+         {
+            if (pos < end())
+            {
+               i = last_;
+               last_ += n;
+               for (o = last_; i != pos; )
+               {
+                  ::new(--o) T(*--i);
+                  i->~T();
+               }
+               for (o = elements_ + dist; n-- > 0; ++o)
+                  (this->*vc)(o, args);
+            }
+            else
+            {
+               for (o = last_; n-- > 0;)
+                  (this->*vc)(last_++, args);
+            }
+         }
+      }
+      return begin() + dist;
+   }
+
+   template<typename T, const unsigned int N, typename Allocator>
+   typename small_vector<T,N,Allocator>::iterator small_vector<T,N,Allocator>::erase(const_iterator first, const_iterator last)
+   {
+      difference_type off = first - begin();
+      difference_type lastoff = last - begin();
+      for (T *f = elements_ + off, *l = elements_ + lastoff; f != l;)
+         (--l)->~T();
+      T *o = elements_ + off;
+      for (T *i = elements_ + lastoff; i != last_; ++i)
+      {
+         ::new(o++) T(*i);
+         i->~T();
+      }
+      last_ = o;
+      return begin() + off;
+   }
+   template<typename T, const unsigned int N, typename Allocator>
+   inline bool operator==(const small_vector<T,N,Allocator> &a, const small_vector<T,N,Allocator> &b)
+   {
+      return ttl::equal(a.begin(), a.end(), b.begin(), b.end());
+   }
+   template<typename T, const unsigned int N, typename Allocator>
+   inline bool operator!=(const small_vector<T,N,Allocator> &a, const small_vector<T,N,Allocator> &b)
+   {
+      return !(a == b);
+   }
+}
+
+#endif // _TINY_TEMPLATE_LIBRARY_SMALL_VECTOR_HPP_
@@ -0,0 +1,319 @@
+/////////////////////////////////////////////////// vim: sw=3 ts=8 et
+//
+// Tiny Template Library: a vector of records kept as a structure of
+// arrays (C++11)
+//
+// soa_vector<A, B, C> keeps one array per field, with a shared size and
+// capacity, so a scan of one field reads only that field's memory. The
+// columns are plain arrays (column<I>() and data<I>()), usable with any
+// algorithm; the iterators step over whole records, as proxies with
+// get<I>() to their fields:
+//
+//    ttl::soa_vector<int, double> v;
+//    v.push_back(1, 2.5);
+//    double sum = 0;
+//    for (double d: v.column<1>())
+//       sum += d;
+//    ttl::count_if(v.begin(), v.end(), pred); // pred(row) uses row.get<0>()
+//
+// soa_vector<Ts...> is basic_soa_vector<allocator, Ts...>: the columns
+// come from the Allocator of a basic_soa_vector, one block each.
+//
+// This code is Public Domain
+//
+#ifndef _TINY_TEMPLATE_LIBRARY_SOA_VECTOR_HPP_
+#define _TINY_TEMPLATE_LIBRARY_SOA_VECTOR_HPP_ 1
+
+#if __cplusplus >= 201103L // C++11
+
+#include <new>
+#include <string.h>
+#include "types.hpp"
+#include "type_traits.hpp"
+#include "allocator.hpp"
+#include "utility.hpp"
+
+namespace ttl
+{
+   template<typename T> void swap(T &, T &);
+
+   template<unsigned... Is> struct soa_indices {};
+   template<unsigned N, unsigned... Is> struct make_soa_indices: make_soa_indices<N - 1, N - 1, Is...> {};
+   template<unsigned... Is> struct make_soa_indices<0, Is...> { typedef soa_indices<Is...> type; };
+
+   template<unsigned I, typename T, typename... Ts> struct soa_type_at { typedef typename soa_type_at<I - 1, Ts...>::type type; };
+   template<typename T, typename... Ts> struct soa_type_at<0, T, Ts...> { typedef T type; };
+
+   template<typename Allocator, typename... Ts>
+   class basic_soa_vector: private Allocator // empty allocators take no space
+   {
+   public:
+      typedef ttl::size_t    size_type;
+      typedef ttl::ptrdiff_t difference_type;
+
+      static constexpr unsigned columns = sizeof...(Ts);
+      // the type of the field I
+      template<unsigned I> using field = typename soa_type_at<I, Ts...>::type;
+
+      // a record: the fields of one index in the columns
+      template<class V>
+      class basic_reference
+      {
+         friend class basic_soa_vector;
+         V *v_;
+         size_type i_;
+         basic_reference(V *v, size_type i): v_(v), i_(i) {}
+      public:
+         template<unsigned I> auto get() const -> decltype(this->v_->template data<I>()[0])
+         {
+            return v_->template data<I>()[i_];
+         }
+         size_type index() const { return i_; }
+      };
+      typedef basic_reference<basic_soa_vector> reference;
+      typedef basic_reference<const basic_soa_vector> const_reference;
+
+      template<class V>
+      class basic_iterator
+      {
+      public:
+         typedef basic_reference<V> value_type;
+         typedef basic_reference<V> reference;
+         typedef ttl::ptrdiff_t difference_type;
+
+         basic_iterator(): v_(0), i_(0) {}
+         template<class W>
+         basic_iterator(const basic_iterator<W> &o): v_(o.v_), i_(o.i_) {}
+
+         reference operator*() const { return reference(v_, i_); }
+         reference operator[](difference_type n) const { return reference(v_, i_ + n); }
+
+         basic_iterator &operator++() { ++i_; return *this; }
+         basic_iterator operator++(int) { basic_iterator t(*this); ++i_; return t; }
+         basic_iterator &operator--() { --i_; return *this; }
+         basic_iterator operator--(int) { basic_iterator t(*this); --i_; return t; }
+         basic_iterator &operator+=(difference_type n) { i_ += n; return *this; }
+         basic_iterator &operator-=(difference_type n) { i_ -= n; return *this; }
+         basic_iterator operator+(difference_type n) const { return basic_iterator(v_, i_ + n); }
+         basic_iterator operator-(difference_type n) const { return basic_iterator(v_, i_ - n); }
+         difference_type operator-(const basic_iterator &o) const { return difference_type(i_ - o.i_); }
+
+         bool operator==(const basic_iterator &o) const { return i_ == o.i_; }
+         bool operator!=(const basic_iterator &o) const { return i_ != o.i_; }
+         bool operator<(const basic_iterator &o) const { return i_ < o.i_; }
+         bool operator>(const basic_iterator &o) const { return i_ > o.i_; }
+         bool operator<=(const basic_iterator &o) const { return i_ <= o.i_; }
+         bool operator>=(const basic_iterator &o) const { return i_ >= o.i_; }
+      private:
+         friend class basic_soa_vector;
+         template<class W> friend class basic_iterator;
+         V *v_;
+         size_type i_;
+         basic_iterator(V *v, size_type i): v_(v), i_(i) {}
+      };
+      typedef basic_iterator<basic_soa_vector> iterator;
+      typedef basic_iterator<const basic_soa_vector> const_iterator;
+
+      basic_soa_vector(): basic_soa_vector(Allocator()) {}
+      explicit basic_soa_vector(const Allocator &a): Allocator(a), size_(0), capacity_(0)
+      {
+         for (unsigned c = 0; c < columns; ++c)
+            data_[c] = 0;
+      }
+      explicit basic_soa_vector(size_type n): basic_soa_vector() { resize(n); }
+      basic_soa_vector(const basic_soa_vector &other): basic_soa_vector(other.get_allocator()) { *this = other; }
+      basic_soa_vector(basic_soa_vector &&other): basic_soa_vector(other.get_allocator()) { swap(other); }
+      ~basic_soa_vector()
+      {
+         clear();
+         free_columns(indices());
+      }
+
+      basic_soa_vector &operator=(const basic_soa_vector &other)
+      {
+         if (this != &other)
+         {
+            clear();
+            reserve(other.size_);
+            for (; size_ < other.size_; ++size_)
+               copy_at(indices(), size_, other);
+         }
+         return *this;
+      }
+      basic_soa_vector &operator=(basic_soa_vector &&other)
+      {
+         swap(other);
+         return *this;
+      }
+
+      Allocator &get_allocator() { return *this; }
+      const Allocator &get_allocator() const { return *this; }
+
+      iterator       begin() { return iterator(this, 0); }
+      const_iterator begin() const { return const_iterator(this, 0); }
+      iterator       end() { return iterator(this, size_); }
+      const_iterator end() const { return const_iterator(this, size_); }
+      const_iterator cbegin() const { return begin(); }
+      const_iterator cend() const { return end(); }
+
+      size_type size() const { return size_; }
+      bool empty() const { return !size_; }
+      size_type capacity() const { return capacity_; }
+
+      reference operator[](size_type n) { return reference(this, n); }
+      const_reference operator[](size_type n) const { return const_reference(this, n); }
+      reference front() { return reference(this, 0); }
+      const_reference front() const { return const_reference(this, 0); }
+      reference back() { return reference(this, size_ - 1); }
+      const_reference back() const { return const_reference(this, size_ - 1); }
+
+      // the arrays of the fields
+      template<unsigned I> field<I> *data() { return static_cast<field<I> *>(data_[I]); }
+      template<unsigned I> const field<I> *data() const { return static_cast<const field<I> *>(data_[I]); }
+      template<unsigned I> iterator_range<field<I> *> column()
+      {
+         return iterator_range<field<I> *>(data<I>(), data<I>() + size_);
+      }
+      template<unsigned I> iterator_range<const field<I> *> column() const
+      {
+         return iterator_range<const field<I> *>(data<I>(), data<I>() + size_);
+      }
+
+      void push_back(const Ts &... values)
+      {
+         if (size_ == capacity_)
+            grow_push_back(indices(), capacity_ ? capacity_ * 2: 8, values...);
+         else
+            construct_at(indices(), size_, values...);
+         ++size_;
+      }
+      void pop_back()
+      {
+         --size_;
+         destroy(indices(), size_, size_ + 1);
+      }
+
+      void reserve(size_type n)
+      {
+         if (n > capacity_)
+            grow(indices(), n);
+      }
+      void resize(size_type n)
+      {
+         if (n < size_)
+         {
+            destroy(indices(), n, size_);
+            size_ = n;
+            return;
+         }
+         reserve(n);
+         for (; size_ < n; ++size_)
+            construct_at(indices(), size_, Ts()...);
+      }
+      void clear()
+      {
+         destroy(indices(), 0, size_);
+         size_ = 0;
+      }
+
+      void swap(basic_soa_vector &other)
+      {
+         for (unsigned c = 0; c < columns; ++c)
+            ttl::swap(data_[c], other.data_[c]);
+         ttl::swap(size_, other.size_);
+         ttl::swap(capacity_, other.capacity_);
+         ttl::swap(static_cast<Allocator &>(*this), static_cast<Allocator &>(other));
+      }
+
+   private:
+      void *data_[sizeof...(Ts) ? sizeof...(Ts): 1];
+      size_type size_, capacity_;
+
+      typedef typename make_soa_indices<sizeof...(Ts)>::type indices;
+
+      // the pack expansions in the initializers are evaluated in order
+      template<unsigned... Is>
+      void construct_at(soa_indices<Is...>, size_type i, const Ts &... values)
+      {
+         int expand[] = { 0, ((void)::new(data<Is>() + i) Ts(values), 0)... };
+         (void)expand;
+      }
+      template<unsigned... Is>
+      void copy_at(soa_indices<Is...>, size_type i, const basic_soa_vector &other)
+      {
+         int expand[] = { 0, ((void)::new(data<Is>() + i) Ts(other.data<Is>()[i]), 0)... };
+         (void)expand;
+      }
+      template<unsigned... Is>
+      void destroy(soa_indices<Is...>, size_type first, size_type last)
+      {
+         int expand[] = { 0, (destroy_column(data<Is>(), first, last), 0)... };
+         (void)expand;
+      }
+      template<unsigned... Is>
+      void grow(soa_indices<Is...>, size_type n)
+      {
+         int expand[] = { 0, (data_[Is] = move_column(data<Is>(), allocate_column<Ts>(n)), 0)... };
+         (void)expand;
+         capacity_ = n;
+      }
+      // the values may be fields of the vector: they are copied into the
+      // new columns before the old ones go
+      template<unsigned... Is>
+      void grow_push_back(soa_indices<Is...>, size_type n, const Ts &... values)
+      {
+         void *p[] = { allocate_column<Ts>(n)... };
+         int constructed[] = { 0, ((void)::new(static_cast<Ts *>(p[Is]) + size_) Ts(values), 0)... };
+         int moved[] = { 0, (data_[Is] = move_column(data<Is>(), static_cast<Ts *>(p[Is])), 0)... };
+         (void)constructed;
+         (void)moved;
+         capacity_ = n;
+      }
+      template<unsigned... Is>
+      void free_columns(soa_indices<Is...>)
+      {
+         int expand[] = { 0, (Allocator::deallocate(data_[Is], capacity_ * sizeof(Ts)), 0)... };
+         (void)expand;
+      }
+
+      template<typename T>
+      static void destroy_column(T *p, size_type first, size_type last)
+      {
+         if (!is_trivially_destructible<T>::value)
+            for (size_type i = first; i < last; ++i)
+               p[i].~T();
+      }
+      template<typename T>
+      T *allocate_column(size_type n)
+      {
+         return static_cast<T *>(Allocator::allocate(n * sizeof(T)));
+      }
+      // moves the elements of the old column to p, and frees it
+      template<typename T>
+      T *move_column(T *old, T *p)
+      {
+         if (is_trivially_relocatable<T>::value)
+         {
+            if (size_)
+               memcpy(static_cast<void *>(p), static_cast<const void *>(old), size_ * sizeof(T));
+         }
+         else
+            for (size_type i = 0; i < size_; ++i)
+               ttl::relocate(p + i, old + i);
+         Allocator::deallocate(old, capacity_ * sizeof(T));
+         return p;
+      }
+   };
+
+   template<typename... Ts>
+   using soa_vector = basic_soa_vector<allocator, Ts...>;
+
+   template<typename Allocator, typename... Ts>
+   inline void swap(basic_soa_vector<Allocator, Ts...> &a, basic_soa_vector<Allocator, Ts...> &b)
+   {
+      a.swap(b);
+   }
+}
+
+#endif // C++11
+#endif // _TINY_TEMPLATE_LIBRARY_SOA_VECTOR_HPP_
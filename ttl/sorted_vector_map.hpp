@@ -10,14 +10,18 @@
 #ifndef _TINY_TEMPLATE_LIBRARY_SORTED_VECTOR_MAP_HPP_
 #define _TINY_TEMPLATE_LIBRARY_SORTED_VECTOR_MAP_HPP_ 1
 
+#include <new>
 #include "types.hpp"
+#include "allocator.hpp"
 #include "utility.hpp"
 #include "functional.hpp"
 
 namespace ttl
 {
-   template<typename KT, typename T, typename Compare = ttl::less<KT> >
-   class sorted_vector_map // unique keys to values
+   template<typename T> void swap(T &, T &);
+
+   template<typename KT, typename T, typename Compare = ttl::less<KT>, typename Allocator = allocator>
+   class sorted_vector_map: private Allocator // unique keys to values
    {
    public:
       typedef KT key_type;
@@ -38,7 +42,7 @@ namespace ttl
       struct iterator
       {
       public:
-         typedef sorted_vector_map<KT,T,Compare>::value_type value_type;
+         typedef sorted_vector_map<KT,T,Compare,Allocator>::value_type value_type;
          typedef ttl::ptrdiff_t difference_type;
          typedef value_type *pointer;
          typedef value_type *reference;
@@ -56,14 +60,14 @@ namespace ttl
          bool operator!=(const const_iterator &other) const { return other != *this; }
       private:
          value_type **ptr_;
-         friend class sorted_vector_map<KT,T,Compare>;
-         friend class sorted_vector_map<KT,T,Compare>::const_iterator;
+         friend class sorted_vector_map<KT,T,Compare,Allocator>;
+         friend class sorted_vector_map<KT,T,Compare,Allocator>::const_iterator;
          iterator(value_type **ptr): ptr_(ptr) {}
       };
       struct const_iterator
       {
       public:
-         typedef sorted_vector_map<KT,T,Compare>::value_type value_type;
+         typedef sorted_vector_map<KT,T,Compare,Allocator>::value_type value_type;
          typedef ttl::ptrdiff_t difference_type;
          typedef value_type *pointer;
          typedef value_type *reference;
@@ -83,7 +87,7 @@ namespace ttl
          const_iterator(const iterator &other): ptr_(other.ptr_) {}
       private:
          const value_type * const *ptr_;
-         friend class sorted_vector_map<KT,T,Compare>;
+         friend class sorted_vector_map<KT,T,Compare,Allocator>;
          const_iterator(const value_type * const *ptr): ptr_(ptr) {}
       };
 
@@ -91,10 +95,13 @@ namespace ttl
       explicit sorted_vector_map():
          elements_(0), last_(0), end_of_elements_(0)
       {}
+      explicit sorted_vector_map(const Allocator &a):
+         Allocator(a), elements_(0), last_(0), end_of_elements_(0)
+      {}
       sorted_vector_map(const sorted_vector_map& other);
       explicit sorted_vector_map(size_type prealloc)
       {
-         elements_ = last_ = new value_type*[prealloc];
+         elements_ = last_ = allocate_pointers(prealloc);
          end_of_elements_ = elements_ + prealloc;
       }
       template<class InputIt>
@@ -103,12 +110,15 @@ namespace ttl
       ~sorted_vector_map()
       {
          for (value_type **i = elements_; i != last_; ++i)
-            delete *i;
-         delete [] elements_;
+            delete_value(*i);
+         deallocate_pointers();
       }
 
       sorted_vector_map &operator=(const sorted_vector_map &other);
 
+      Allocator &get_allocator() { return *this; }
+      const Allocator &get_allocator() const { return *this; }
+
       T &operator[](const KT &key)
       {
          iterator i = find_insert_pos(key);
@@ -134,7 +144,7 @@ namespace ttl
       void clear()
       {
          while (last_ > elements_)
-            delete *--last_;
+            delete_value(*--last_);
       }
 
       ttl::pair<iterator,bool> insert(const value_type &value)
@@ -158,7 +168,7 @@ namespace ttl
       iterator find(const KT &key);
       const_iterator find(const KT &key) const;
 
-      size_type count(const KT &key) const { return find(key) == cend(); }
+      size_type count(const KT &key) const { return find(key) != cend(); }
 
       ttl::pair<iterator,iterator> equal_range(const KT &key)
       {
@@ -200,7 +210,7 @@ namespace ttl
       struct value_compare
       {
       protected:
-         friend class sorted_vector_map<KT, T, Compare>;
+         friend class sorted_vector_map<KT,T,Compare,Allocator>;
          value_compare() {}
       public:
          typedef value_type first_argument_type;
@@ -216,24 +226,125 @@ namespace ttl
 
    private:
       value_type **elements_, **last_, **end_of_elements_;
+
+      // both the pointer array and the elements come from the allocator
+      value_type **allocate_pointers(size_type n)
+      {
+         return static_cast<value_type **>(Allocator::allocate(n * sizeof(value_type *)));
+      }
+      void deallocate_pointers()
+      {
+         Allocator::deallocate(elements_, (end_of_elements_ - elements_) * sizeof(value_type *));
+      }
+      value_type *new_value(const value_type &v)
+      {
+         return ::new(Allocator::allocate(sizeof(value_type))) value_type(v);
+      }
+      void delete_value(value_type *p)
+      {
+         p->~value_type();
+         Allocator::deallocate(p, sizeof(value_type));
+      }
       iterator insert_before(iterator, const value_type &);
       iterator find_insert_pos(const KT &key) const;
       pair<unsigned, bool> bsearch(const KT &key) const;
    };
 
-   template<typename KT, typename T, typename Compare>
-   sorted_vector_map<KT,T,Compare>::sorted_vector_map(const sorted_vector_map& other)
+   template<typename KT, typename T, typename Compare, typename Allocator>
+   sorted_vector_map<KT,T,Compare,Allocator>::sorted_vector_map(const sorted_vector_map& other): Allocator(other)
    {
       size_type prealloc = other.end_of_elements_ - other.elements_;
-      elements_ = last_ = new value_type*[prealloc];
+      elements_ = last_ = allocate_pointers(prealloc);
       end_of_elements_ = elements_ + prealloc;
       for (const value_type * const *i = other.elements_; i != other.last_; ++i)
-         *last_++ = new value_type(**i);
+         *last_++ = new_value(**i);
+   }
+
+   template<typename KT, typename T, typename Compare, typename Allocator>
+   template<class InputIt>
+   sorted_vector_map<KT,T,Compare,Allocator>::sorted_vector_map(InputIt first, InputIt last):
+      elements_(0), last_(0), end_of_elements_(0)
+   {
+      insert(first, last);
    }
 
-   template<typename KT, typename T, typename Compare>
+   template<typename KT, typename T, typename Compare, typename Allocator>
+   sorted_vector_map<KT,T,Compare,Allocator> &
+   sorted_vector_map<KT,T,Compare,Allocator>::operator=(const sorted_vector_map &other)
+   {
+      if (this == &other)
+         return *this;
+      clear();
+      const size_type n = other.size();
+      if (size_type(end_of_elements_ - elements_) < n)
+      {
+         deallocate_pointers();
+         elements_ = last_ = allocate_pointers(n);
+         end_of_elements_ = elements_ + n;
+      }
+      for (const value_type * const *i = other.elements_; i != other.last_; ++i)
+         *last_++ = new_value(**i);
+      return *this;
+   }
+
+   template<typename KT, typename T, typename Compare, typename Allocator>
+   inline typename sorted_vector_map<KT,T,Compare,Allocator>::iterator
+   sorted_vector_map<KT,T,Compare,Allocator>::insert(iterator, const value_type &value)
+   {
+      return insert(value).first;
+   }
+   template<typename KT, typename T, typename Compare, typename Allocator>
+   template<class InputIt>
+   void sorted_vector_map<KT,T,Compare,Allocator>::insert(InputIt first, InputIt last)
+   {
+      for (; first != last; ++first)
+         insert(*first);
+   }
+
+   template<typename KT, typename T, typename Compare, typename Allocator>
+   typename sorted_vector_map<KT,T,Compare,Allocator>::iterator
+   sorted_vector_map<KT,T,Compare,Allocator>::erase(const_iterator first, const_iterator last)
+   {
+      const value_type * const *e = elements_;
+      value_type **f = elements_ + (first.ptr_ - e), **l = elements_ + (last.ptr_ - e);
+      for (value_type **i = f; i != l; ++i)
+         delete_value(*i);
+      value_type **o = f;
+      for (value_type **i = l; i != last_;)
+         *o++ = *i++;
+      last_ = o;
+      return iterator(f);
+   }
+   template<typename KT, typename T, typename Compare, typename Allocator>
+   inline typename sorted_vector_map<KT,T,Compare,Allocator>::iterator
+   sorted_vector_map<KT,T,Compare,Allocator>::erase(const_iterator pos)
+   {
+      const_iterator next = pos;
+      return erase(pos, ++next);
+   }
+   template<typename KT, typename T, typename Compare, typename Allocator>
+   typename sorted_vector_map<KT,T,Compare,Allocator>::size_type
+   sorted_vector_map<KT,T,Compare,Allocator>::erase(const key_type &key)
+   {
+      iterator i = find(key);
+      if (i == end())
+         return 0;
+      erase(i);
+      return 1;
+   }
+
+   template<typename KT, typename T, typename Compare, typename Allocator>
+   void sorted_vector_map<KT,T,Compare,Allocator>::swap(sorted_vector_map &other)
+   {
+      ttl::swap(elements_, other.elements_);
+      ttl::swap(last_, other.last_);
+      ttl::swap(end_of_elements_, other.end_of_elements_);
+      ttl::swap(get_allocator(), other.get_allocator());
+   }
+
+   template<typename KT, typename T, typename Compare, typename Allocator>
    pair<unsigned, bool>
-   sorted_vector_map<KT,T,Compare>::bsearch(const KT &key) const
+   sorted_vector_map<KT,T,Compare,Allocator>::bsearch(const KT &key) const
    {
       Compare comp;
       unsigned L = 0, H = size();
@@ -249,30 +360,30 @@ namespace ttl
       return pair<unsigned, bool>(L, false);
    }
 
-   template<typename KT, typename T, typename Compare>
-   typename sorted_vector_map<KT,T,Compare>::iterator
-   sorted_vector_map<KT,T,Compare>::find(const KT &key)
+   template<typename KT, typename T, typename Compare, typename Allocator>
+   typename sorted_vector_map<KT,T,Compare,Allocator>::iterator
+   sorted_vector_map<KT,T,Compare,Allocator>::find(const KT &key)
    {
       pair<unsigned, bool> re = bsearch(key);
       return re.second ? iterator(elements_ + re.first): end();
    }
-   template<typename KT, typename T, typename Compare>
-   typename sorted_vector_map<KT,T,Compare>::const_iterator
-   sorted_vector_map<KT,T,Compare>::find(const KT &key) const
+   template<typename KT, typename T, typename Compare, typename Allocator>
+   typename sorted_vector_map<KT,T,Compare,Allocator>::const_iterator
+   sorted_vector_map<KT,T,Compare,Allocator>::find(const KT &key) const
    {
       pair<unsigned, bool> re = bsearch(key);
       return re.second ? const_iterator(elements_ + re.first): end();
    }
-   template<typename KT, typename T, typename Compare>
-   typename sorted_vector_map<KT,T,Compare>::iterator
-   sorted_vector_map<KT,T,Compare>::find_insert_pos(const KT &key) const
+   template<typename KT, typename T, typename Compare, typename Allocator>
+   typename sorted_vector_map<KT,T,Compare,Allocator>::iterator
+   sorted_vector_map<KT,T,Compare,Allocator>::find_insert_pos(const KT &key) const
    {
       pair<unsigned, bool> re = bsearch(key);
       return elements_ + re.first;
    }
-   template<typename KT, typename T, typename Compare>
-   typename sorted_vector_map<KT,T,Compare>::iterator
-   sorted_vector_map<KT,T,Compare>::insert_before(iterator pos, const value_type& value)
+   template<typename KT, typename T, typename Compare, typename Allocator>
+   typename sorted_vector_map<KT,T,Compare,Allocator>::iterator
+   sorted_vector_map<KT,T,Compare,Allocator>::insert_before(iterator pos, const value_type& value)
    {
       if (end_of_elements_ - last_ < 1)
       {
@@ -282,14 +393,14 @@ namespace ttl
          newcapacity += newcapacity/2; // temporarily funny...
          if (!newcapacity)
             newcapacity = 2;
-         value_type **newelements = o = new value_type *[newcapacity];
+         value_type **newelements = o = allocate_pointers(newcapacity);
          for (i = elements_; i != pos.ptr_;)
             *o++ = *i++;
-         *o = new value_type(value);
+         *o = new_value(value);
          pos = iterator(o++);
          for (; i != last_;)
             *o++ = *i++;
-         delete [] elements_;
+         deallocate_pointers();
          elements_ = newelements;
          end_of_elements_ = elements_ + newcapacity;
          last_ = o;
@@ -301,8 +412,14 @@ namespace ttl
       value_type **o = last_;
       while (i != pos.ptr_)
          *--o = *--i;
-      *i = new value_type(value);
+      *i = new_value(value);
       return iterator(i);
    }
+
+   template<typename KT, typename T, typename Compare, typename Allocator>
+   inline void swap(sorted_vector_map<KT,T,Compare,Allocator> &a, sorted_vector_map<KT,T,Compare,Allocator> &b)
+   {
+      a.swap(b);
+   }
 }
 #endif // _TINY_TEMPLATE_LIBRARY_SORTED_VECTOR_MAP_HPP_
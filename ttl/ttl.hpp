@@ -17,8 +17,9 @@
 //
 // Some templates are implementations of STL interfaces, some are not.
 //
-// There is no allocator support and the O(log N) and similar complexity
-// guarantees might be not implemented.
+// The containers take an allocator of untyped bytes (see allocator.hpp),
+// not an STL one. The O(log N) and similar complexity guarantees might be
+// not implemented.
 //
 // The reverse iterators are not implemented.
 //
@@ -36,19 +37,32 @@
 #include "type_traits.hpp"
 #include "functional.hpp"
 #include "utility.hpp"
+#include "allocator.hpp"
+#include "arena.hpp"
 #include "algorithm.hpp"
 #include "array.hpp"
 #include "vector.hpp"
 #include "fixed_vector.hpp"
+#include "small_vector.hpp"
+#include "soa_vector.hpp"
+#include "deque.hpp"
 #include "forward_list.hpp"
 #include "backward_list.hpp"
 #include "lazy_queue.hpp"
 #include "list.hpp"
 #include "map.hpp"
 #include "set.hpp"
+#include "interval_map.hpp"
+#include "lru_cache.hpp"
 #include "vector_map.hpp"
 #include "sorted_vector_map.hpp"
 #include "bitset.hpp"
+#include "dynamic_bitset.hpp"
+#include "rank_select.hpp"
+#include "hierarchical_bitset.hpp"
+#include "atomic_bitset.hpp"
+#include "bloom_filter.hpp"
+#include "roaring_bitmap.hpp"
 
 namespace ttl
 {
@@ -151,6 +151,47 @@ namespace ttl
          || is_member_pointer<T>::value
          || is_same<std::nullptr_t, typename remove_cv<T>::type>::value */ > {};
 
+   // is_trivially_copyable<T>::value == true if T can be copied with memcpy.
+   // Without the compiler support only the scalar types are.
+   template<class T> struct is_trivially_copyable: integral_constant<bool,
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5)
+      __is_trivially_copyable(T)
+#elif defined(__GNUC__)
+      __has_trivial_copy(T) && __has_trivial_destructor(T)
+#else
+      is_scalar<T>::value
+#endif
+      > {};
+
+   // is_trivially_destructible<T>::value == true if the destructor does nothing
+   template<class T> struct is_trivially_destructible: integral_constant<bool,
+#if defined(__clang__) || defined(__GNUC__)
+      __has_trivial_destructor(T)
+#else
+      is_scalar<T>::value
+#endif
+      > {};
+
+   // is_trivially_relocatable<T>::value == true if an object can be moved
+   // to another address with memcpy, leaving the source as raw memory,
+   // instead of copy-constructing and destroying it. Specialize it for the
+   // types which own their resources by pointer and do not point to self.
+   template<class T> struct is_trivially_relocatable: is_trivially_copyable<T> {};
+
+   // Raw memory for an object of type T, of its size and alignment: the
+   // storage of the elements which containers keep in place
+   template<class T>
+   struct storage_for
+   {
+#if __cplusplus >= 201103L // C++11
+      alignas(T) unsigned char bytes[sizeof(T)];
+#elif defined(__clang__) || defined(__GNUC__)
+      unsigned char bytes[sizeof(T)] __attribute__((aligned(__alignof__(T))));
+#else
+      union { unsigned char bytes[sizeof(T)]; void *p; long l; double d; long double ld; };
+#endif
+   };
+
    template<class T> struct is_array: false_type {};
    template<class T> struct is_array<T[]>: true_type {};
    template<class T, ttl::size_t N> struct is_array<T[N]>: true_type {};
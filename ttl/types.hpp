@@ -9,6 +9,18 @@
 
 #include <stddef.h>
 
+#if __cplusplus >= 201103L // C++11
+#define ttl_constexpr constexpr
+#else
+#define ttl_constexpr
+#endif
+// for the functions which change the object, constant from C++14 on
+#if __cplusplus >= 201402L // C++14
+#define ttl_constexpr14 constexpr
+#else
+#define ttl_constexpr14
+#endif
+
 namespace ttl
 {
    using ::size_t;
@@ -7,7 +7,10 @@
 #ifndef _TINY_TEMPLATE_LIBRARY_UTILITY_HPP_
 #define _TINY_TEMPLATE_LIBRARY_UTILITY_HPP_
 
+#include <new>
+#include <string.h>
 #include "types.hpp"
+#include "type_traits.hpp"
 
 namespace ttl
 {
@@ -94,6 +97,30 @@ namespace ttl
       return pair<T1, T2>(first, second);
    }
 
+   //
+   // A pair of iterators usable as a container in range-based for
+   //
+   template<typename Iterator>
+   struct iterator_range
+   {
+      typedef Iterator iterator;
+
+      iterator_range(Iterator first, Iterator last): first_(first), last_(last) {}
+
+      Iterator begin() const { return first_; }
+      Iterator end() const { return last_; }
+      bool empty() const { return first_ == last_; }
+      // random access iterators only
+      ttl::size_t size() const { return last_ - first_; }
+   private:
+      Iterator first_, last_;
+   };
+   template<typename Iterator>
+   inline iterator_range<Iterator> make_range(Iterator first, Iterator last)
+   {
+      return iterator_range<Iterator>(first, last);
+   }
+
    //
    // pair<> type selection:
    //
@@ -127,6 +154,29 @@ namespace ttl
    typename remove_reference<T>::type &move(T &t) { return static_cast<typename remove_reference<T>::type &>(t); }
 #endif
 
+   // Destroy the object; skipped when trivial, as GCC would then take the
+   // value relocated over it as uninitialized
+   template<class T>
+   inline void destroy_at(T *p)
+   {
+      if (!is_trivially_destructible<T>::value)
+         p->~T();
+   }
+
+   // Move the object to the uninitialized storage at the address, leaving
+   // raw memory behind
+   template<class T>
+   inline void relocate(T *to, T *from)
+   {
+      if (is_trivially_relocatable<T>::value)
+         memcpy(static_cast<void *>(to), static_cast<const void *>(from), sizeof(T));
+      else
+      {
+         ::new(static_cast<void *>(to)) T(ttl::move(*from));
+         from->~T();
+      }
+   }
+
 }
 
 #endif // _TINY_TEMPLATE_LIBRARY_UTILITY_HPP_
@@ -8,15 +8,19 @@
 #define _TINY_TEMPLATE_LIBRARY_VECTOR_HPP_ 1
 
 #include <new>
+#include <string.h>
 #include "types.hpp"
+#include "type_traits.hpp"
+#include "utility.hpp"
+#include "allocator.hpp"
 
 namespace ttl
 {
    template<typename T> void swap(T &, T &);
    template<class InputIt1, class InputIt2> bool equal(InputIt1, InputIt1, InputIt2, InputIt2);
 
-   template<typename T>
-   class vector
+   template<typename T, typename Allocator = allocator>
+   class vector: private Allocator // empty allocators take no space
    {
    public:
       typedef T              value_type;
@@ -57,10 +61,27 @@ namespace ttl
          ::new(p) T(*i);
          ++i;
       }
-      iterator insert_values(const_iterator pos, difference_type n, void (ttl::vector<T>::*)(T *, vc_args &) const, vc_args &);
+      iterator insert_values(const_iterator pos, difference_type n, void (ttl::vector<T,Allocator>::*)(T *, vc_args &) const, vc_args &);
+
+      T *allocate_elements(size_type n)
+      {
+         return static_cast<T *>(Allocator::allocate(n * sizeof(T)));
+      }
+      // the capacity to grow to for n more elements: doubled, so that a
+      // run of appends reallocates O(log N) times
+      size_type grown_capacity(size_type n) const
+      {
+         size_type newcapacity = capacity() * 2;
+         return newcapacity < size() + n ? size() + n: newcapacity;
+      }
+      void deallocate_elements()
+      {
+         Allocator::deallocate(elements_, capacity() * sizeof(T));
+      }
 
    public:
       vector(): elements_(0), last_(0), end_of_elements_(0) {}
+      explicit vector(const Allocator &a): Allocator(a), elements_(0), last_(0), end_of_elements_(0) {}
       explicit vector(size_type n);
       explicit vector(size_type n, const value_type &);
       vector(const vector &other);
@@ -70,9 +91,12 @@ namespace ttl
       ~vector()
       {
          clear();
-         ::operator delete(elements_);
+         deallocate_elements();
       }
 
+      Allocator &get_allocator() { return *this; }
+      const Allocator &get_allocator() const { return *this; }
+
       vector& operator=(const vector &other);
 
       void assign(size_type n, const value_type &value);
@@ -108,6 +132,19 @@ namespace ttl
 
       void reserve(size_type n);
 
+      // Resize or append default-initialized elements: for the types with
+      // a trivial default constructor the new elements are left as raw
+      // memory, to be filled by the caller. Return the first new element.
+      // The capacity grows geometrically.
+      pointer append_uninitialized(size_type n);
+      void resize_uninitialized(size_type new_size)
+      {
+         if (new_size < size())
+            resize(new_size);
+         else
+            append_uninitialized(new_size - size());
+      }
+
       reference operator[](size_type n) { return *(elements_ + n); }
       const_reference operator[](size_type n) const { return *(elements_ + n); }
       reference at(size_type n) { return (*this)[n]; }
@@ -122,20 +159,20 @@ namespace ttl
       iterator insert(const_iterator pos, size_type n, const value_type &x)
       {
          vc_counter_args args(x);
-         return insert_values(pos, n, &ttl::vector<T>::vc_counter, args);
+         return insert_values(pos, n, &ttl::vector<T,Allocator>::vc_counter, args);
       }
 
       iterator insert(const_iterator pos, const value_type &x)
       {
          vc_counter_args args(x);
-         return insert_values(pos, 1, &ttl::vector<T>::vc_counter, args);
+         return insert_values(pos, 1, &ttl::vector<T,Allocator>::vc_counter, args);
       }
 
       template<typename InputIterator>
       iterator insert(const_iterator pos, InputIterator first, InputIterator last)
       {
          vc_iterator_args<InputIterator> args(first);
-         return insert_values(pos, last - first, &ttl::vector<T>::vc_iterator<InputIterator>, args);
+         return insert_values(pos, last - first, &ttl::vector<T,Allocator>::vc_iterator<InputIterator>, args);
       }
 
       void push_back(const value_type &x)
@@ -158,11 +195,28 @@ namespace ttl
          return erase(pos, pos + 1);
       }
 
+      // Erase by moving the last element in place of the erased one, O(1).
+      // Returns the iterator to the element which took the place.
+      iterator erase_unordered(const_iterator pos)
+      {
+         T *p = const_cast<T *>(pos);
+         ttl::destroy_at(p);
+         if (p != --last_)
+            ttl::relocate(p, last_);
+         return p;
+      }
+
+      // Erase all elements for which pred is true in one pass, keeping the
+      // order of the rest. Returns the number of the erased elements.
+      template<typename Predicate>
+      size_type erase_if(Predicate pred);
+
       void swap(vector& x)
       {
          ttl::swap(this->elements_, x.elements_);
          ttl::swap(this->last_, x.last_);
          ttl::swap(this->end_of_elements_, x.end_of_elements_);
+         ttl::swap(static_cast<Allocator &>(*this), static_cast<Allocator &>(x));
       }
 
       void clear()
@@ -172,41 +226,41 @@ namespace ttl
       }
    };
 
-   template<typename T>
-   vector<T>::vector(size_type n)
+   template<typename T, typename Allocator>
+   vector<T,Allocator>::vector(size_type n)
    {
-      last_ = elements_ = static_cast<T *>(::operator new(n * sizeof(T)));
+      last_ = elements_ = allocate_elements(n);
       end_of_elements_ = elements_ + n;
       while (n--)
          ::new(last_++) T();
    }
-   template<typename T>
-   vector<T>::vector(size_type n, const value_type &value)
+   template<typename T, typename Allocator>
+   vector<T,Allocator>::vector(size_type n, const value_type &value)
    {
-      last_ = elements_ = static_cast<T *>(::operator new(n * sizeof(T)));
+      last_ = elements_ = allocate_elements(n);
       end_of_elements_ = elements_ + n;
       while (n--)
          ::new(last_++) T(value);
    }
-   template<typename T>
-   vector<T>::vector(const vector &other)
+   template<typename T, typename Allocator>
+   vector<T,Allocator>::vector(const vector &other): Allocator(other)
    {
-      last_ = elements_ = static_cast<T *>(::operator new(other.size() * sizeof(T)));
+      last_ = elements_ = allocate_elements(other.size());
       end_of_elements_ = elements_ + other.size();
       for (const_iterator i = other.cbegin(); i != other.cend(); ++i)
          ::new(last_++) T(*i);
    }
-   template<typename T>
+   template<typename T, typename Allocator>
    template<typename RandomAccessIterator>
-   vector<T>::vector(RandomAccessIterator first, RandomAccessIterator last):
+   vector<T,Allocator>::vector(RandomAccessIterator first, RandomAccessIterator last):
       elements_(0), last_(0), end_of_elements_(0)
    {
       reserve(last - first);
       for (; first != last; ++first)
          push_back(*first);
    }
-   template<typename T>
-   vector<T> &vector<T>::operator=(const vector &other)
+   template<typename T, typename Allocator>
+   vector<T,Allocator> &vector<T,Allocator>::operator=(const vector &other)
    {
       clear();
       reserve(other.capacity());
@@ -214,16 +268,16 @@ namespace ttl
          ::new(last_++) T(*i);
       return *this;
    }
-   template<typename T>
-   void vector<T>::assign(size_type n, const value_type &value)
+   template<typename T, typename Allocator>
+   void vector<T,Allocator>::assign(size_type n, const value_type &value)
    {
       clear();
       reserve(n);
       while (n--)
          ::new(last_++) T(value);
    }
-   template<typename T>
-   void vector<T>::resize(size_type new_size)
+   template<typename T, typename Allocator>
+   void vector<T,Allocator>::resize(size_type new_size)
    {
       if (new_size < size())
          for (T *pos = elements_ + new_size; last_ > pos;)
@@ -231,47 +285,87 @@ namespace ttl
       else
          insert(end(), new_size - size(), value_type());
    }
-   template<typename T>
-   void vector<T>::reserve(size_type n)
+   template<typename T, typename Allocator>
+   void vector<T,Allocator>::reserve(size_type n)
    {
       if (elements_ + n < end_of_elements_)
          return;
-      T *newelements = static_cast<T *>(::operator new(n * sizeof(T)));
-      T *o = newelements, *i = elements_;
-      for (; i != last_; ++i)
-         ::new(o++) T(*i);
-      for (; i > elements_; )
-         (--i)->~T();
-      ::operator delete(elements_);
+      if (is_trivially_relocatable<T>::value && elements_)
+      {
+         // the allocator may be able to move the elements for us
+         size_type count = size();
+         T *newelements = static_cast<T *>(Allocator::reallocate(elements_, capacity() * sizeof(T), n * sizeof(T)));
+         if (newelements)
+         {
+            elements_ = newelements;
+            end_of_elements_ = elements_ + n;
+            last_ = elements_ + count;
+            return;
+         }
+      }
+      T *newelements = allocate_elements(n);
+      T *o = newelements;
+      for (T *i = elements_; i != last_; ++i)
+         ttl::relocate(o++, i);
+      deallocate_elements();
       elements_ = newelements;
       end_of_elements_ = elements_ + n;
       last_ = o;
    }
 
-   template<typename T>
-   typename vector<T>::iterator vector<T>::insert_values(const_iterator pos,
-                                                         difference_type n,
-                                                         void (ttl::vector<T>::* vc)(T *, vc_args &) const,
-                                                         vc_args &args)
+   template<typename T, typename Allocator>
+   typename vector<T,Allocator>::pointer vector<T,Allocator>::append_uninitialized(size_type n)
+   {
+      if (size_type(end_of_elements_ - last_) < n)
+         reserve(grown_capacity(n));
+      T *tail = last_;
+      while (n--)
+         ::new(last_++) T;
+      return tail;
+   }
+
+   template<typename T, typename Allocator>
+   typename vector<T,Allocator>::iterator vector<T,Allocator>::insert_values(const_iterator pos,
+                                                                   difference_type n,
+                                                                   void (ttl::vector<T,Allocator>::* vc)(T *, vc_args &) const,
+                                                                   vc_args &args)
    {
       difference_type dist = pos - cbegin();
       if (n > 0)
       {
-         T *o;
-         const T *i;
+         T *o, *i;
+         // grow through reserve(), whose allocator may move the block
+         // without copying
+         const bool regrow = end_of_elements_ - last_ < n && is_trivially_relocatable<T>::value && elements_ &&
+                             vc == &ttl::vector<T,Allocator>::vc_counter;
+         if (vc == &ttl::vector<T,Allocator>::vc_counter)
+         {
+            // a value in the elements is copied out before they move: all
+            // of them if the vector grows, those from pos otherwise
+            const value_type &x = static_cast<vc_counter_args &>(args).x;
+            if (&x >= (end_of_elements_ - last_ < n ? cbegin(): pos) && &x < last_)
+            {
+               value_type copy(x);
+               vc_counter_args copy_args(copy);
+               return insert_values(pos, n, vc, copy_args);
+            }
+         }
+         if (regrow)
+         {
+            reserve(grown_capacity(n));
+            pos = cbegin() + dist;
+         }
          if (end_of_elements_ - last_ < n)
          {
-            size_type newcapacity = size() + n;
-            T *newelements = o = static_cast<T *>(::operator new(newcapacity * sizeof(T)));
+            size_type newcapacity = grown_capacity(n);
+            T *newelements = o = allocate_elements(newcapacity);
             for (i = elements_; i != pos; ++i)
-               ::new(o++) T(*i);
+               ttl::relocate(o++, i);
             while (n-- > 0)
                (this->*vc)(o++, args);
             for (; i != last_; ++i)
-               ::new(o++) T(*i);
-            for (; i > elements_; )
-               (--i)->~T();
-            ::operator delete(elements_);
+               ttl::relocate(o++, i);
+            deallocate_elements();
             elements_ = newelements;
             end_of_elements_ = elements_ + newcapacity;
             last_ = o;
@@ -283,10 +377,7 @@ namespace ttl
                i = last_;
                last_ += n;
                for (o = last_; i != pos; )
-               {
-                  ::new(--o) T(*--i);
-                  i->~T();
-               }
+                  ttl::relocate(--o, --i);
                for (o = elements_ + dist; n-- > 0; ++o)
                   (this->*vc)(o, args);
             }
@@ -300,8 +391,28 @@ namespace ttl
       return begin() + dist;
    }
 
-   template<typename T>
-   typename vector<T>::iterator vector<T>::erase(const_iterator first, const_iterator last)
+   template<typename T, typename Allocator>
+   template<typename Predicate>
+   typename vector<T,Allocator>::size_type vector<T,Allocator>::erase_if(Predicate pred)
+   {
+      T *o = elements_;
+      for (T *i = o; i != last_; ++i)
+         if (pred(*i))
+         {
+            if (!is_trivially_destructible<T>::value)
+               i->~T();
+         }
+         else if (o != i)
+            ttl::relocate(o++, i);
+         else
+            ++o;
+      size_type erased = last_ - o;
+      last_ = o;
+      return erased;
+   }
+
+   template<typename T, typename Allocator>
+   typename vector<T,Allocator>::iterator vector<T,Allocator>::erase(const_iterator first, const_iterator last)
    {
       difference_type off = first - begin();
       difference_type lastoff = last - begin();
@@ -316,13 +427,13 @@ namespace ttl
       last_ = o;
       return begin() + off;
    }
-   template<typename T>
-   inline bool operator==(const vector<T> &a, const vector<T> &b)
+   template<typename T, typename Allocator>
+   inline bool operator==(const vector<T,Allocator> &a, const vector<T,Allocator> &b)
    {
       return ttl::equal(a.begin(), a.end(), b.begin(), b.end());
    }
-   template<typename T>
-   inline bool operator!=(const vector<T> &a, const vector<T> &b)
+   template<typename T, typename Allocator>
+   inline bool operator!=(const vector<T,Allocator> &a, const vector<T,Allocator> &b)
    {
       return !(a == b);
    }